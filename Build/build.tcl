@@ -20,16 +20,24 @@ read_verilog -sv "${lib_dir}/Clock/clock_100Mhz.sv"
 
 read_verilog -sv "${lib_dir}/Math/MatVecMul/src/mat_vec_mul_new.sv"
 read_verilog -sv "${lib_dir}/Math/MatMul/src/mat_mul.sv"
+read_verilog -sv "${lib_dir}/Math/MatChainMul/src/mat_chain_mul.sv"
 read_verilog -sv "${lib_dir}/Math/FastInverse/src/fast_inverse.sv"
 read_verilog -sv "${lib_dir}/Math/FixedPointDivide/src/fixed_point_divide.sv"
-read_verilog -sv "${lib_dir}/Math/TrigLUT/src/sin_cos_lu.sv"
-read_verilog -sv "${lib_dir}/Math/RotMat/src/rot_y.sv"
+read_verilog -sv "${lib_dir}/Math/TrigLUTQuarter/src/sin_cos_lu_quarter.sv"
+read_verilog -sv "${lib_dir}/Math/PoseMVP/src/pose_mvp.sv"
+read_verilog -sv "${lib_dir}/Memory/FIFO/src/sync_fifo.sv"
+read_verilog -sv "${lib_dir}/Memory/AsyncFIFO/src/async_fifo.sv"
+read_verilog -sv "${lib_dir}/Memory/SkidBuffer/src/skid_buffer.sv"
 read_verilog -sv "${lib_dir}/Memory/BRAM_SP/src/bram_sp.sv"
 read_verilog -sv "${lib_dir}/Memory/BRAM_DP/src/bram_dp.sv"
+read_verilog -sv "${lib_dir}/Memory/BRAM_TDP/src/bram_tdp.sv"
 read_verilog -sv "${lib_dir}/Memory/Buffer/src/buffer.sv"
+read_verilog -sv "${lib_dir}/Memory/BufferWide/src/buffer_wide.sv"
 read_verilog -sv "${lib_dir}/Memory/G-Buffer/src/g_buffer.sv"
 read_verilog -sv "${lib_dir}/Memory/ROM/src/rom.sv"
 read_verilog -sv "${lib_dir}/Memory/ModelReader/src/model_reader.sv"
+read_verilog -sv "${lib_dir}/Memory/PSRAM/src/psram_controller.sv"
+read_verilog -sv "${lib_dir}/Memory/PSRAMModelReader/src/psram_model_reader.sv"
 read_verilog -sv "${lib_dir}/Display/DisplaySignals/projectf_display_480p.sv"
 read_verilog -sv "${lib_dir}/Display/display_new.sv"
 read_verilog -sv "${lib_dir}/RenderPipeline/VertexShader/src/vertex_shader_new.sv"
@@ -37,17 +45,24 @@ read_verilog -sv "${lib_dir}/RenderPipeline/VertexPostProcessor/src/vertex_post_
 read_verilog -sv "${lib_dir}/RenderPipeline/PrimitiveAssembler/src/primitive_assembler.sv"
 read_verilog -sv "${lib_dir}/RenderPipeline/TransformPipeline/src/transform_pipeline.sv"
 read_verilog -sv "${lib_dir}/RenderPipeline/Rasterizer/BoundingBox/src/bounding_box.sv"
+read_verilog -sv "${lib_dir}/RenderPipeline/Rasterizer/EdgeCompute/src/edge_compute.sv"
 read_verilog -sv "${lib_dir}/RenderPipeline/Rasterizer/Frontend/src/rasterizer_frontend.sv"
 read_verilog -sv "${lib_dir}/RenderPipeline/Rasterizer/Backend/src/rasterizer_backend.sv"
+read_verilog -sv "${lib_dir}/RenderPipeline/Rasterizer/TileBackend/src/rasterizer_tile_backend.sv"
 read_verilog -sv "${lib_dir}/RenderPipeline/Rasterizer/src/rasterizer.sv"
 read_verilog -sv "${lib_dir}/RenderPipeline/src/render_pipeline.sv"
+read_verilog -sv "${lib_dir}/PerfCounters/src/perf_counters.sv"
+read_verilog -sv "${lib_dir}/OcclusionCounters/src/occlusion_counters.sv"
+read_verilog -sv "${lib_dir}/ConditionalRender/src/conditional_render.sv"
+read_verilog -sv "${lib_dir}/ObjectSort/src/object_sort.sv"
+read_verilog -sv "${lib_dir}/SPI/src/spi_slave.sv"
+read_verilog -sv "${lib_dir}/MCU-FPGA-Com/src/mcu_fpga_com.sv"
 
 # Read src files
 add_files "${src_dir}/image.mem"
 add_files "${src_dir}/palette.mem"
 add_files "${src_dir}/reciprocal.mem"
-add_files "${src_dir}/sine_lut.mem"
-add_files "${src_dir}/cosine_lut.mem"
+add_files "${src_dir}/quarter_sine_lut.mem"
 add_files "${src_dir}/model_headers.mem"
 add_files "${src_dir}/model_vertex.mem"
 add_files "${src_dir}/model_faces.mem"
@@ -56,7 +71,8 @@ read_verilog -sv "${src_dir}/${design_name}.sv"
 # Read constraints
 read_xdc "${origin_dir}/Constraints/${board_name}.xdc"
 
-# Synthesis
+# Synthesis. On boards with a PSRAM, add -verilog_define MODEL_SOURCE_PSRAM
+# and assign the PSRAM pins in the constraints
 synth_design -top "${design_name}" -part ${fpga_part}
 
 # Optimize design
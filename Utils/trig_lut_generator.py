@@ -18,3 +18,24 @@ with open("sine_lut.mem", "w") as sine_file, open("cosine_lut.mem", "w") as cosi
 
         sine_file.write(f"{sine_val & 0xFFFFFF:06X}\n")  # Write as 24-bit hex
         cosine_file.write(f"{cosine_val & 0xFFFFFF:06X}\n")
+
+# Quarter wave table for sin_cos_lu_quarter: sin over [0, pi/2), the other
+# quadrants and cosine are derived by symmetry. Each entry is
+# {delta to the next entry, value} so the module can interpolate linearly.
+QUARTER_ADDR_WIDTH = 8
+QUARTER_N = 2 ** QUARTER_ADDR_WIDTH
+VALUE_WIDTH = 14  # Q1.13, holds 1.0
+DELTA_WIDTH = 8
+
+
+def quarter_sine(i):
+    return round(math.sin((math.pi / 2) * i / QUARTER_N) * SCALE)
+
+
+with open("quarter_sine_lut.mem", "w") as quarter_file:
+    for i in range(QUARTER_N):
+        value = quarter_sine(i)
+        delta = quarter_sine(i + 1) - value
+        assert 0 <= delta < 2 ** DELTA_WIDTH, "delta does not fit DELTA_WIDTH"
+
+        quarter_file.write(f"{(delta << VALUE_WIDTH) | value:06X}\n")
@@ -6,10 +6,12 @@ module clock_100Mhz (
     input  wire logic clk_20m,        // input clock (20 MHz)
     input  wire logic rst,            // reset
     output      logic clk_100m,       // 100 MHz clock
+    output      logic clk_200m,       // 200 MHz clock, in phase with clk_100m
     output      logic clk_100m_5x,    // 5x clock (600 MHz from VCO)
     output      logic clk_100m_locked // clock locked
 );
     assign clk_100m = clk_20m;
+    assign clk_200m = clk_20m;
     assign clk_100m_5x = clk_20m;
     assign clk_100m_locked = 1'b1;
 endmodule
@@ -21,6 +23,7 @@ module clock_100Mhz (
     input  wire logic clk_20m,        // input clock (20 MHz)
     input  wire logic rst,            // reset
     output      logic clk_100m,       // 100 MHz clock
+    output      logic clk_200m,       // 200 MHz clock, in phase with clk_100m
     output      logic clk_100m_5x,    // 5x clock (600 MHz from VCO)
     output      logic clk_100m_locked // clock locked
     );
@@ -30,10 +33,12 @@ module clock_100Mhz (
     localparam DIV_MASTER = 1;        // No division for VCO
     localparam DIV_5X = 1;            // Pass-through VCO frequency (600 MHz) to clk_100m_5x
     localparam DIV_1X = 6;            // Divide by 6 to get 100 MHz for clk_100m
+    localparam DIV_2X = 3;            // Divide by 3 to get 200 MHz for clk_200m
     localparam IN_PERIOD = 50.0;      // Period of 20 MHz input clock in ns
 
     logic feedback;            // Internal clock feedback
     logic clk_100m_unbuf;      // Unbuffered 100 MHz clock
+    logic clk_200m_unbuf;      // Unbuffered 200 MHz clock
     logic clk_100m_5x_unbuf;   // Unbuffered 5x clock (600 MHz VCO frequency)
     logic locked;              // Unsynced lock signal
 
@@ -42,19 +47,20 @@ module clock_100Mhz (
         .CLKIN1_PERIOD(IN_PERIOD),
         .CLKOUT0_DIVIDE_F(DIV_5X),   // Output 600 MHz directly for clk_100m_5x
         .CLKOUT1_DIVIDE(DIV_1X),     // Divide by 6 for 100 MHz
+        .CLKOUT2_DIVIDE(DIV_2X),     // Divide by 3 for 200 MHz
         .DIVCLK_DIVIDE(DIV_MASTER)
     ) MMCME2_BASE_inst (
         .CLKIN1(clk_20m),
         .RST(rst),
         .CLKOUT0(clk_100m_5x_unbuf),
         .CLKOUT1(clk_100m_unbuf),
+        .CLKOUT2(clk_200m_unbuf),
         .LOCKED(locked),
         .CLKFBOUT(feedback),
         .CLKFBIN(feedback),
         /* verilator lint_off PINCONNECTEMPTY */
         .CLKOUT0B(),
         .CLKOUT1B(),
-        .CLKOUT2(),
         .CLKOUT2B(),
         .CLKOUT3(),
         .CLKOUT3B(),
@@ -68,6 +74,7 @@ module clock_100Mhz (
 
     // Buffer output clocks
     BUFG bufg_clk(.I(clk_100m_unbuf), .O(clk_100m));
+    BUFG bufg_clk_2x(.I(clk_200m_unbuf), .O(clk_200m));
     BUFG bufg_clk_5x(.I(clk_100m_5x_unbuf), .O(clk_100m_5x));
 
     // Synchronize the lock signal with clk_100m
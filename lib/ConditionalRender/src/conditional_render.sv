@@ -0,0 +1,123 @@
+`timescale 1ns / 1ps
+
+// Conditional rendering from the occlusion queries of the previous frame.
+// An object that had no visible pixels in the last SKIP_FRAMES frames is not
+// rendered. It is rendered again as a re-test every RETEST_FRAMES + 1
+// frames, and stays skipped while the re-test finds no visible pixels.
+//
+// Every object is queried once per frame, after the occlusion counters have
+// swapped. The query reads the count of the previous frame from
+// occlusion_counters and updates the state of the object. A skipped frame
+// counts as a frame without visible pixels.
+module conditional_render #(
+    parameter unsigned NUM_OBJECTS = 1024,
+    parameter unsigned COUNTER_WIDTH = 16,
+    parameter unsigned SKIP_FRAMES = 4,
+    parameter unsigned RETEST_FRAMES = 15,
+
+    parameter unsigned OBJECT_INDEX_WIDTH = $clog2(NUM_OBJECTS)
+    ) (
+    input logic clk,
+    input logic rstn,
+
+    // Read port of occlusion_counters, data valid the cycle after the address
+    output logic [OBJECT_INDEX_WIDTH-1:0] o_occlusion_addr,
+    input logic [COUNTER_WIDTH-1:0] i_occlusion_count,
+
+    // Low when the counts of the previous frame are incomplete, e.g. when it
+    // was cut short. The object is then rendered and its state is kept
+    input logic i_results_valid,
+
+    input logic [OBJECT_INDEX_WIDTH-1:0] i_object_index,
+    input logic i_query,
+
+    // The cycle after the query
+    output logic o_render,
+    output logic o_dv
+    );
+
+    // Frames without visible pixels, up to the re-test frame. Objects are
+    // rendered below SKIP_FRAMES and in the re-test frame
+    localparam unsigned RETEST_STATE = SKIP_FRAMES + RETEST_FRAMES;
+    localparam unsigned STATE_WIDTH = $clog2(RETEST_STATE + 1);
+
+    logic r_clearing;
+    logic [OBJECT_INDEX_WIDTH-1:0] r_clear_addr;
+
+    logic r_query_valid;
+    logic r_query_results_valid;
+    logic [OBJECT_INDEX_WIDTH-1:0] r_query_index;
+
+    logic [STATE_WIDTH-1:0] w_state_read;
+    logic [STATE_WIDTH-1:0] w_state_next;
+
+    logic w_write_en;
+    logic [OBJECT_INDEX_WIDTH-1:0] w_addr_write;
+    logic [STATE_WIDTH-1:0] w_data_write;
+
+    bram_dp #(
+        .WIDTH(STATE_WIDTH),
+        .DEPTH(1 << OBJECT_INDEX_WIDTH)
+    ) state_inst (
+        .clk_write(clk),
+        .clk_read(clk),
+        .write_enable(w_write_en),
+        .addr_write(w_addr_write),
+        .addr_read(i_object_index),
+        .data_in(w_data_write),
+        .data_out(w_state_read)
+    );
+
+    assign o_occlusion_addr = i_object_index;
+
+    always_comb begin
+        if (i_occlusion_count != '0) begin
+            w_state_next = '0;
+        end else if (w_state_read == STATE_WIDTH'(RETEST_STATE)) begin
+            w_state_next = STATE_WIDTH'(SKIP_FRAMES);
+        end else begin
+            w_state_next = w_state_read + 1;
+        end
+
+        // Queries during the clear after reset are rendered
+        if (r_clearing) begin
+            w_write_en = 1'b1;
+            w_addr_write = r_clear_addr;
+            w_data_write = '0;
+            o_render = 1'b1;
+        end else if (~r_query_results_valid) begin
+            w_write_en = 1'b0;
+            w_addr_write = r_query_index;
+            w_data_write = w_state_next;
+            o_render = 1'b1;
+        end else begin
+            w_write_en = r_query_valid;
+            w_addr_write = r_query_index;
+            w_data_write = w_state_next;
+            o_render = (w_state_next < STATE_WIDTH'(SKIP_FRAMES)) ||
+                       (w_state_next == STATE_WIDTH'(RETEST_STATE));
+        end
+
+        o_dv = r_query_valid;
+    end
+
+    always_ff @(posedge clk) begin
+        if (~rstn) begin
+            r_clearing <= 1'b1;
+            r_clear_addr <= '0;
+            r_query_valid <= 1'b0;
+        end else begin
+            if (r_clearing) begin
+                r_clear_addr <= r_clear_addr + 1;
+                if (r_clear_addr == '1) begin
+                    r_clearing <= 1'b0;
+                end
+            end
+
+            r_query_valid <= i_query;
+            r_query_results_valid <= i_results_valid;
+            r_query_index <= i_object_index;
+        end
+    end
+
+endmodule
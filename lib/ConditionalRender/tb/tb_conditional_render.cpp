@@ -0,0 +1,156 @@
+#include <stdlib.h>
+#include <iostream>
+#include <cstdlib>
+#include <verilated.h>
+#include <verilated_vcd_c.h>
+#include "obj_dir/Vconditional_render.h"
+
+#define NUM_OBJECTS 16
+#define COUNTER_WIDTH 6
+#define COUNTER_MAX ((1 << COUNTER_WIDTH) - 1)
+#define SKIP_FRAMES 3
+#define RETEST_FRAMES 4
+#define RETEST_STATE (SKIP_FRAMES + RETEST_FRAMES)
+
+#define RESET_CLKS 8
+#define FRAME_CLKS (NUM_OBJECTS + 4)
+#define NUM_FRAMES 64
+#define MAX_SIM_TIME (2 * (RESET_CLKS + NUM_OBJECTS + FRAME_CLKS * (NUM_FRAMES + 1)))
+
+vluint64_t sim_time = 0;
+vluint64_t posedge_cnt = 0;
+
+// Object i % 4 == 0 is always visible when rendered, 1 never, 2 rarely and
+// 3 mostly
+bool visible(int object_index) {
+    switch (object_index % 4) {
+        case 0: return true;
+        case 1: return false;
+        case 2: return rand() % 4 == 0;
+        default: return rand() % 4 != 0;
+    }
+}
+
+int main(int argc, char** argv) {
+    srand(time(NULL));
+    Verilated::commandArgs(argc, argv);
+
+    Vconditional_render* dut = new Vconditional_render;
+
+    Verilated::traceEverOn(true);
+    VerilatedVcdC* m_trace = new VerilatedVcdC;
+    dut->trace(m_trace, 5);
+    m_trace->open("waveform.vcd");
+
+    int state[NUM_OBJECTS] = {0};
+    int counts[NUM_OBJECTS] = {0};      // Of the previous frame
+    bool render[NUM_OBJECTS] = {false};
+
+    dut->clk = 0;
+    dut->rstn = 0;
+    dut->i_query = 0;
+    dut->i_object_index = 0;
+    dut->i_occlusion_count = 0;
+    dut->i_results_valid = 1;
+
+    // Every frame all objects are queried back to back, and the occlusion
+    // count of the previous frame is returned the cycle after the address,
+    // like occlusion_counters. Skipped objects have no visible pixels, and
+    // some frames have no valid results, as after a frame deadline.
+    int errors = 0;
+    int num_skipped = 0;
+    int num_retested = 0;
+    int frame = 0;
+    int frame_cycle = 0;
+    int query_last = -1;
+    bool results_valid = true;
+    while (sim_time < MAX_SIM_TIME && frame < NUM_FRAMES) {
+        dut->clk ^= 1;
+        dut->eval();
+
+        if (dut->clk == 1) {
+            // Answer the query issued last cycle
+            if (query_last >= 0) {
+                dut->i_occlusion_count = counts[query_last];
+                dut->eval();
+
+                int i = query_last;
+                bool expected = true;
+                if (results_valid) {
+                    if (counts[i] != 0) {
+                        state[i] = 0;
+                    } else if (state[i] == RETEST_STATE) {
+                        state[i] = SKIP_FRAMES;
+                    } else {
+                        state[i]++;
+                    }
+                    expected = state[i] < SKIP_FRAMES || state[i] == RETEST_STATE;
+                }
+                render[i] = expected;
+
+                if (!dut->o_dv) {
+                    printf("Error: frame %d, object %d: no answer\n", frame, i);
+                    errors++;
+                } else if (dut->o_render != expected) {
+                    printf("Error: frame %d, object %d: expected %s, got %s\n", frame, i,
+                           expected ? "render" : "skip", dut->o_render ? "render" : "skip");
+                    errors++;
+                }
+                num_skipped += !expected;
+                num_retested += expected && state[i] == RETEST_STATE;
+            } else if (dut->o_dv) {
+                printf("Error: frame %d, answer without a query\n", frame);
+                errors++;
+            }
+            query_last = -1;
+
+            dut->rstn = posedge_cnt >= RESET_CLKS;
+            dut->i_query = 0;
+
+            // Wait for the state to be cleared after reset
+            if (posedge_cnt >= RESET_CLKS + NUM_OBJECTS + 2) {
+                if (frame_cycle == 0) {
+                    results_valid = rand() % 8 != 0;
+                    dut->i_results_valid = results_valid;
+                }
+
+                if (frame_cycle < NUM_OBJECTS) {
+                    dut->i_object_index = frame_cycle;
+                    dut->i_query = 1;
+                    query_last = frame_cycle;
+                }
+
+                // Render the frame
+                if (frame_cycle == FRAME_CLKS - 1) {
+                    for (int i = 0; i < NUM_OBJECTS; i++) {
+                        counts[i] = (render[i] && visible(i)) ? 1 + rand() % COUNTER_MAX : 0;
+                    }
+                    frame++;
+                }
+
+                frame_cycle = (frame_cycle + 1) % FRAME_CLKS;
+            }
+
+            posedge_cnt++;
+        }
+
+        m_trace->dump(sim_time);
+        sim_time++;
+    }
+
+    if (frame != NUM_FRAMES) {
+        printf("Error: only %d of %d frames queried\n", frame, NUM_FRAMES);
+        errors++;
+    }
+    if (num_skipped == 0 || num_retested == 0) {
+        printf("Error: %d objects skipped, %d re-tested\n", num_skipped, num_retested);
+        errors++;
+    }
+
+    m_trace->close();
+    printf("%s: %d errors\n", errors ? "FAILED" : "PASSED", errors);
+
+    delete dut;
+
+    exit(errors ? EXIT_FAILURE : EXIT_SUCCESS);
+}
@@ -12,6 +12,15 @@ module display_new #(
     parameter unsigned COLOR_CHANNEL_WIDTH = 4,
     parameter unsigned FB_CLEAR_VALUE = 0,
     parameter unsigned DB_CLEAR_VALUE = {DB_DATA_WIDTH{1'b1}},
+    parameter unsigned CLEAR_ON_SCANOUT = 0,    // Clear front buffer as it is scanned out
+    parameter unsigned NUM_FRAMEBUFFERS = 2,    // 2 (double) or 3 (triple buffering)
+    parameter unsigned FB_PIXELS_PER_WORD = 1,  // Framebuffer pixels per BRAM word, power of two
+    parameter unsigned LINE_BUFFER = 0,         // Fetch each row once on "clk" for all SCALE lines
+    parameter unsigned BACKGROUND_LAYER = 0,    // Cached static background, colour and depth
+    parameter unsigned DEPTH_BUFFER = 1,        // 0 when the rasterizer keeps depth on chip
+    parameter unsigned PACKED_DEPTH = 0,        // Depth tested render target of colour and depth words
+    parameter unsigned BAND_HEIGHT = 0,         // Beam racing with bands of this many rows, 0: off
+    parameter unsigned NUM_BAND_SLOTS = 2,      // Bands held in the band buffer ring
 
     parameter string PALETTE_FILE = "palette.mem",
     parameter string FB_IMAGE_FILE = "image.mem",
@@ -19,6 +28,10 @@ module display_new #(
     // Derived parameters
     parameter unsigned DISPLAY_DEPTH = DISPLAY_WIDTH*DISPLAY_HEIGHT,
     parameter unsigned DISPLAY_ADDR_WIDTH = $clog2(DISPLAY_DEPTH),
+    parameter unsigned DISPLAY_LENGTH_WIDTH = $clog2(DISPLAY_DEPTH + 1),
+    parameter unsigned FB_INDEX_WIDTH = $clog2(NUM_FRAMEBUFFERS),
+    parameter unsigned BAND_RING_ROWS = ((BAND_HEIGHT != 0) ? BAND_HEIGHT : 1) * NUM_BAND_SLOTS,
+    parameter unsigned BAND_DEPTH = DISPLAY_WIDTH * BAND_RING_ROWS,
 
     parameter unsigned CLUT_WIDTH = 3 * COLOR_CHANNEL_WIDTH,    // 4-bit r, g and b
     parameter unsigned CLUT_DEPTH = 1 << FB_DATA_WIDTH          // 2^4 colors
@@ -38,6 +51,44 @@ module display_new #(
     input logic [FB_DATA_WIDTH-1:0] i_fb_data,
     input logic [DB_DATA_WIDTH-1:0] i_db_data,
     input logic i_pixel_write_valid,
+    input logic i_pixel_write_static,       // Pixel is part of the static background
+
+    // Word write, any of the FB_PIXELS_PER_WORD pixels of one word in a cycle,
+    // for a renderer that writes spans of a row. Colour only: the depth
+    // buffer and background layer are not written, and it is ignored with
+    // PACKED_DEPTH or FB_PIXELS_PER_WORD = 1. A pixel write in the same cycle
+    // takes the write port, and the word write is lost.
+    /* verilator lint_off UNUSED */
+    input logic [DISPLAY_ADDR_WIDTH-1:0] i_word_write_addr,    // Any pixel of the word
+    input logic [FB_PIXELS_PER_WORD-1:0] i_word_write_mask,    // Pixels of the word that are written
+    input logic [FB_DATA_WIDTH*FB_PIXELS_PER_WORD-1:0] i_word_fb_data,     // Pixel 0 in the lowest bits
+    input logic i_word_write_valid,
+    /* verilator lint_on UNUSED */
+
+    // Background layer, "clk" clock domain. Sampled with frame_clear:
+    //  - background_capture: clear as normal, and store the static pixels of
+    //    this frame in the background layer. Valid when the render is done.
+    //  - otherwise, with a valid background, the frame starts as a copy of
+    //    the background instead of a clear.
+    // background_invalidate drops the background, e.g. when the camera moves.
+    input logic background_capture,
+    input logic background_invalidate,
+    output logic background_valid,
+
+    // Beam racing, "clk" clock domain. Bands below this may be written, the
+    // others are still waiting to be scanned out from their slot in the ring
+    output logic [DISPLAY_COORD_WIDTH-1:0] band_write_limit,
+
+    // Dynamic resolution, "clk" clock domain. The frame being rendered covers
+    // the top left DISPLAY >> res_shift of the render target, and is scanned
+    // out with a scale of SCALE << res_shift. Held until the frame is swapped.
+    // Not with BAND_HEIGHT or LINE_BUFFER, which hold full resolution rows
+    input logic [1:0] res_shift,
+
+    // Occlusion queries, "clk" clock domain. A pixel write passed the depth
+    // test. Without PACKED_DEPTH there is no depth test here, and every pixel
+    // write passes
+    output logic pixel_depth_pass,
 
     // VGA output signals
     output logic hsync,
@@ -48,8 +99,6 @@ module display_new #(
     output logic [COLOR_CHANNEL_WIDTH-1:0] o_blue
 );
 
-    localparam unsigned SCALE_MINUS_ONE = (SCALE > 1) ? (SCALE - 1) : 0;
-
     // Generates display signals
     logic signed [DISPLAY_COORD_WIDTH-1:0] screen_x, screen_y;
     logic de, frame;
@@ -80,116 +129,661 @@ module display_new #(
     logic [FB_DATA_WIDTH-1:0] delayed_i_fb_data;
     logic [DISPLAY_ADDR_WIDTH-1:0] delayed_addr_write;
 
+    logic r_word_write_en = 1'b0;
+    logic [DISPLAY_ADDR_WIDTH-1:0] r_word_addr_write;
+    logic [FB_PIXELS_PER_WORD-1:0] r_word_write_mask;
+    logic [FB_DATA_WIDTH*FB_PIXELS_PER_WORD-1:0] r_word_fb_data;
+
     // Depth buffer
     logic [DB_DATA_WIDTH-1:0] w_db_read_data;
     logic w_db_ready;
 
-    buffer #(
-        .WIDTH(DB_DATA_WIDTH),
-        .DEPTH(DISPLAY_DEPTH)
-    ) depth_buffer_inst (
-        .clk_write(clk),
-        .clk_read(clk),
-
-        .ready(w_db_ready),
-        .clear(frame_clear),
-        .clear_value(DB_CLEAR_VALUE),
-
-        .write_enable(r_display_buffers_write_en),
-        .addr_write(delayed_addr_write),
-        .addr_read(i_pixel_write_addr),
-        .data_in(delayed_i_db_data),
-        .data_out(w_db_read_data)
-    );
+    // Write port of the render target, shared by the renderer and the
+    // background restore
+    logic w_buffers_write_en;
+    logic [DISPLAY_ADDR_WIDTH-1:0] w_buffers_addr_write;
+    logic [FB_DATA_WIDTH-1:0] w_fb_data_write;
+    logic [DB_DATA_WIDTH-1:0] w_db_data_write;
+    logic w_frame_clear;
+
+    generate
+        if (DEPTH_BUFFER != 0 && PACKED_DEPTH == 0) begin : g_depth_buffer
+            buffer #(
+                .WIDTH(DB_DATA_WIDTH),
+                .DEPTH(DISPLAY_DEPTH)
+            ) depth_buffer_inst (
+                .clk_write(clk),
+                .clk_read(clk),
+
+                .ready(w_db_ready),
+                .clear(w_frame_clear),
+                .clear_value(DB_CLEAR_VALUE),
+                .clear_length(DISPLAY_LENGTH_WIDTH'(DISPLAY_DEPTH)),
+                .read_clear(1'b0),
+
+                .write_enable(w_buffers_write_en),
+                .addr_write(w_buffers_addr_write),
+                .addr_read(i_pixel_write_addr),
+                .data_in(w_db_data_write),
+                .data_out(w_db_read_data)
+            );
+        end else begin : g_no_depth_buffer
+            assign w_db_ready = 1'b1;
+            assign w_db_read_data = DB_DATA_WIDTH'(DB_CLEAR_VALUE);
+        end
+    endgenerate
+
+    // ============== PACKED RENDER TARGET ==============
+    // Colour and depth share one word, {depth, colour}, so a pixel is one read
+    // and one write on a single port pair. The depth test is done here. When
+    // the render is done the colours are copied to the framebuffer, and the
+    // copy clears the render target behind it, so it only needs an explicit
+    // clear before the first frame.
+    localparam unsigned PACKED_WIDTH = DB_DATA_WIDTH + FB_DATA_WIDTH;
+
+    logic r_pk_resolving = 1'b0;
+    logic r_pk_resolved = 1'b0;         // Resolved into the framebuffer, until frame_render_done drops
+    logic r_pk_cleared = 1'b0;          // Render target has been cleared by a resolve
+    logic [DISPLAY_ADDR_WIDTH-1:0] r_pk_resolve_addr;
+    logic r_pk_resolve_write_en = 1'b0;
+    logic [DISPLAY_ADDR_WIDTH-1:0] r_pk_resolve_addr_write;
+    logic r_pk_render_done_prev = 1'b0;
+
+    logic w_pk_ready;
+    logic [PACKED_WIDTH-1:0] w_pk_data_read;
+    logic [DB_DATA_WIDTH-1:0] w_pk_depth;
+    logic w_pk_depth_pass;
+    logic w_frame_render_done;
+
+    // The read for a pixel is issued before the write of the pixel in front
+    // of it, so the depth just written to the same address is forwarded
+    logic r_pk_bypass_valid = 1'b0;
+    logic [DISPLAY_ADDR_WIDTH-1:0] r_pk_bypass_addr;
+    logic [DB_DATA_WIDTH-1:0] r_pk_bypass_depth;
+
+    generate
+        if (PACKED_DEPTH != 0) begin : g_packed_render_target
+            buffer #(
+                .WIDTH(PACKED_WIDTH),
+                .DEPTH(DISPLAY_DEPTH),
+                .CLEAR_ON_READ(1)
+            ) packed_render_target_inst (
+                .clk_write(clk),
+                .clk_read(clk),
+
+                .ready(w_pk_ready),
+                .clear(w_frame_clear),
+                .clear_value({DB_DATA_WIDTH'(DB_CLEAR_VALUE), FB_DATA_WIDTH'(FB_CLEAR_VALUE)}),
+                .clear_length(r_pk_cleared ? '0 : DISPLAY_LENGTH_WIDTH'(DISPLAY_DEPTH)),
+                .read_clear(r_pk_resolving),
+
+                .write_enable(r_display_buffers_write_en && w_pk_depth_pass),
+                .addr_write(delayed_addr_write),
+                .addr_read(r_pk_resolving ? r_pk_resolve_addr : i_pixel_write_addr),
+                .data_in({delayed_i_db_data, delayed_i_fb_data}),
+                .data_out(w_pk_data_read)
+            );
+        end else begin : g_no_packed_render_target
+            assign w_pk_ready = 1'b1;
+            assign w_pk_data_read = '0;
+        end
+    endgenerate
 
-    // ============== FRAME BUFFERS ==============
-    // Selects which display should be the one to be rendered to. The other
-    // one will be used to display to the screen. 0 indicates inst_1 is active,
-    // 1 indicates inst_2 is active.
-    logic r_current_active_render_target = 1'b0;    // In pixel clock domain :/
-    logic [1:0] r_current_active_render_target_sync;
+    always_comb begin
+        if (r_pk_bypass_valid && r_pk_bypass_addr == delayed_addr_write) begin
+            w_pk_depth = r_pk_bypass_depth;
+        end else begin
+            w_pk_depth = w_pk_data_read[PACKED_WIDTH-1:FB_DATA_WIDTH];
+        end
 
-    logic w_fb_inst_1_write_en;
-    logic w_fb_inst_2_write_en;
+        w_pk_depth_pass = delayed_i_db_data < w_pk_depth;
+        pixel_depth_pass = r_display_buffers_write_en && (PACKED_DEPTH == 0 || w_pk_depth_pass);
+        w_frame_render_done = (PACKED_DEPTH != 0) ? r_pk_resolved : frame_render_done;
+    end
 
-    logic w_fb_inst_1_ready;
-    logic w_fb_inst_2_ready;
+    always_ff @(posedge clk) begin
+        if (~rstn) begin
+            r_pk_resolving <= 1'b0;
+            r_pk_resolved <= 1'b0;
+            r_pk_cleared <= 1'b0;
+            r_pk_resolve_write_en <= 1'b0;
+            r_pk_render_done_prev <= 1'b0;
+            r_pk_bypass_valid <= 1'b0;
+        end else begin
+            r_pk_render_done_prev <= frame_render_done;
+
+            r_pk_bypass_valid <= r_display_buffers_write_en && w_pk_depth_pass;
+            r_pk_bypass_addr <= delayed_addr_write;
+            r_pk_bypass_depth <= delayed_i_db_data;
+
+            // The render target has one cycle read latency
+            r_pk_resolve_write_en <= r_pk_resolving;
+            r_pk_resolve_addr_write <= r_pk_resolve_addr;
+
+            if (PACKED_DEPTH != 0 && frame_render_done && ~r_pk_render_done_prev) begin
+                r_pk_resolving <= 1'b1;
+                r_pk_resolve_addr <= '0;
+            end else if (r_pk_resolving) begin
+                if (r_pk_resolve_addr == DISPLAY_ADDR_WIDTH'(DISPLAY_DEPTH - 1)) begin
+                    r_pk_resolving <= 1'b0;
+                end else begin
+                    r_pk_resolve_addr <= r_pk_resolve_addr + 1;
+                end
+            end
 
-    logic w_fb_inst_1_clear;
-    logic w_fb_inst_2_clear;
+            if (~frame_render_done) begin
+                r_pk_resolved <= 1'b0;
+            end else if (r_pk_resolve_write_en && ~r_pk_resolving) begin
+                r_pk_resolved <= 1'b1;
+                r_pk_cleared <= 1'b1;
+            end
+        end
+    end
 
-    logic [FB_DATA_WIDTH-1:0] w_fb_inst_1_data_read;
-    logic [FB_DATA_WIDTH-1:0] w_fb_inst_2_data_read;
+    // ============== BACKGROUND LAYER ==============
+    // Holds the static part of the scene. A frame is started by copying it
+    // into the render target, which takes as long as a clear, and only the
+    // dynamic objects have to be rendered on top.
+    logic r_bg_valid = 1'b0;
+    logic r_bg_capture = 1'b0;         // Current frame is stored as the background
+    logic r_bg_restoring = 1'b0;
+    logic [DISPLAY_ADDR_WIDTH-1:0] r_bg_restore_addr;
+    logic r_bg_restore_write_en = 1'b0;
+    logic [DISPLAY_ADDR_WIDTH-1:0] r_bg_restore_addr_write;
+    logic r_frame_render_done_prev = 1'b0;
+    logic delayed_i_static;
+
+    logic w_bg_restore;
+    logic w_bg_ready;
+    logic [FB_DATA_WIDTH-1:0] w_bg_fb_data_read;
+    logic [DB_DATA_WIDTH-1:0] w_bg_db_data_read;
+
+    assign w_bg_restore = frame_clear && r_bg_valid && ~background_capture && ~background_invalidate;
+    assign w_frame_clear = frame_clear && ~w_bg_restore;
+    assign background_valid = r_bg_valid;
+
+    generate
+        if (BACKGROUND_LAYER != 0) begin : g_background_layer
+            logic w_bg_write_en;
+            logic w_bg_fb_ready;
+            logic w_bg_db_ready;
+
+            assign w_bg_write_en = r_display_buffers_write_en && delayed_i_static && r_bg_capture;
+            assign w_bg_ready = w_bg_fb_ready && w_bg_db_ready;
+
+            buffer #(
+                .WIDTH(FB_DATA_WIDTH),
+                .DEPTH(DISPLAY_DEPTH)
+            ) background_fb_inst (
+                .clk_write(clk),
+                .clk_read(clk),
+
+                .ready(w_bg_fb_ready),
+                .clear(frame_clear && background_capture),
+                .clear_value(FB_CLEAR_VALUE),
+                .clear_length(DISPLAY_LENGTH_WIDTH'(DISPLAY_DEPTH)),
+                .read_clear(1'b0),
+
+                .write_enable(w_bg_write_en),
+                .addr_write(delayed_addr_write),
+                .addr_read(r_bg_restore_addr),
+                .data_in(delayed_i_fb_data),
+                .data_out(w_bg_fb_data_read)
+            );
+
+            buffer #(
+                .WIDTH(DB_DATA_WIDTH),
+                .DEPTH(DISPLAY_DEPTH)
+            ) background_db_inst (
+                .clk_write(clk),
+                .clk_read(clk),
+
+                .ready(w_bg_db_ready),
+                .clear(frame_clear && background_capture),
+                .clear_value(DB_CLEAR_VALUE),
+                .clear_length(DISPLAY_LENGTH_WIDTH'(DISPLAY_DEPTH)),
+                .read_clear(1'b0),
+
+                .write_enable(w_bg_write_en),
+                .addr_write(delayed_addr_write),
+                .addr_read(r_bg_restore_addr),
+                .data_in(delayed_i_db_data),
+                .data_out(w_bg_db_data_read)
+            );
+        end else begin : g_no_background_layer
+            assign w_bg_ready = 1'b1;
+            assign w_bg_fb_data_read = '0;
+            assign w_bg_db_data_read = '0;
+        end
+    endgenerate
+
+    always_ff @(posedge clk) begin
+        if (~rstn) begin
+            r_bg_valid <= 1'b0;
+            r_bg_capture <= 1'b0;
+            r_bg_restoring <= 1'b0;
+            r_bg_restore_addr <= '0;
+            r_bg_restore_write_en <= 1'b0;
+            r_frame_render_done_prev <= 1'b0;
+        end else begin
+            r_frame_render_done_prev <= frame_render_done;
+
+            // The background buffers have one cycle read latency
+            r_bg_restore_write_en <= r_bg_restoring;
+            r_bg_restore_addr_write <= r_bg_restore_addr;
+
+            if (background_invalidate) begin
+                r_bg_valid <= 1'b0;
+                r_bg_capture <= 1'b0;
+            end else if (frame_clear) begin
+                if (background_capture && BACKGROUND_LAYER != 0) begin
+                    r_bg_valid <= 1'b0;
+                    r_bg_capture <= 1'b1;
+                end else if (w_bg_restore) begin
+                    r_bg_restoring <= 1'b1;
+                    r_bg_restore_addr <= '0;
+                end
+            end else if (r_bg_capture && frame_render_done && ~r_frame_render_done_prev) begin
+                r_bg_valid <= 1'b1;
+                r_bg_capture <= 1'b0;
+            end
+
+            if (r_bg_restoring) begin
+                if (r_bg_restore_addr == DISPLAY_ADDR_WIDTH'(DISPLAY_DEPTH - 1)) begin
+                    r_bg_restoring <= 1'b0;
+                end else begin
+                    r_bg_restore_addr <= r_bg_restore_addr + 1;
+                end
+            end
+        end
+    end
+
+    always_comb begin
+        if (PACKED_DEPTH != 0) begin
+            // Only the resolve writes the framebuffer
+            w_buffers_write_en = r_pk_resolve_write_en;
+            w_buffers_addr_write = r_pk_resolve_addr_write;
+            w_fb_data_write = w_pk_data_read[FB_DATA_WIDTH-1:0];
+            w_db_data_write = w_pk_data_read[PACKED_WIDTH-1:FB_DATA_WIDTH];
+        end else if (r_bg_restore_write_en) begin
+            w_buffers_write_en = 1'b1;
+            w_buffers_addr_write = r_bg_restore_addr_write;
+            w_fb_data_write = w_bg_fb_data_read;
+            w_db_data_write = w_bg_db_data_read;
+        end else begin
+            w_buffers_write_en = r_display_buffers_write_en;
+            w_buffers_addr_write = delayed_addr_write;
+            w_fb_data_write = delayed_i_fb_data;
+            w_db_data_write = delayed_i_db_data;
+        end
+    end
+
+    // ============== FRAME BUFFERS ==============
+    // With double buffering one buffer is rendered to while the other one is
+    // displayed, and they are swapped at the first frame after the render is
+    // done. With triple buffering a finished render is queued as "pending"
+    // and rendering continues straight away in the third buffer. The pending
+    // buffer is displayed at the next frame. If another render finishes before
+    // that, the pending frame is dropped and its buffer is rendered to again.
+    //
+    // Buffer indices are owned by the pixel clock domain.
+    logic [FB_INDEX_WIDTH-1:0] r_front_fb = FB_INDEX_WIDTH'(1);
+    logic [FB_INDEX_WIDTH-1:0] r_render_fb = '0;
+    logic r_pending_valid = 1'b0;
+    logic [FB_INDEX_WIDTH-1:0] w_third_fb;  // Pending or free buffer with 3 buffers
+
+    logic [FB_INDEX_WIDTH-1:0] r_render_fb_sync[2];
+
+    logic w_fb_write_en[NUM_FRAMEBUFFERS];
+    logic w_fb_word_write_en[NUM_FRAMEBUFFERS];
+    logic w_fb_ready[NUM_FRAMEBUFFERS];
+    logic w_fb_clear[NUM_FRAMEBUFFERS];
+    logic [FB_DATA_WIDTH-1:0] w_fb_data_read[NUM_FRAMEBUFFERS];
+    logic [FB_DATA_WIDTH-1:0] w_band_data_read;
+
+    // Clear-on-scanout. Once the front buffer is known to be replaced at the
+    // next frame, it is overwritten with FB_CLEAR_VALUE behind the scanout
+    // read. The first address cleared this way is recorded, such that the
+    // explicit clear of a buffer only has to cover the addresses below it.
+    logic [1:0] r_render_done_sync;
+    logic r_render_done_armed = 1'b0;   // Render restarted since last swap
+    logic w_render_done;
+    logic w_front_fb_replaced;          // Front buffer is replaced at next frame
+    logic r_fb_read_clear = 1'b0;
+    logic [DISPLAY_LENGTH_WIDTH-1:0] r_scanout_clear_start = DISPLAY_LENGTH_WIDTH'(DISPLAY_DEPTH);
+    logic [DISPLAY_LENGTH_WIDTH-1:0] r_fb_clear_length[NUM_FRAMEBUFFERS];
+
+    // Only changes when the render target changes, and frame_clear is not
+    // issued before that has been seen in the "clk" domain, so it is stable
+    // when sampled there.
+    logic [DISPLAY_LENGTH_WIDTH-1:0] r_render_target_clear_length = DISPLAY_LENGTH_WIDTH'(DISPLAY_DEPTH);
+
+    initial begin
+        foreach (r_fb_clear_length[i]) r_fb_clear_length[i] = DISPLAY_LENGTH_WIDTH'(DISPLAY_DEPTH);
+    end
+
+    always_comb begin
+        w_third_fb = FB_INDEX_WIDTH'(3) - r_front_fb - r_render_fb;
+        w_render_done = r_render_done_armed && r_render_done_sync[1];
+        w_front_fb_replaced = (NUM_FRAMEBUFFERS == 3) ? r_pending_valid : w_render_done;
+    end
 
     // Logic for determining which display should be interacted with
     // "clk" clock domain
     always_comb begin
-        if (r_current_active_render_target_sync[1]) begin
-            w_fb_inst_2_write_en = r_display_buffers_write_en & w_fb_inst_2_ready;
-            w_fb_inst_2_clear = frame_clear;
-            w_display_buffers_ready = w_fb_inst_2_ready; //  && w_db_ready
+        w_display_buffers_ready = w_fb_ready[r_render_fb_sync[1]]; //  && w_db_ready
+
+        for (int i = 0; i < NUM_FRAMEBUFFERS; i++) begin
+            if (r_render_fb_sync[1] == FB_INDEX_WIDTH'(i)) begin
+                w_fb_write_en[i] = w_buffers_write_en & w_fb_ready[i];
+                w_fb_word_write_en[i] = r_word_write_en & ~w_buffers_write_en & w_fb_ready[i];
+                w_fb_clear[i] = w_frame_clear && (PACKED_DEPTH == 0);   // Resolve writes every pixel
+            end else begin
+                w_fb_write_en[i] = '0;
+                w_fb_word_write_en[i] = '0;
+                w_fb_clear[i] = '0;
+            end
+        end
+    end
+
+    // Scanout counters are crossed to the "clk" domain Gray coded
+    function automatic logic [DISPLAY_COORD_WIDTH-1:0] gray_to_binary(
+        input logic [DISPLAY_COORD_WIDTH-1:0] gray
+    );
+        logic [DISPLAY_COORD_WIDTH-1:0] binary;
 
-            w_fb_inst_1_write_en = '0;
-            w_fb_inst_1_clear = '0;
+        binary[DISPLAY_COORD_WIDTH-1] = gray[DISPLAY_COORD_WIDTH-1];
+        for (int i = DISPLAY_COORD_WIDTH - 2; i >= 0; i--) begin
+            binary[i] = binary[i+1] ^ gray[i];
+        end
+        return binary;
+    endfunction
+
+    // ================= LINE BUFFER =================
+    // The scanout reads every framebuffer row SCALE times. With LINE_BUFFER
+    // each row is instead copied once, in a burst on "clk", into one of two
+    // row slots, and replayed from there. The framebuffer read port is then
+    // busy for DISPLAY_WIDTH "clk" cycles per row, instead of for the whole
+    // scanout.
+    //
+    // The scanout counts the rows it has started, including one step at the
+    // start of vertical blanking for row 0, so step n is row n of the frame
+    // and uses slot n % 2. The count is crossed Gray coded. A row is fetched
+    // once the scanout has started the row before it, but row 0 not before
+    // the frame has started, as the front buffer may be swapped there.
+    // Clear-on-scanout is not used in this mode.
+    logic [DISPLAY_COORD_WIDTH-1:0] r_lb_seq = '0;          // "clk_pixel"
+    logic [DISPLAY_COORD_WIDTH-1:0] r_lb_seq_gray = '0;
+    logic [DISPLAY_COORD_WIDTH-1:0] r_lb_seq_sync[3];
+    logic [FB_INDEX_WIDTH-1:0] r_lb_front_fb_sync[2];
+    logic [DISPLAY_COORD_WIDTH-1:0] w_lb_display_seq;
+    logic signed [DISPLAY_COORD_WIDTH-1:0] w_lb_fetch_ahead;
+
+    logic [DISPLAY_COORD_WIDTH-1:0] r_lb_fetch_seq;
+    logic [DISPLAY_ADDR_WIDTH-1:0] r_lb_fetch_row;
+    logic [DISPLAY_ADDR_WIDTH-1:0] r_lb_fetch_row_addr;
+    logic r_lb_fetching;
+    logic [DISPLAY_ADDR_WIDTH-1:0] r_lb_fetch_x;
+    logic [DISPLAY_ADDR_WIDTH-1:0] r_lb_fetch_addr;
+    logic r_lb_write_en;
+    logic [DISPLAY_ADDR_WIDTH-1:0] r_lb_write_addr;
+    logic [FB_DATA_WIDTH-1:0] w_lb_data_read;
+
+    assign w_lb_display_seq = gray_to_binary(r_lb_seq_sync[2]);
+    assign w_lb_fetch_ahead = $signed(r_lb_fetch_seq - w_lb_display_seq);
+
+    generate
+        if (LINE_BUFFER != 0 && BAND_HEIGHT == 0 && FB_PIXELS_PER_WORD == 1) begin : g_line_buffer
+            bram_dp #(
+                .WIDTH(FB_DATA_WIDTH),
+                .DEPTH(2 * DISPLAY_WIDTH)
+            ) line_buffer_inst (
+                .clk_write(clk),
+                .clk_read(clk_pixel),
+                .write_enable(r_lb_write_en),
+                .addr_write(r_lb_write_addr[$clog2(2 * DISPLAY_WIDTH)-1:0]),
+                .addr_read(r_fb_addr_read[$clog2(2 * DISPLAY_WIDTH)-1:0]),
+                .data_in(w_fb_data_read[r_lb_front_fb_sync[1]]),
+                .data_out(w_lb_data_read)
+            );
+        end else begin : g_no_line_buffer
+            assign w_lb_data_read = '0;
+        end
+    endgenerate
+
+    always_ff @(posedge clk) begin
+        // One stage more than the front buffer index, such that the index has
+        // settled when row 0 of a new frame is fetched
+        r_lb_seq_sync[0] <= r_lb_seq_gray;
+        r_lb_seq_sync[1] <= r_lb_seq_sync[0];
+        r_lb_seq_sync[2] <= r_lb_seq_sync[1];
+        r_lb_front_fb_sync[0] <= r_front_fb;
+        r_lb_front_fb_sync[1] <= r_lb_front_fb_sync[0];
 
+        if (~rstn) begin
+            r_lb_fetch_seq <= DISPLAY_COORD_WIDTH'(1);
+            r_lb_fetch_row <= '0;
+            r_lb_fetch_row_addr <= '0;
+            r_lb_fetching <= 1'b0;
+            r_lb_write_en <= 1'b0;
         end else begin
-            w_fb_inst_1_write_en = r_display_buffers_write_en & w_fb_inst_1_ready;
-            w_fb_inst_1_clear = frame_clear;
-            w_display_buffers_ready = w_fb_inst_1_ready; //  && w_db_ready
+            // The framebuffer has one cycle read latency
+            r_lb_write_en <= r_lb_fetching;
+            r_lb_write_addr <= (r_lb_fetch_seq[0] ? DISPLAY_ADDR_WIDTH'(DISPLAY_WIDTH) : '0) + r_lb_fetch_x;
+
+            if (r_lb_fetching) begin
+                r_lb_fetch_x <= r_lb_fetch_x + 1;
+                r_lb_fetch_addr <= r_lb_fetch_addr + 1;
 
-            w_fb_inst_2_write_en = '0;
-            w_fb_inst_2_clear = '0;
+                if (r_lb_fetch_x == DISPLAY_ADDR_WIDTH'(DISPLAY_WIDTH - 1)) begin
+                    r_lb_fetching <= 1'b0;
+                    r_lb_fetch_seq <= r_lb_fetch_seq + 1;
 
+                    if (r_lb_fetch_row == DISPLAY_ADDR_WIDTH'(DISPLAY_HEIGHT - 1)) begin
+                        r_lb_fetch_row <= '0;
+                        r_lb_fetch_row_addr <= '0;
+                    end else begin
+                        r_lb_fetch_row <= r_lb_fetch_row + 1;
+                        r_lb_fetch_row_addr <= r_lb_fetch_row_addr + DISPLAY_ADDR_WIDTH'(DISPLAY_WIDTH);
+                    end
+                end
+            end else if (LINE_BUFFER != 0 &&
+                         w_lb_fetch_ahead <= ((r_lb_fetch_row == '0) ? 0 : 1)) begin
+                r_lb_fetching <= 1'b1;
+                r_lb_fetch_x <= '0;
+                r_lb_fetch_addr <= r_lb_fetch_row_addr;
+            end
         end
     end
 
     // "clk_pixel" clock domain
     always_comb begin
-        if (r_current_active_render_target) begin
-            w_display_data_read = w_fb_inst_1_data_read;
+        if (BAND_HEIGHT != 0) begin
+            w_display_data_read = w_band_data_read;
+        end else if (LINE_BUFFER != 0) begin
+            w_display_data_read = w_lb_data_read;
         end else begin
-            w_display_data_read = w_fb_inst_2_data_read;
+            w_display_data_read = w_fb_data_read[r_front_fb];
         end
     end
 
     // Framebuffer instantiations
-    buffer #(
-        .WIDTH(FB_DATA_WIDTH),
-        .DEPTH(DISPLAY_DEPTH),
-        .FILE(FB_IMAGE_FILE)
-    ) framebuffer_inst_1 (
-        .clk_write(clk),
-        .clk_read(clk_pixel),
-
-        .ready(w_fb_inst_1_ready),
-        .clear(w_fb_inst_1_clear),
-        .clear_value(FB_CLEAR_VALUE),
-
-        .write_enable(w_fb_inst_1_write_en),
-        .addr_write(delayed_addr_write),
-        .addr_read(r_fb_addr_read),
-        .data_in(delayed_i_fb_data),
-        .data_out(w_fb_inst_1_data_read)
-    );
+    generate
+        if (BAND_HEIGHT == 0 && FB_PIXELS_PER_WORD == 1) begin : g_framebuffers
+            for (genvar i = 0; i < NUM_FRAMEBUFFERS; i++) begin : g_framebuffer
+                buffer #(
+                    .WIDTH(FB_DATA_WIDTH),
+                    .DEPTH(DISPLAY_DEPTH),
+                    .FILE(FB_IMAGE_FILE),
+                    .CLEAR_ON_READ(CLEAR_ON_SCANOUT)
+                ) framebuffer_inst (
+                    .clk_write(clk),
+                    .clk_read((LINE_BUFFER != 0) ? clk : clk_pixel),
+
+                    .ready(w_fb_ready[i]),
+                    .clear(w_fb_clear[i]),
+                    .clear_value(FB_CLEAR_VALUE),
+                    .clear_length(r_render_target_clear_length),
+                    .read_clear(r_fb_read_clear & (r_front_fb == FB_INDEX_WIDTH'(i))),
+
+                    .write_enable(w_fb_write_en[i]),
+                    .addr_write(w_buffers_addr_write),
+                    .addr_read((LINE_BUFFER != 0) ? r_lb_fetch_addr : r_fb_addr_read),
+                    .data_in(w_fb_data_write),
+                    .data_out(w_fb_data_read[i])
+                );
+            end
 
-    buffer #(
-        .WIDTH(FB_DATA_WIDTH),
-        .DEPTH(DISPLAY_DEPTH),
-        .FILE(FB_IMAGE_FILE)
-    ) framebuffer_inst_2 (
-        .clk_write(clk),
-        .clk_read(clk_pixel),
-
-        .ready(w_fb_inst_2_ready),
-        .clear(w_fb_inst_2_clear),
-        .clear_value(FB_CLEAR_VALUE),
-
-        .write_enable(w_fb_inst_2_write_en),
-        .addr_write(delayed_addr_write),
-        .addr_read(r_fb_addr_read),
-        .data_in(delayed_i_fb_data),
-        .data_out(w_fb_inst_2_data_read)
-    );
+            assign w_band_data_read = '0;
+        end else if (BAND_HEIGHT == 0) begin : g_wide_framebuffers
+            // FB_PIXELS_PER_WORD pixels per word. A single pixel write only
+            // enables its own pixel, a word write the pixels of its mask. The
+            // scanout reads a word once, when it reaches it, and steps through
+            // its pixels in the held read data. Clear-on-scanout clears a word
+            // after its last pixel.
+            localparam unsigned WORD_SHIFT = $clog2(FB_PIXELS_PER_WORD);
+            localparam unsigned NUM_WORDS = (DISPLAY_DEPTH + FB_PIXELS_PER_WORD - 1) / FB_PIXELS_PER_WORD;
+            localparam unsigned WORD_ADDR_WIDTH = $clog2(NUM_WORDS);
+            localparam unsigned WORD_LENGTH_WIDTH = $clog2(NUM_WORDS + 1);
+
+            logic [WORD_ADDR_WIDTH-1:0] w_write_word_addr;
+            logic [FB_PIXELS_PER_WORD-1:0] w_write_pixel_enable;
+            logic [FB_DATA_WIDTH*FB_PIXELS_PER_WORD-1:0] w_write_word;
+            logic [WORD_SHIFT-1:0] r_read_pixel;
+            logic [WORD_ADDR_WIDTH-1:0] r_read_word_addr;
+            logic [WORD_LENGTH_WIDTH-1:0] w_clear_length;
+            logic w_read_word_en;
+            logic w_read_word_done;
+
+            always_comb begin
+                if (w_buffers_write_en) begin
+                    w_write_word_addr = w_buffers_addr_write[DISPLAY_ADDR_WIDTH-1:WORD_SHIFT];
+                    w_write_pixel_enable = FB_PIXELS_PER_WORD'(1) << w_buffers_addr_write[WORD_SHIFT-1:0];
+                    w_write_word = {FB_PIXELS_PER_WORD{w_fb_data_write}};
+                end else begin
+                    w_write_word_addr = r_word_addr_write[DISPLAY_ADDR_WIDTH-1:WORD_SHIFT];
+                    w_write_pixel_enable = r_word_write_mask;
+                    w_write_word = r_word_fb_data;
+                end
+            end
+
+            // A word is read on the first of the SCALE reads of its first
+            // pixel, or of the first pixel of a row that starts within it
+            assign w_read_word_en = r_fb_read_first &&
+                                    (r_fb_addr_read[WORD_SHIFT-1:0] == '0 ||
+                                     r_fb_addr_read[DISPLAY_ADDR_WIDTH-1:WORD_SHIFT] != r_read_word_addr);
+            assign w_clear_length = WORD_LENGTH_WIDTH'((r_render_target_clear_length + FB_PIXELS_PER_WORD - 1) >> WORD_SHIFT);
+            assign w_read_word_done = (r_fb_addr_read[WORD_SHIFT-1:0] == '1);
+
+            // Matches the read latency
+            always_ff @(posedge clk_pixel) begin
+                r_read_pixel <= r_fb_addr_read[WORD_SHIFT-1:0];
+                if (w_read_word_en) begin
+                    r_read_word_addr <= r_fb_addr_read[DISPLAY_ADDR_WIDTH-1:WORD_SHIFT];
+                end
+            end
+
+            for (genvar i = 0; i < NUM_FRAMEBUFFERS; i++) begin : g_framebuffer
+                logic [FB_DATA_WIDTH*FB_PIXELS_PER_WORD-1:0] w_word_read;
+
+                buffer_wide #(
+                    .PIXEL_WIDTH(FB_DATA_WIDTH),
+                    .PIXELS_PER_WORD(FB_PIXELS_PER_WORD),
+                    .DEPTH(NUM_WORDS),
+                    .CLEAR_ON_READ(CLEAR_ON_SCANOUT)
+                ) framebuffer_inst (
+                    .clk_write(clk),
+                    .clk_read(clk_pixel),
+
+                    .ready(w_fb_ready[i]),
+                    .clear(w_fb_clear[i]),
+                    .clear_value(FB_CLEAR_VALUE),
+                    .clear_length(w_clear_length),
+                    .read_clear(r_fb_read_clear & w_read_word_done & (r_front_fb == FB_INDEX_WIDTH'(i))),
+
+                    .write_enable(w_fb_write_en[i] || w_fb_word_write_en[i]),
+                    .pixel_enable(w_write_pixel_enable),
+                    .addr_write(w_write_word_addr),
+                    .addr_read(r_fb_addr_read[DISPLAY_ADDR_WIDTH-1:WORD_SHIFT]),
+                    .read_enable(w_read_word_en),
+                    .data_in(w_write_word),
+                    .data_out(w_word_read)
+                );
+
+                assign w_fb_data_read[i] = w_word_read[r_read_pixel*FB_DATA_WIDTH +: FB_DATA_WIDTH];
+            end
+
+            assign w_band_data_read = '0;
+        end else begin : g_band_buffer
+            // Beam racing. The renderer writes each band just ahead of the
+            // scanout into a ring of NUM_BAND_SLOTS bands, and writes every
+            // pixel of it, so there is nothing to clear or swap.
+            bram_dp #(
+                .WIDTH(FB_DATA_WIDTH),
+                .DEPTH(BAND_DEPTH)
+            ) band_buffer_inst (
+                .clk_write(clk),
+                .clk_read(clk_pixel),
+                .write_enable(w_buffers_write_en),
+                .addr_write(w_buffers_addr_write[$clog2(BAND_DEPTH)-1:0]),
+                .addr_read(r_fb_addr_read[$clog2(BAND_DEPTH)-1:0]),
+                .data_in(w_fb_data_write),
+                .data_out(w_band_data_read)
+            );
+
+            for (genvar i = 0; i < NUM_FRAMEBUFFERS; i++) begin : g_no_framebuffer
+                assign w_fb_ready[i] = 1'b1;
+                assign w_fb_data_read[i] = '0;
+            end
+        end
+    endgenerate
+
+    // ================= BAND SCANOUT =================
+    // Bands completely scanned out this frame, "clk_pixel" clock domain. It is
+    // crossed Gray coded. It only steps by one, except for the reset at the
+    // start of vertical blanking, when the renderer has not started the frame
+    // yet and does not write out bands.
+    logic [DISPLAY_ADDR_WIDTH-1:0] r_band_row, r_band_line;
+    logic [DISPLAY_COORD_WIDTH-1:0] r_bands_scanned = '0;
+    logic [DISPLAY_COORD_WIDTH-1:0] r_bands_scanned_gray = '0;
+    logic [DISPLAY_COORD_WIDTH-1:0] r_bands_scanned_sync[2];
+
+    always_ff @(posedge clk) begin
+        r_bands_scanned_sync[0] <= r_bands_scanned_gray;
+        r_bands_scanned_sync[1] <= r_bands_scanned_sync[0];
+
+        if (BAND_HEIGHT != 0) begin
+            band_write_limit <= gray_to_binary(r_bands_scanned_sync[1]) + DISPLAY_COORD_WIDTH'(NUM_BAND_SLOTS);
+        end else begin
+            band_write_limit <= '1;
+        end
+    end
+
+    // ================= DYNAMIC RESOLUTION =================
+    // The shift of a frame is recorded with its buffer when the render is
+    // done, and applies while that buffer is the front buffer. res_shift has
+    // been stable for the whole render when it is sampled.
+    logic [1:0] r_res_shift_sync[2];
+    logic [1:0] r_fb_res_shift[NUM_FRAMEBUFFERS];
+    logic [1:0] w_scan_res_shift;
+    logic [DISPLAY_COORD_WIDTH-1:0] w_scale_minus_one;
+    logic [DISPLAY_ADDR_WIDTH-1:0] w_fb_x_last, w_fb_y_last;
+
+    initial begin
+        foreach (r_fb_res_shift[i]) r_fb_res_shift[i] = '0;
+    end
+
+    always_ff @(posedge clk_pixel) begin
+        r_res_shift_sync[0] <= res_shift;
+        r_res_shift_sync[1] <= r_res_shift_sync[0];
+    end
+
+    always_comb begin
+        w_scan_res_shift = (BAND_HEIGHT == 0 && LINE_BUFFER == 0) ? r_fb_res_shift[r_front_fb] : '0;
+        w_scale_minus_one = DISPLAY_COORD_WIDTH'((SCALE << w_scan_res_shift) - 1);
+        w_fb_x_last = DISPLAY_ADDR_WIDTH'((DISPLAY_WIDTH >> w_scan_res_shift) - 1);
+        w_fb_y_last = DISPLAY_ADDR_WIDTH'((DISPLAY_HEIGHT >> w_scan_res_shift) - 1);
+    end
 
     // ================= CLUT =================
     logic [CLUT_WIDTH-1:0] clut_data;
@@ -206,10 +800,10 @@ module display_new #(
     // ================= STATE =================
     logic [DISPLAY_COORD_WIDTH-1:0] x_scale_counter, y_scale_counter;
     logic [DISPLAY_ADDR_WIDTH-1:0] fb_x, fb_y;
+    logic r_fb_read_first = 1'b0;      // r_fb_addr_read has just changed
 
-    logic [1:0] r_frame_render_done_sync;
-    logic [1:0] r_frame_swapped_sync;
-    logic r_frame_swapped;
+    logic [2:0] r_frame_swapped_sync;
+    logic r_frame_swapped = 1'b0;
 
     logic pixel_in_fb;
     // always_comb begin
@@ -217,12 +811,18 @@ module display_new #(
 
     always_ff @(posedge clk) begin
         if (~rstn) begin
-            r_current_active_render_target_sync[0] <= '0;
-            r_current_active_render_target_sync[1] <= '0;
+            r_render_fb_sync[0] <= '0;
+            r_render_fb_sync[1] <= '0;
         end else begin
             delayed_i_db_data <= i_db_data;
             delayed_i_fb_data <= i_fb_data;
             delayed_addr_write <= i_pixel_write_addr;
+            delayed_i_static <= i_pixel_write_static;
+
+            r_word_write_en <= i_word_write_valid && (PACKED_DEPTH == 0);
+            r_word_addr_write <= i_word_write_addr;
+            r_word_write_mask <= i_word_write_mask;
+            r_word_fb_data <= i_word_fb_data;
 
             if (i_pixel_write_valid) begin //  && (delayed_i_db_data < w_db_read_data)
                 r_display_buffers_write_en <= 1;
@@ -230,74 +830,152 @@ module display_new #(
                 r_display_buffers_write_en <= 0;
             end
 
+            // The extra stage makes sure the multi-bit render target index
+            // has settled before the swap is signalled
             r_frame_swapped_sync[0] <= r_frame_swapped;
             r_frame_swapped_sync[1] <= r_frame_swapped_sync[0];
+            r_frame_swapped_sync[2] <= r_frame_swapped_sync[1];
 
-            r_current_active_render_target_sync[0] <= r_current_active_render_target;
-            r_current_active_render_target_sync[1] <= r_current_active_render_target_sync[0];
+            r_render_fb_sync[0] <= r_render_fb;
+            r_render_fb_sync[1] <= r_render_fb_sync[0];
         end
     end
-    assign frame_swapped = r_frame_swapped_sync[1];
+    assign frame_swapped = r_frame_swapped_sync[2];
 
+    // Buffer rotation, "clk_pixel" clock domain
     always_ff @(posedge clk_pixel) begin
-        pixel_in_fb <= (0 <= screen_y && screen_y < DISPLAY_HEIGHT * SCALE &&
-                        0 <= screen_x && screen_x < DISPLAY_WIDTH * SCALE);
+        r_render_done_sync[0] <= w_frame_render_done;
+        r_render_done_sync[1] <= r_render_done_sync[0];
 
+        if (~r_render_done_sync[1]) begin
+            r_render_done_armed <= 1'b1;
+        end
 
-        if (frame) begin
-            r_frame_render_done_sync[0] <= '0;
-            r_frame_render_done_sync[1] <= '0;
+        r_frame_swapped <= 1'b0;
 
-            if (r_frame_render_done_sync[1]) begin
-                r_current_active_render_target <= ~r_current_active_render_target;
+        if (NUM_FRAMEBUFFERS == 3 && BAND_HEIGHT == 0) begin
+            if (frame) begin
+                // Display the pending frame. The old front buffer becomes free
+                if (r_pending_valid) begin
+                    r_front_fb <= w_third_fb;
+                    r_pending_valid <= 1'b0;
+                    r_fb_clear_length[r_front_fb] <= r_scanout_clear_start;
+                end
+            end else if (w_render_done) begin
+                // Queue the finished frame and continue in the third buffer,
+                // which is either free or holds a pending frame that is dropped
+                r_render_fb <= w_third_fb;
+                r_fb_res_shift[r_render_fb] <= r_res_shift_sync[1];
+                r_pending_valid <= 1'b1;
                 r_frame_swapped <= 1'b1;
-            end else begin
-                r_frame_swapped <= 1'b0;
+                r_render_done_armed <= 1'b0;
+
+                if (r_pending_valid) begin
+                    r_render_target_clear_length <= DISPLAY_LENGTH_WIDTH'(DISPLAY_DEPTH);
+                end else begin
+                    r_render_target_clear_length <= r_fb_clear_length[w_third_fb];
+                end
             end
+        end else begin
+            if (frame && w_render_done) begin
+                r_front_fb <= r_render_fb;
+                r_render_fb <= r_front_fb;
+                r_fb_res_shift[r_render_fb] <= r_res_shift_sync[1];
+                r_frame_swapped <= 1'b1;
+                r_render_done_armed <= 1'b0;
+
+                r_render_target_clear_length <= r_scanout_clear_start;
+            end
+        end
+    end
+
+    always_ff @(posedge clk_pixel) begin
+        pixel_in_fb <= (0 <= screen_y && screen_y < DISPLAY_HEIGHT * SCALE &&
+                        0 <= screen_x && screen_x < DISPLAY_WIDTH * SCALE);
+
+        if (frame) begin
+            r_fb_read_clear <= 1'b0;
+            r_fb_read_first <= 1'b0;
+            r_scanout_clear_start <= DISPLAY_LENGTH_WIDTH'(DISPLAY_DEPTH);
 
             x_scale_counter <= '0;
             y_scale_counter <= '0;
             fb_x <= '0;
             fb_y <= '0;
             r_fb_addr_read <= '0;
+            r_lb_seq <= r_lb_seq + 1;
+
+            r_band_row <= '0;
+            r_band_line <= '0;
+            r_bands_scanned <= '0;
         end else if (pixel_in_fb) begin
-            r_frame_render_done_sync[0] <= frame_render_done;
-            r_frame_render_done_sync[1] <= r_frame_render_done_sync[0];
+            // Clear on the last of the SCALE x SCALE reads of each pixel. A
+            // reduced resolution frame does not cover the whole buffer, so it
+            // is left to the explicit clear
+            if (CLEAR_ON_SCANOUT != 0 && LINE_BUFFER == 0 && w_front_fb_replaced && w_scan_res_shift == '0 &&
+                x_scale_counter == w_scale_minus_one && y_scale_counter == w_scale_minus_one) begin
+                r_fb_read_clear <= 1'b1;
+                if (r_scanout_clear_start == DISPLAY_LENGTH_WIDTH'(DISPLAY_DEPTH)) begin
+                    r_scanout_clear_start <= DISPLAY_LENGTH_WIDTH'(fb_y * DISPLAY_WIDTH + fb_x);
+                end
+            end else begin
+                r_fb_read_clear <= 1'b0;
+            end
 
-            r_frame_swapped <= 1'b0;
-            if (x_scale_counter < SCALE_MINUS_ONE) begin
+            if (x_scale_counter < w_scale_minus_one) begin
                 x_scale_counter <= x_scale_counter + 1;
             end else begin
                 x_scale_counter <= '0;
 
-                if (fb_x < DISPLAY_WIDTH - 1) begin
+                if (fb_x < w_fb_x_last) begin
                     fb_x <= fb_x + 1;
                 end else begin
                     fb_x <= '0;
 
-                    if (y_scale_counter < SCALE_MINUS_ONE) begin
+                    if (y_scale_counter < w_scale_minus_one) begin
                         y_scale_counter <= y_scale_counter + 1;
                     end else begin
                         y_scale_counter <= '0;
 
-                        if (fb_y < DISPLAY_HEIGHT - 1) begin
+                        if (fb_y < w_fb_y_last) begin
                             fb_y <= fb_y + 1;
+                            r_lb_seq <= r_lb_seq + 1;
+                        end
+
+                        r_band_row <= (r_band_row == DISPLAY_ADDR_WIDTH'(BAND_RING_ROWS - 1)) ? '0 : r_band_row + 1;
+                        if (r_band_line == DISPLAY_ADDR_WIDTH'(BAND_HEIGHT - 1) || fb_y == DISPLAY_HEIGHT - 1) begin
+                            r_band_line <= '0;
+                            r_bands_scanned <= r_bands_scanned + 1;
+                        end else begin
+                            r_band_line <= r_band_line + 1;
                         end
                     end
                 end
             end
 
-            r_fb_addr_read <= fb_y * DISPLAY_WIDTH + fb_x;
-        end else begin
-            r_frame_swapped <= 1'b0;
+            // fb_x and fb_y step at the last of the SCALE reads of a pixel
+            r_fb_read_first <= (x_scale_counter == '0);
 
-            r_frame_render_done_sync[0] <= frame_render_done;
-            r_frame_render_done_sync[1] <= r_frame_render_done_sync[0];
+            if (BAND_HEIGHT != 0) begin
+                r_fb_addr_read <= r_band_row * DISPLAY_WIDTH + fb_x;
+            end else if (LINE_BUFFER != 0) begin
+                r_fb_addr_read <= (r_lb_seq[0] ? DISPLAY_ADDR_WIDTH'(DISPLAY_WIDTH) : '0) + fb_x;
+            end else begin
+                r_fb_addr_read <= fb_y * DISPLAY_WIDTH + fb_x;
+            end
+        end else begin
+            r_fb_read_clear <= 1'b0;
+            r_fb_read_first <= 1'b0;
         end
+
+        r_bands_scanned_gray <= r_bands_scanned ^ (r_bands_scanned >> 1);
+        r_lb_seq_gray <= r_lb_seq ^ (r_lb_seq >> 1);
     end
 
     always_comb begin
-        new_frame_render_ready = w_display_buffers_ready;
+        new_frame_render_ready = w_display_buffers_ready && ~r_bg_restoring && ~r_bg_restore_write_en &&
+                                 w_pk_ready && ~r_pk_resolving && ~r_pk_resolve_write_en &&
+                                 (~r_bg_capture || w_bg_ready);
 
         if (pixel_in_fb && de) begin
             {o_red, o_green, o_blue} = clut_data;
@@ -0,0 +1,354 @@
+#include <stdlib.h>
+#include <stdint.h>
+#include <cstdlib>
+#include <verilated.h>
+#include <verilated_vcd_c.h>
+#include "obj_dir/Vdisplay_new.h"
+
+// Scans out rendered frames and compares the pixels on the VGA output with a
+// model of the render target, for the mode selected in the makefile:
+//  - BACKGROUND_LAYER: frame 1 captures its static pixels, frame 2 starts
+//    from them, frame 3 invalidates the background and starts from a clear.
+//  - PACKED_DEPTH: pixels are depth tested, and the resolve clears the render
+//    target for the next frame.
+//  - FB_PIXELS_PER_WORD > 1: single pixel writes and masked word writes into
+//    wide words, and a scanout that reads each word once.
+//  - LINE_BUFFER: the rows are replayed from the line buffer.
+
+#ifndef DISPLAY_WIDTH
+#define DISPLAY_WIDTH 32
+#endif
+#ifndef DISPLAY_HEIGHT
+#define DISPLAY_HEIGHT 24
+#endif
+#ifndef SCALE
+#define SCALE 4
+#endif
+#ifndef BACKGROUND_LAYER
+#define BACKGROUND_LAYER 0
+#endif
+#ifndef PACKED_DEPTH
+#define PACKED_DEPTH 0
+#endif
+#ifndef FB_PIXELS_PER_WORD
+#define FB_PIXELS_PER_WORD 1
+#endif
+#ifndef LINE_BUFFER
+#define LINE_BUFFER 0
+#endif
+
+#define DISPLAY_DEPTH (DISPLAY_WIDTH * DISPLAY_HEIGHT)
+#define FB_DATA_WIDTH 4
+#define DB_DATA_WIDTH 12
+#define FB_CLEAR_VALUE 0
+#define DB_CLEAR_VALUE ((1 << DB_DATA_WIDTH) - 1)
+
+// 640x480 timing, in pixel clocks
+#define LINE_PIXELS 800
+#define FRAME_LINES 525
+#define FRAME_PIXELS (LINE_PIXELS * FRAME_LINES)
+
+// The first pixel of each row still shows the address before it, for this
+// many clocks, as the address, framebuffer and CLUT are each a register
+#define SCAN_LATENCY 3
+
+// palette.mem: red is the colour index, blue marks the scanned out area
+#define PALETTE_RED(c) (c)
+#define PALETTE_GREEN(c) (15 - (c))
+#define PALETTE_BLUE 5
+
+#define NUM_FRAMES 3
+#define WRITES_PER_FRAME (DISPLAY_DEPTH / 2)
+#define RESET_CLKS 8
+#define MAX_TRACE_TIME 200000
+
+vluint64_t sim_time = 0;    // ns, "clk" is 100 MHz and "clk_pixel" 25 MHz
+
+Vdisplay_new* dut;
+VerilatedVcdC* m_trace;
+int errors = 0;
+
+// Render target and background model
+int rt_color[DISPLAY_DEPTH];
+int rt_depth[DISPLAY_DEPTH];
+int bg_color[DISPLAY_DEPTH];
+int bg_depth[DISPLAY_DEPTH];
+bool bg_valid = false;
+bool bg_capture = false;
+
+// Scanout capture, one sample per pixel clock from the start of vsync
+struct Sample {
+    uint8_t r, g, b;
+};
+Sample capture[FRAME_PIXELS];
+bool capture_requested = false;
+bool capture_done = false;
+int capture_count = 0;
+int last_vsync = 1;
+
+void sample_scanout() {
+    bool vsync_start = last_vsync && !dut->vsync;
+    last_vsync = dut->vsync;
+
+    if (capture_requested && capture_count == 0 && !vsync_start) {
+        return;
+    }
+    if (capture_requested && capture_count < FRAME_PIXELS) {
+        capture[capture_count++] = {dut->o_red, dut->o_green, dut->o_blue};
+        if (capture_count == FRAME_PIXELS) {
+            capture_requested = false;
+            capture_done = true;
+        }
+    }
+}
+
+// 5 ns
+void step() {
+    sim_time += 5;
+    dut->clk ^= 1;
+    bool pixel_edge = (sim_time % 20) == 0;
+    if (pixel_edge) {
+        dut->clk_pixel ^= 1;
+    }
+    dut->eval();
+
+    if (pixel_edge && dut->clk_pixel) {
+        sample_scanout();
+    }
+    if (sim_time < MAX_TRACE_TIME) {
+        m_trace->dump(sim_time);
+    }
+}
+
+// One "clk" cycle, the inputs are taken at the rising edge
+void tick() {
+    step();
+    step();
+}
+
+void wait_ready() {
+    tick();
+    while (!dut->new_frame_render_ready) {
+        tick();
+    }
+}
+
+void clear_frame(bool capture_bg, bool invalidate_bg) {
+    bool restore = BACKGROUND_LAYER && bg_valid && !capture_bg && !invalidate_bg;
+
+    for (int i = 0; i < DISPLAY_DEPTH; i++) {
+        rt_color[i] = restore ? bg_color[i] : FB_CLEAR_VALUE;
+        rt_depth[i] = restore ? bg_depth[i] : DB_CLEAR_VALUE;
+    }
+    if (invalidate_bg) {
+        bg_valid = false;
+        bg_capture = false;
+    } else if (capture_bg) {
+        bg_valid = false;
+        bg_capture = true;
+        for (int i = 0; i < DISPLAY_DEPTH; i++) {
+            bg_color[i] = FB_CLEAR_VALUE;
+            bg_depth[i] = DB_CLEAR_VALUE;
+        }
+    }
+
+    dut->background_capture = capture_bg;
+    dut->background_invalidate = invalidate_bg;
+    dut->frame_clear = 1;
+    tick();
+    dut->frame_clear = 0;
+    dut->background_capture = 0;
+    dut->background_invalidate = 0;
+    wait_ready();
+}
+
+// A word write of random pixels of the word holding addr, colour only
+void write_word(int addr) {
+    int first = addr & ~(FB_PIXELS_PER_WORD - 1);
+    int mask = rand() % (1 << FB_PIXELS_PER_WORD);
+    uint64_t data = 0;
+    for (int p = 0; p < FB_PIXELS_PER_WORD; p++) {
+        int color = rand() % (1 << FB_DATA_WIDTH);
+        data |= (uint64_t)color << (p * FB_DATA_WIDTH);
+        if ((mask & (1 << p)) && first + p < DISPLAY_DEPTH) {
+            rt_color[first + p] = color;
+        }
+    }
+
+    dut->i_word_write_addr = addr;
+    dut->i_word_write_mask = mask;
+    dut->i_word_fb_data = data;
+    dut->i_word_write_valid = 1;
+    tick();
+    dut->i_word_write_valid = 0;
+}
+
+// Random pixels, some back to back on the same address
+void render_frame() {
+    int addr = 0;
+    for (int i = 0; i < WRITES_PER_FRAME; i++) {
+        if (rand() % 4 != 0) {
+            addr = rand() % DISPLAY_DEPTH;
+        }
+        if (FB_PIXELS_PER_WORD > 1 && !PACKED_DEPTH && rand() % 4 == 0) {
+            write_word(addr);
+            continue;
+        }
+        int color = rand() % (1 << FB_DATA_WIDTH);
+        int depth = rand() % (1 << DB_DATA_WIDTH);
+        bool is_static = BACKGROUND_LAYER && (rand() % 2);
+
+        dut->i_pixel_write_addr = addr;
+        dut->i_fb_data = color;
+        dut->i_db_data = depth;
+        dut->i_pixel_write_static = is_static;
+        dut->i_pixel_write_valid = 1;
+        tick();
+        dut->i_pixel_write_valid = 0;
+
+        if (!PACKED_DEPTH || depth < rt_depth[addr]) {
+            rt_color[addr] = color;
+            rt_depth[addr] = depth;
+        }
+        if (bg_capture && is_static) {
+            bg_color[addr] = color;
+            bg_depth[addr] = depth;
+        }
+
+        // Gaps between some pixels
+        while (rand() % 3 == 0) {
+            tick();
+        }
+    }
+}
+
+void finish_frame() {
+    dut->frame_render_done = 1;
+    while (!dut->frame_swapped) {
+        tick();
+    }
+    tick();
+    dut->frame_render_done = 0;
+
+    if (bg_capture) {
+        bg_valid = true;
+        bg_capture = false;
+    }
+}
+
+void check_scanout(int frame) {
+    capture_done = false;
+    capture_count = 0;
+    capture_requested = true;
+    while (!capture_done) {
+        tick();
+    }
+
+    // The scanned out area is where the palette blue is set
+    int first = -1;
+    for (int i = 0; i < FRAME_PIXELS; i++) {
+        if (capture[i].b == PALETTE_BLUE) {
+            first = i;
+            break;
+        }
+    }
+    if (first < 0) {
+        printf("Error: frame %d: nothing scanned out\n", frame);
+        errors++;
+        return;
+    }
+    int line0 = first / LINE_PIXELS;
+    int col0 = first % LINE_PIXELS;
+
+    int frame_errors = 0;
+    for (int y = 0; y < DISPLAY_HEIGHT * SCALE; y++) {
+        for (int x = 0; x < DISPLAY_WIDTH * SCALE + 1; x++) {
+            Sample s = capture[(line0 + y) * LINE_PIXELS + col0 + x];
+
+            if (x == DISPLAY_WIDTH * SCALE) {
+                // Right of the scanned out area
+                if (s.b == PALETTE_BLUE) {
+                    frame_errors++;
+                }
+                continue;
+            }
+            if (s.b != PALETTE_BLUE) {
+                frame_errors++;
+                continue;
+            }
+            if (x < SCAN_LATENCY) {
+                continue;
+            }
+
+            int fb_x = (x - SCAN_LATENCY) / SCALE;
+            int fb_y = y / SCALE;
+            int color = rt_color[fb_y * DISPLAY_WIDTH + fb_x];
+            if (s.r != PALETTE_RED(color) || s.g != PALETTE_GREEN(color)) {
+                if (frame_errors < 10) {
+                    printf("Error: frame %d: pixel (%d, %d): expected colour %d, got %d\n",
+                           frame, fb_x, fb_y, color, s.r);
+                }
+                frame_errors++;
+            }
+        }
+    }
+    // Below the scanned out area
+    for (int x = 0; x < DISPLAY_WIDTH * SCALE; x++) {
+        if (capture[(line0 + DISPLAY_HEIGHT * SCALE) * LINE_PIXELS + col0 + x].b == PALETTE_BLUE) {
+            frame_errors++;
+        }
+    }
+
+    if (frame_errors) {
+        printf("Error: frame %d: %d pixels wrong\n", frame, frame_errors);
+    }
+    errors += frame_errors;
+}
+
+int main(int argc, char** argv) {
+    srand(time(NULL));
+    Verilated::commandArgs(argc, argv);
+
+    dut = new Vdisplay_new;
+
+    Verilated::traceEverOn(true);
+    m_trace = new VerilatedVcdC;
+    dut->trace(m_trace, 5);
+    m_trace->open("waveform.vcd");
+
+    dut->clk = 0;
+    dut->clk_pixel = 0;
+    dut->frame_render_done = 0;
+    dut->frame_clear = 0;
+    dut->i_pixel_write_valid = 0;
+    dut->i_pixel_write_static = 0;
+    dut->i_word_write_valid = 0;
+    dut->i_word_write_mask = 0;
+    dut->background_capture = 0;
+    dut->background_invalidate = 0;
+    dut->res_shift = 0;
+
+    dut->rstn = 0;
+    dut->rst_pix = 1;
+    for (int i = 0; i < RESET_CLKS * 4; i++) {
+        tick();
+    }
+    dut->rstn = 1;
+    dut->rst_pix = 0;
+
+    for (int frame = 0; frame < NUM_FRAMES; frame++) {
+        clear_frame(BACKGROUND_LAYER && frame == 0, BACKGROUND_LAYER && frame == 2);
+        render_frame();
+        finish_frame();
+        check_scanout(frame);
+    }
+
+    m_trace->close();
+    printf("BACKGROUND_LAYER=%d PACKED_DEPTH=%d FB_PIXELS_PER_WORD=%d LINE_BUFFER=%d\n",
+           BACKGROUND_LAYER, PACKED_DEPTH, FB_PIXELS_PER_WORD, LINE_BUFFER);
+    printf("%s: %d errors\n", errors ? "FAILED" : "PASSED", errors);
+
+    delete dut;
+
+    exit(errors ? EXIT_FAILURE : EXIT_SUCCESS);
+}
@@ -1,17 +1,67 @@
 `timescale 1ns / 1ps
 
-typedef enum logic [2:0] {
+typedef enum logic [4:0] {
     MCU_FPGA_COM_IDLE,
+    MCU_FPGA_COM_COMMAND,
     MCU_FPGA_COM_NUM_OBJECTS,
     MCU_FPGA_COM_OBJECTS,
     MCU_FPGA_COM_OBJECT_ID,
     MCU_FPGA_COM_OBJECT_MATRIX,
+    MCU_FPGA_COM_OBJECT_POSE,
     MCU_FPGA_COM_OBJECT_DONE,
+    MCU_FPGA_COM_PERF_COUNTERS,
+    MCU_FPGA_COM_OCCLUSION_COUNTERS,
+    MCU_FPGA_COM_NUM_OBJECTS_16,
+    MCU_FPGA_COM_DELTA_NUM_UPDATES,
+    MCU_FPGA_COM_DELTA_UPDATE_INDEX,
+    MCU_FPGA_COM_DELTA_CRC,
+    MCU_FPGA_COM_DELTA_COMMIT,
+    MCU_FPGA_COM_DELTA_REPLAY,
+    MCU_FPGA_COM_VIEW_PROJECTION_DONE,
     MCU_FPGA_COM_DONE
 } mcu_fpga_com_state_t;
 
+// Every transaction starts with a command byte from the MCU:
+//  - CMD_FRAME: num objects, then per object an id/flags byte followed by the
+//    16 matrix values, each I_MATRIX_DATAWIDTH bits sent MSB first.
+//  - CMD_READ_PERF_COUNTERS: the performance counters are sent on MISO,
+//    counter 0 first and each counter MSB first, starting with the third
+//    byte on MISO. Reading continues for as long as CSn is held low.
+//  - CMD_FRAME_DELTA: only the objects that changed since the last frame are
+//    sent, in one burst. All fields are MSB first:
+//      num objects (16 bit), num updates (16 bit),
+//      per update: object index (16 bit), id/flags byte, 16 matrix values,
+//      CRC-16/CCITT (poly 0x1021, init 0xFFFF) over all bytes before it,
+//      starting with the command byte.
+//    The updates are written to an object table once the CRC has been
+//    checked, and every object in the table is then output, with
+//    o_object_dirty set for the ones that were updated. Packets with a bad
+//    CRC, or that do not fit, are dropped and counted.
+//  - CMD_VIEW_PROJECTION: the 16 values of the view-projection matrix shared
+//    by all objects, sent like an object matrix.
+//  - CMD_FRAME_POSE: num objects (16 bit), then per object an id/flags byte
+//    followed by the pose: position x, y, z (I_MATRIX_DATAWIDTH bits each),
+//    then yaw, pitch and roll (16 bit each, a full turn is 1 << 16, the top
+//    ANGLE_WIDTH bits are used), all MSB first. The MVP matrix is built from the pose by pose_mvp.
+//  - CMD_READ_OCCLUSION_COUNTERS: the visible pixel counts of the last frame
+//    are sent like the performance counters, object 0 first.
+//
+// The second byte on MISO of every transaction is the number of dropped
+// delta packets (mod 256), such that the MCU can send all objects again if
+// a packet was dropped.
 module mcu_fpga_com #(
-    parameter unsigned I_MATRIX_DATAWIDTH = 24
+    parameter unsigned I_MATRIX_DATAWIDTH = 24,
+
+    parameter unsigned MAX_NUM_OBJECTS = 1024,
+    parameter unsigned MAX_UPDATES_PER_PACKET = 64,
+
+    parameter unsigned ANGLE_WIDTH = 16,   // At most 16
+
+    parameter unsigned PERF_NUM_COUNTERS = 16,
+    parameter unsigned PERF_COUNTER_WIDTH = 32,
+    parameter unsigned OCCLUSION_COUNTER_WIDTH = 16,   // Whole bytes, a power of two of them
+
+    parameter unsigned OBJECT_INDEX_WIDTH = $clog2(MAX_NUM_OBJECTS)
     ) (
     input logic clk,
     input logic rstn,
@@ -24,34 +74,110 @@ module mcu_fpga_com #(
     input logic i_new_frame,
     output logic o_mcu_ready,
 
-    output logic [7:0] o_num_objects,
+    output logic [OBJECT_INDEX_WIDTH:0] o_num_objects,
     output logic o_num_objects_dv,
 
+    output logic [OBJECT_INDEX_WIDTH-1:0] o_object_index,
     output logic [3:0] o_object_id,
     output logic [3:0] o_object_flags,
     output logic [I_MATRIX_DATAWIDTH-1:0] o_object_matrix[4][4],
+    output logic o_object_dirty,    // Changed since the last frame
     output logic o_object_dv,
 
+    output logic [I_MATRIX_DATAWIDTH-1:0] o_object_position[3],
+    output logic [ANGLE_WIDTH-1:0] o_object_yaw,
+    output logic [ANGLE_WIDTH-1:0] o_object_pitch,
+    output logic [ANGLE_WIDTH-1:0] o_object_roll,
+    output logic o_object_pose_dv,  // Instead of o_object_dv for CMD_FRAME_POSE
+
+    output logic [I_MATRIX_DATAWIDTH-1:0] o_view_projection[4][4],
+    output logic o_view_projection_dv,
+
+    output logic o_packet_dropped,
+
+    // Performance counter read port, data is expected the cycle after addr
+    output logic [$clog2(PERF_NUM_COUNTERS)-1:0] o_perf_counter_addr,
+    input logic [PERF_COUNTER_WIDTH-1:0] i_perf_counter_data,
+
+    // Occlusion counter read port, data is expected the cycle after addr
+    output logic [OBJECT_INDEX_WIDTH-1:0] o_occlusion_counter_addr,
+    input logic [OCCLUSION_COUNTER_WIDTH-1:0] i_occlusion_counter_data,
+
     input logic SCK,
     input logic MOSI,
     output logic MISO,
     input logic CSn
     );
 
+    localparam logic [7:0] CMD_FRAME = 8'h01;
+    localparam logic [7:0] CMD_READ_PERF_COUNTERS = 8'h02;
+    localparam logic [7:0] CMD_FRAME_DELTA = 8'h03;
+    localparam logic [7:0] CMD_VIEW_PROJECTION = 8'h04;
+    localparam logic [7:0] CMD_FRAME_POSE = 8'h05;
+    localparam logic [7:0] CMD_READ_OCCLUSION_COUNTERS = 8'h06;
+
     localparam int unsigned MATRIX_NUM_VALUES = 16;
+    localparam int unsigned MATRIX_VALUE_BYTES = (I_MATRIX_DATAWIDTH + 7) / 8;
+    localparam int unsigned MATRIX_VALUE_PREFIX_WIDTH = (MATRIX_VALUE_BYTES - 1) * 8;
+    localparam int unsigned POSE_BYTES = 3 * MATRIX_VALUE_BYTES + 3 * 2;
+    localparam int unsigned POSE_WIDTH = POSE_BYTES * 8;
+    localparam int unsigned PERF_COUNTER_BYTES = (PERF_COUNTER_WIDTH + 7) / 8;
+    localparam int unsigned PERF_BYTE_INDEX_WIDTH = $clog2(PERF_COUNTER_BYTES);
+    localparam int unsigned PERF_ADDR_WIDTH = $clog2(PERF_NUM_COUNTERS);
+    localparam int unsigned OCCLUSION_COUNTER_BYTES = OCCLUSION_COUNTER_WIDTH / 8;
+    localparam int unsigned OCCLUSION_BYTE_INDEX_WIDTH = $clog2(OCCLUSION_COUNTER_BYTES);
+
+    // Object table entry: {id, flags, matrix[0][0], matrix[0][1], ..., matrix[3][3]}
+    localparam int unsigned OBJECT_MATRIX_WIDTH = MATRIX_NUM_VALUES * I_MATRIX_DATAWIDTH;
+    localparam int unsigned OBJECT_ENTRY_WIDTH = 8 + OBJECT_MATRIX_WIDTH;
+    localparam int unsigned STAGING_ENTRY_WIDTH = OBJECT_INDEX_WIDTH + OBJECT_ENTRY_WIDTH;
+    localparam int unsigned STAGING_ADDR_WIDTH = $clog2(MAX_UPDATES_PER_PACKET);
+
+    function automatic logic [15:0] crc16_update(input logic [15:0] crc, input logic [7:0] data);
+        logic [15:0] c;
+        c = crc ^ {data, 8'h00};
+        for (int i = 0; i < 8; i++) begin
+            c = c[15] ? ({c[14:0], 1'b0} ^ 16'h1021) : {c[14:0], 1'b0};
+        end
+        return c;
+    endfunction
 
     // Register data
-    logic [7:0] r_num_objects;
+    logic [15:0] r_num_objects;
+    logic [15:0] r_num_updates;
+    logic [OBJECT_INDEX_WIDTH-1:0] r_update_index;
+    logic [MATRIX_VALUE_PREFIX_WIDTH-1:0] r_matrix_value; // All but the last byte of a value
+    logic [7:0] r_field;        // First byte of a 16 bit field
+    logic r_field_byte;         // Second byte of a 16 bit field is next
+    logic r_delta;              // Current packet is CMD_FRAME_DELTA
+    logic r_pose;               // Current packet is CMD_FRAME_POSE
+    logic r_view_projection;    // Current packet is CMD_VIEW_PROJECTION
+    logic [POSE_WIDTH-1:0] r_pose_data;
+    logic r_packet_invalid;     // Current delta packet does not fit
+    logic [15:0] r_crc;
+    logic [7:0] r_dropped_packets_cnt;
+
+    logic [3:0] r_object_id;
+    logic [3:0] r_object_flags;
+    logic [I_MATRIX_DATAWIDTH-1:0] r_object_matrix[4][4];
 
     // Counters
-    logic [3:0] r_object_cnt = '0;
+    logic [15:0] r_object_cnt = '0;
     logic [$clog2(MATRIX_NUM_VALUES)-1:0] r_matrix_data_counter = '0;
-    logic [$clog2(I_MATRIX_DATAWIDTH)-1:0] r_matrix_data_byte_counter = '0;
+    logic [$clog2(MATRIX_VALUE_BYTES+1)-1:0] r_matrix_data_byte_counter = '0;
+    logic [$clog2(POSE_BYTES)-1:0] r_pose_byte_counter = '0;
+    logic [PERF_ADDR_WIDTH+PERF_BYTE_INDEX_WIDTH-1:0] r_perf_byte_counter = '0;
+    logic [OBJECT_INDEX_WIDTH+OCCLUSION_BYTE_INDEX_WIDTH-1:0] r_occlusion_byte_counter = '0;
+    logic [15:0] r_table_cnt = '0;
 
     // SPI Slave
     logic [7:0] w_RX_Byte;
     logic w_RX_DV;
 
+    logic [7:0] w_TX_Byte;
+    logic w_TX_DV;
+    logic w_TX_Ready;
+
     spi_slave spi_slave_inst (
         .clk(clk),
         .rstn(rstn),
@@ -59,12 +185,89 @@ module mcu_fpga_com #(
         .o_RX_Byte(w_RX_Byte),
         .o_RX_DV(w_RX_DV),
 
+        .i_TX_DV(w_TX_DV),
+        .i_TX_Byte(w_TX_Byte),
+        .o_TX_Ready(w_TX_Ready),
+
         .SCK(SCK),
         .MISO(MISO),
         .MOSI(MOSI),
         .CSn(CSn)
     );
 
+    // Synchronize CSn, a transaction starts on the falling edge
+    logic [2:0] r_CSn_sync = '1;
+    always_ff @(posedge clk) begin
+        r_CSn_sync <= {r_CSn_sync[1:0], CSn};
+    end
+
+    logic w_CSn_start;
+    logic w_CSn_high;
+    assign w_CSn_start = r_CSn_sync[2] && ~r_CSn_sync[1];
+    assign w_CSn_high = r_CSn_sync[1];
+
+    logic w_matrix_value_last_byte;
+    assign w_matrix_value_last_byte = (r_matrix_data_byte_counter == MATRIX_VALUE_BYTES - 1);
+
+    logic [15:0] w_field;
+    logic w_field_dv;
+    logic w_field_state;
+    assign w_field = {r_field, w_RX_Byte};
+    assign w_field_dv = w_RX_DV && r_field_byte;
+
+    logic [15:0] w_crc_next;
+    assign w_crc_next = crc16_update(r_crc, w_RX_Byte);
+
+    // Received object, packed for the object table
+    logic [OBJECT_ENTRY_WIDTH-1:0] w_object_entry;
+    always_comb begin
+        w_object_entry[OBJECT_ENTRY_WIDTH-1 -: 8] = {r_object_id, r_object_flags};
+        foreach (r_object_matrix[i,j]) begin
+            w_object_entry[(MATRIX_NUM_VALUES - 1 - (i * 4 + j)) * I_MATRIX_DATAWIDTH +: I_MATRIX_DATAWIDTH] = r_object_matrix[i][j];
+        end
+    end
+
+    // Updates of the current delta packet, written to the object table when
+    // the CRC is correct
+    logic w_staging_write_en;
+    logic [STAGING_ENTRY_WIDTH-1:0] w_staging_data_out;
+
+    bram_dp #(
+        .WIDTH(STAGING_ENTRY_WIDTH),
+        .DEPTH(MAX_UPDATES_PER_PACKET)
+    ) staging_inst (
+        .clk_write(clk),
+        .clk_read(clk),
+        .write_enable(w_staging_write_en),
+        .addr_write(r_object_cnt[STAGING_ADDR_WIDTH-1:0]),
+        .addr_read(r_table_cnt[STAGING_ADDR_WIDTH-1:0]),
+        .data_in({r_update_index, w_object_entry}),
+        .data_out(w_staging_data_out)
+    );
+
+    // Object table
+    logic w_table_write_en;
+    logic [OBJECT_INDEX_WIDTH-1:0] w_table_addr_write;
+    logic [OBJECT_ENTRY_WIDTH-1:0] w_table_data_out;
+    logic r_table_read_dv = 1'b0;
+    logic [OBJECT_INDEX_WIDTH-1:0] r_table_read_index;
+    logic [MAX_NUM_OBJECTS-1:0] r_object_dirty;
+
+    assign w_table_addr_write = w_staging_data_out[STAGING_ENTRY_WIDTH-1 -: OBJECT_INDEX_WIDTH];
+
+    bram_dp #(
+        .WIDTH(OBJECT_ENTRY_WIDTH),
+        .DEPTH(MAX_NUM_OBJECTS)
+    ) object_table_inst (
+        .clk_write(clk),
+        .clk_read(clk),
+        .write_enable(w_table_write_en),
+        .addr_write(w_table_addr_write),
+        .addr_read(r_table_cnt[OBJECT_INDEX_WIDTH-1:0]),
+        .data_in(w_staging_data_out[OBJECT_ENTRY_WIDTH-1:0]),
+        .data_out(w_table_data_out)
+    );
+
     // State
     mcu_fpga_com_state_t current_state = MCU_FPGA_COM_IDLE, next_state = MCU_FPGA_COM_IDLE;
     always_ff @(posedge clk) begin
@@ -80,9 +283,24 @@ module mcu_fpga_com #(
 
         case (current_state)
             MCU_FPGA_COM_IDLE: begin
-                // Todo: CSn probably should not be input directly into state
-                if (~CSn) begin
-                    next_state = MCU_FPGA_COM_NUM_OBJECTS;
+                if (w_CSn_start) begin
+                    next_state = MCU_FPGA_COM_COMMAND;
+                end
+            end
+
+            MCU_FPGA_COM_COMMAND: begin
+                if (w_RX_DV) begin
+                    case (w_RX_Byte)
+                        CMD_FRAME: next_state = MCU_FPGA_COM_NUM_OBJECTS;
+                        CMD_READ_PERF_COUNTERS: next_state = MCU_FPGA_COM_PERF_COUNTERS;
+                        CMD_READ_OCCLUSION_COUNTERS: next_state = MCU_FPGA_COM_OCCLUSION_COUNTERS;
+                        CMD_FRAME_DELTA: next_state = MCU_FPGA_COM_NUM_OBJECTS_16;
+                        CMD_VIEW_PROJECTION: next_state = MCU_FPGA_COM_OBJECT_MATRIX;
+                        CMD_FRAME_POSE: next_state = MCU_FPGA_COM_NUM_OBJECTS_16;
+                        default: next_state = MCU_FPGA_COM_DONE;
+                    endcase
+                end else if (w_CSn_high) begin
+                    next_state = MCU_FPGA_COM_IDLE;
                 end
             end
 
@@ -93,21 +311,43 @@ module mcu_fpga_com #(
             end
 
             MCU_FPGA_COM_OBJECTS: begin
-                if (r_object_cnt == r_num_objects - 1) begin
-                    next_state = MCU_FPGA_COM_DONE;
+                if (r_delta) begin
+                    if (r_object_cnt == r_num_updates) begin
+                        next_state = MCU_FPGA_COM_DELTA_CRC;
+                    end else begin
+                        next_state = MCU_FPGA_COM_DELTA_UPDATE_INDEX;
+                    end
                 end else begin
-                    next_state = MCU_FPGA_COM_OBJECT_ID;
+                    if (r_object_cnt == r_num_objects) begin
+                        next_state = MCU_FPGA_COM_DONE;
+                    end else begin
+                        next_state = MCU_FPGA_COM_OBJECT_ID;
+                    end
                 end
             end
 
             MCU_FPGA_COM_OBJECT_ID: begin
                 if (w_RX_DV) begin
-                    next_state = MCU_FPGA_COM_OBJECT_MATRIX;
+                    if (r_pose) begin
+                        next_state = MCU_FPGA_COM_OBJECT_POSE;
+                    end else begin
+                        next_state = MCU_FPGA_COM_OBJECT_MATRIX;
+                    end
                 end
             end
 
             MCU_FPGA_COM_OBJECT_MATRIX: begin
-                if (r_matrix_data_counter == MATRIX_NUM_VALUES - 1) begin
+                if (w_RX_DV && w_matrix_value_last_byte && r_matrix_data_counter == MATRIX_NUM_VALUES - 1) begin
+                    if (r_view_projection) begin
+                        next_state = MCU_FPGA_COM_VIEW_PROJECTION_DONE;
+                    end else begin
+                        next_state = MCU_FPGA_COM_OBJECT_DONE;
+                    end
+                end
+            end
+
+            MCU_FPGA_COM_OBJECT_POSE: begin
+                if (w_RX_DV && r_pose_byte_counter == POSE_BYTES - 1) begin
                     next_state = MCU_FPGA_COM_OBJECT_DONE;
                 end
             end
@@ -116,6 +356,60 @@ module mcu_fpga_com #(
                 next_state = MCU_FPGA_COM_OBJECTS;
             end
 
+            MCU_FPGA_COM_PERF_COUNTERS, MCU_FPGA_COM_OCCLUSION_COUNTERS: begin
+                if (w_CSn_high) begin
+                    next_state = MCU_FPGA_COM_DONE;
+                end
+            end
+
+            MCU_FPGA_COM_NUM_OBJECTS_16: begin
+                if (w_field_dv) begin
+                    if (r_pose) begin
+                        next_state = MCU_FPGA_COM_OBJECTS;
+                    end else begin
+                        next_state = MCU_FPGA_COM_DELTA_NUM_UPDATES;
+                    end
+                end
+            end
+
+            MCU_FPGA_COM_DELTA_NUM_UPDATES: begin
+                if (w_field_dv) begin
+                    next_state = MCU_FPGA_COM_OBJECTS;
+                end
+            end
+
+            MCU_FPGA_COM_DELTA_UPDATE_INDEX: begin
+                if (w_field_dv) begin
+                    next_state = MCU_FPGA_COM_OBJECT_ID;
+                end
+            end
+
+            MCU_FPGA_COM_DELTA_CRC: begin
+                if (w_field_dv) begin
+                    if (w_crc_next == '0 && ~r_packet_invalid) begin
+                        next_state = MCU_FPGA_COM_DELTA_COMMIT;
+                    end else begin
+                        next_state = MCU_FPGA_COM_DONE;
+                    end
+                end
+            end
+
+            MCU_FPGA_COM_DELTA_COMMIT: begin
+                if (r_table_cnt == r_num_updates && ~r_table_read_dv) begin
+                    next_state = MCU_FPGA_COM_DELTA_REPLAY;
+                end
+            end
+
+            MCU_FPGA_COM_DELTA_REPLAY: begin
+                if (r_table_cnt == r_num_objects && ~r_table_read_dv) begin
+                    next_state = MCU_FPGA_COM_DONE;
+                end
+            end
+
+            MCU_FPGA_COM_VIEW_PROJECTION_DONE: begin
+                next_state = MCU_FPGA_COM_DONE;
+            end
+
             MCU_FPGA_COM_DONE: begin
                 next_state = MCU_FPGA_COM_IDLE;
             end
@@ -126,42 +420,319 @@ module mcu_fpga_com #(
         endcase
     end
 
+    assign w_field_state = (current_state == MCU_FPGA_COM_NUM_OBJECTS_16) ||
+                           (current_state == MCU_FPGA_COM_DELTA_NUM_UPDATES) ||
+                           (current_state == MCU_FPGA_COM_DELTA_UPDATE_INDEX) ||
+                           (current_state == MCU_FPGA_COM_DELTA_CRC);
+
+    assign w_staging_write_en = (current_state == MCU_FPGA_COM_OBJECT_DONE) && r_delta &&
+                                (r_object_cnt < MAX_UPDATES_PER_PACKET);
+    assign w_table_write_en = (current_state == MCU_FPGA_COM_DELTA_COMMIT) && r_table_read_dv;
+
     // Register results
     always_ff @(posedge clk) begin
         if (~rstn) begin
             r_num_objects <= '0;
+            r_num_updates <= '0;
+            r_update_index <= '0;
+            r_matrix_value <= '0;
+            r_field <= '0;
+            r_field_byte <= 1'b0;
+            r_delta <= 1'b0;
+            r_pose <= 1'b0;
+            r_view_projection <= 1'b0;
+            r_pose_data <= '0;
+            r_packet_invalid <= 1'b0;
+            r_crc <= '0;
+            r_dropped_packets_cnt <= '0;
+
+            r_object_id <= '0;
+            r_object_flags <= '0;
+            foreach (r_object_matrix[i,j]) r_object_matrix[i][j] <= '0;
+
             r_object_cnt <= '0;
             r_matrix_data_counter <= '0;
             r_matrix_data_byte_counter <= '0;
+            r_pose_byte_counter <= '0;
+            r_perf_byte_counter <= '0;
+            r_occlusion_byte_counter <= '0;
+            r_table_cnt <= '0;
+            r_table_read_dv <= 1'b0;
+            r_table_read_index <= '0;
+            r_object_dirty <= '0;
 
             o_num_objects <= '0;
             o_num_objects_dv <= '0;
 
             foreach (o_object_matrix[i,j]) o_object_matrix[i][j] <= '0;
+            o_object_index <= '0;
             o_object_id <= '0;
             o_object_flags <= '0;
+            o_object_dirty <= 1'b0;
             o_object_dv <= 0;
+
+            foreach (o_object_position[i]) o_object_position[i] <= '0;
+            o_object_yaw <= '0;
+            o_object_pitch <= '0;
+            o_object_roll <= '0;
+            o_object_pose_dv <= 1'b0;
+
+            foreach (o_view_projection[i,j]) o_view_projection[i][j] <= '0;
+            o_view_projection_dv <= 1'b0;
+
+            o_packet_dropped <= 1'b0;
         end else begin
+            o_num_objects_dv <= 1'b0;
+            o_object_dv <= 1'b0;
+            o_object_pose_dv <= 1'b0;
+            o_view_projection_dv <= 1'b0;
+            o_packet_dropped <= 1'b0;
+
+            if (w_RX_DV) begin
+                r_field <= w_RX_Byte;
+
+                if (r_delta) begin
+                    r_crc <= w_crc_next;
+                end
+            end
+
+            if (~w_field_state) begin
+                r_field_byte <= 1'b0;
+            end else if (w_RX_DV) begin
+                r_field_byte <= ~r_field_byte;
+            end
+
             case (current_state)
+                MCU_FPGA_COM_COMMAND: begin
+                    r_object_cnt <= '0;
+                    r_perf_byte_counter <= '0;
+                    r_occlusion_byte_counter <= '0;
+                    r_matrix_data_counter <= '0;
+                    r_matrix_data_byte_counter <= '0;
+                    r_packet_invalid <= 1'b0;
+
+                    if (w_RX_DV) begin
+                        r_delta <= (w_RX_Byte == CMD_FRAME_DELTA);
+                        r_pose <= (w_RX_Byte == CMD_FRAME_POSE);
+                        r_view_projection <= (w_RX_Byte == CMD_VIEW_PROJECTION);
+                        r_crc <= crc16_update(16'hFFFF, w_RX_Byte);
+                    end
+                end
+
                 MCU_FPGA_COM_NUM_OBJECTS: begin
                     if (w_RX_DV) begin
-                        r_num_objects <= w_RX_Byte;
+                        r_num_objects <= {8'h00, w_RX_Byte};
+                        o_num_objects <= (OBJECT_INDEX_WIDTH + 1)'(w_RX_Byte);
+                        o_num_objects_dv <= 1'b1;
                     end
                 end
 
                 MCU_FPGA_COM_OBJECT_ID: begin
+                    r_matrix_data_counter <= '0;
+                    r_matrix_data_byte_counter <= '0;
+                    r_pose_byte_counter <= '0;
+
+                    if (w_RX_DV) begin
+                        r_object_id <= w_RX_Byte[7:4];
+                        r_object_flags <= w_RX_Byte[3:0];
+                    end
+                end
+
+                MCU_FPGA_COM_OBJECT_MATRIX: begin
                     if (w_RX_DV) begin
-                        if (r_object_
+                        r_matrix_value <= MATRIX_VALUE_PREFIX_WIDTH'({r_matrix_value, w_RX_Byte});
+
+                        if (w_matrix_value_last_byte) begin
+                            r_object_matrix[r_matrix_data_counter[3:2]][r_matrix_data_counter[1:0]] <=
+                                I_MATRIX_DATAWIDTH'({r_matrix_value, w_RX_Byte});
+                            r_matrix_data_counter <= r_matrix_data_counter + 1;
+                            r_matrix_data_byte_counter <= '0;
+                        end else begin
+                            r_matrix_data_byte_counter <= r_matrix_data_byte_counter + 1;
+                        end
+                    end
+                end
+
+                MCU_FPGA_COM_OBJECT_POSE: begin
+                    if (w_RX_DV) begin
+                        r_pose_data <= POSE_WIDTH'({r_pose_data, w_RX_Byte});
+                        r_pose_byte_counter <= r_pose_byte_counter + 1;
+                    end
+                end
+
+                MCU_FPGA_COM_OBJECT_DONE: begin
+                    r_object_cnt <= r_object_cnt + 1;
+
+                    // Delta updates are written to staging instead
+                    if (r_pose) begin
+                        o_object_index <= OBJECT_INDEX_WIDTH'(r_object_cnt);
+                        o_object_id <= r_object_id;
+                        o_object_flags <= r_object_flags;
+                        foreach (o_object_position[i]) begin
+                            o_object_position[i] <= I_MATRIX_DATAWIDTH'(r_pose_data[POSE_WIDTH - 1 - i * MATRIX_VALUE_BYTES * 8 -: MATRIX_VALUE_BYTES * 8]);
+                        end
+                        o_object_yaw <= r_pose_data[47 -: ANGLE_WIDTH];
+                        o_object_pitch <= r_pose_data[31 -: ANGLE_WIDTH];
+                        o_object_roll <= r_pose_data[15 -: ANGLE_WIDTH];
+                        o_object_dirty <= 1'b1;
+                        o_object_pose_dv <= 1'b1;
+                    end else if (~r_delta) begin
+                        o_object_index <= OBJECT_INDEX_WIDTH'(r_object_cnt);
+                        o_object_id <= r_object_id;
+                        o_object_flags <= r_object_flags;
+                        o_object_matrix <= r_object_matrix;
+                        o_object_dirty <= 1'b1;
+                        o_object_dv <= 1'b1;
+                    end
+                end
+
+                MCU_FPGA_COM_VIEW_PROJECTION_DONE: begin
+                    o_view_projection <= r_object_matrix;
+                    o_view_projection_dv <= 1'b1;
+                end
+
+                MCU_FPGA_COM_PERF_COUNTERS: begin
+                    if (w_TX_Ready) begin
+                        r_perf_byte_counter <= r_perf_byte_counter + 1;
+                    end
+                end
+
+                MCU_FPGA_COM_OCCLUSION_COUNTERS: begin
+                    if (w_TX_Ready) begin
+                        r_occlusion_byte_counter <= r_occlusion_byte_counter + 1;
+                    end
+                end
+
+                MCU_FPGA_COM_NUM_OBJECTS_16: begin
+                    if (w_field_dv) begin
+                        r_num_objects <= w_field;
+                        if (w_field > MAX_NUM_OBJECTS) begin
+                            r_packet_invalid <= 1'b1;
+                        end
+
+                        if (r_pose) begin
+                            o_num_objects <= (OBJECT_INDEX_WIDTH + 1)'(w_field);
+                            o_num_objects_dv <= 1'b1;
+                        end
+                    end
+                end
+
+                MCU_FPGA_COM_DELTA_NUM_UPDATES: begin
+                    if (w_field_dv) begin
+                        r_num_updates <= w_field;
+                        if (w_field > MAX_UPDATES_PER_PACKET) begin
+                            r_packet_invalid <= 1'b1;
+                        end
+                    end
+                end
+
+                MCU_FPGA_COM_DELTA_UPDATE_INDEX: begin
+                    if (w_field_dv) begin
+                        r_update_index <= OBJECT_INDEX_WIDTH'(w_field);
+                        if (w_field >= r_num_objects) begin
+                            r_packet_invalid <= 1'b1;
+                        end
+                    end
+                end
+
+                MCU_FPGA_COM_DELTA_CRC: begin
+                    r_table_cnt <= '0;
+                    r_table_read_dv <= 1'b0;
+
+                    if (w_field_dv) begin
+                        if (w_crc_next == '0 && ~r_packet_invalid) begin
+                            r_object_dirty <= '0;
+
+                            o_num_objects <= (OBJECT_INDEX_WIDTH + 1)'(r_num_objects);
+                            o_num_objects_dv <= 1'b1;
+                        end else begin
+                            r_dropped_packets_cnt <= r_dropped_packets_cnt + 1;
+                            o_packet_dropped <= 1'b1;
+                        end
+                    end
+                end
+
+                // Staging is read one update per cycle and written to the table
+                MCU_FPGA_COM_DELTA_COMMIT: begin
+                    if (r_table_cnt != r_num_updates) begin
+                        r_table_cnt <= r_table_cnt + 1;
+                        r_table_read_dv <= 1'b1;
+                    end else begin
+                        r_table_read_dv <= 1'b0;
+                        if (~r_table_read_dv) begin
+                            r_table_cnt <= '0;
+                        end
+                    end
+
+                    if (w_table_write_en) begin
+                        r_object_dirty[w_table_addr_write] <= 1'b1;
+                    end
+                end
+
+                // Every object in the table is output, one per cycle
+                MCU_FPGA_COM_DELTA_REPLAY: begin
+                    if (r_table_cnt != r_num_objects) begin
+                        r_table_cnt <= r_table_cnt + 1;
+                        r_table_read_dv <= 1'b1;
+                        r_table_read_index <= OBJECT_INDEX_WIDTH'(r_table_cnt);
+                    end else begin
+                        r_table_read_dv <= 1'b0;
+                    end
+
+                    if (r_table_read_dv) begin
+                        o_object_index <= r_table_read_index;
+                        {o_object_id, o_object_flags} <= w_table_data_out[OBJECT_ENTRY_WIDTH-1 -: 8];
+                        foreach (o_object_matrix[i,j]) begin
+                            o_object_matrix[i][j] <= w_table_data_out[(MATRIX_NUM_VALUES - 1 - (i * 4 + j)) * I_MATRIX_DATAWIDTH +: I_MATRIX_DATAWIDTH];
+                        end
+                        o_object_dirty <= r_object_dirty[r_table_read_index];
+                        o_object_dv <= 1'b1;
                     end
                 end
 
                 default: begin
-                    o_object_dv <= 0;
                 end
             endcase
         end
     end
 
+    // Transmit. The byte after the command byte is the dropped packet count,
+    // after that MISO sends 0x00 outside of a counter read. When the TX byte
+    // is captured, the byte after the one being sent is loaded.
+    logic [PERF_BYTE_INDEX_WIDTH-1:0] w_perf_byte_index;
+    assign w_perf_byte_index = r_perf_byte_counter[PERF_BYTE_INDEX_WIDTH-1:0];
+    assign o_perf_counter_addr = r_perf_byte_counter[PERF_ADDR_WIDTH+PERF_BYTE_INDEX_WIDTH-1:PERF_BYTE_INDEX_WIDTH];
+
+    logic [OCCLUSION_BYTE_INDEX_WIDTH-1:0] w_occlusion_byte_index;
+    assign w_occlusion_byte_index = r_occlusion_byte_counter[OCCLUSION_BYTE_INDEX_WIDTH-1:0];
+    assign o_occlusion_counter_addr = r_occlusion_byte_counter[OBJECT_INDEX_WIDTH+OCCLUSION_BYTE_INDEX_WIDTH-1:OCCLUSION_BYTE_INDEX_WIDTH];
+
+    always_comb begin
+        w_TX_DV = 1'b0;
+        w_TX_Byte = '0;
+
+        case (current_state)
+            MCU_FPGA_COM_IDLE: begin
+                w_TX_DV = 1'b1;
+                w_TX_Byte = r_dropped_packets_cnt;
+            end
+
+            MCU_FPGA_COM_PERF_COUNTERS: begin
+                w_TX_DV = w_TX_Ready;
+                w_TX_Byte = i_perf_counter_data[(PERF_COUNTER_BYTES - 1 - int'(w_perf_byte_index)) * 8 +: 8];
+            end
+
+            MCU_FPGA_COM_OCCLUSION_COUNTERS: begin
+                w_TX_DV = w_TX_Ready;
+                w_TX_Byte = i_occlusion_counter_data[(OCCLUSION_COUNTER_BYTES - 1 - int'(w_occlusion_byte_index)) * 8 +: 8];
+            end
+
+            default: begin
+                w_TX_DV = w_TX_Ready;
+            end
+        endcase
+    end
+
     assign o_mcu_ready = i_new_frame && (current_state == MCU_FPGA_COM_IDLE);
 
 endmodule
@@ -1,14 +1,438 @@
+#include <stdlib.h>
 #include <cstdlib>
+#include <vector>
 #include <verilated.h>
 #include <verilated_vcd_c.h>
+#include "obj_dir/Vmcu_fpga_com.h"
 
 #define INPUT_MATRIX_DATAWIDTH 24
+#define MATRIX_VALUE_BYTES ((INPUT_MATRIX_DATAWIDTH + 7) / 8)
+
+#define PERF_NUM_COUNTERS 16
+#define PERF_COUNTER_BYTES 4
+
+#define OCCLUSION_NUM_READ 8
+#define OCCLUSION_COUNTER_BYTES 2
+
+#define CMD_FRAME 0x01
+#define CMD_READ_PERF_COUNTERS 0x02
+#define CMD_FRAME_DELTA 0x03
+#define CMD_VIEW_PROJECTION 0x04
+#define CMD_FRAME_POSE 0x05
+#define CMD_READ_OCCLUSION_COUNTERS 0x06
+
+#define ANGLE_WIDTH 16
+
+#define NUM_OBJECTS 3
+#define NUM_DELTA_OBJECTS 5
 
 #define RESET_CLKS 8
-#define MAX_SIM_TIME 240
+#define SCK_HALF_PERIOD_CLKS 4
 vluint64_t sim_time = 0;
 vluint64_t posedge_cnt = 0;
 
-int main() {
+Vmcu_fpga_com* dut;
+VerilatedVcdC* m_trace;
+
+struct Object {
+    int index;
+    int id;
+    int flags;
+    int matrix[16];
+    int dirty;
+    int position[3];
+    int angles[3];  // yaw, pitch, roll
+};
+
+// Received objects
+int num_objects = -1;
+int packets_dropped = 0;
+std::vector<Object> received;
+std::vector<Object> received_poses;
+int view_projection[16];
+int view_projection_received = 0;
+
+uint32_t perf_counter(int addr) {
+    return 0x01020304 * (addr + 1);
+}
+
+uint32_t occlusion_counter(int addr) {
+    return (0x0102 * (addr + 3)) & 0xFFFF;
+}
+
+void tick() {
+    for (int i = 0; i < 2; i++) {
+        dut->clk ^= 1;
+        dut->eval();
+
+        if (dut->clk == 1) {
+            posedge_cnt++;
+
+            // Record outputs
+            if (dut->o_num_objects_dv) {
+                num_objects = dut->o_num_objects;
+            }
+
+            if (dut->o_object_dv) {
+                Object o;
+                o.index = dut->o_object_index;
+                o.id = dut->o_object_id;
+                o.flags = dut->o_object_flags;
+                o.dirty = dut->o_object_dirty;
+                for (int j = 0; j < 16; j++) {
+                    o.matrix[j] = dut->o_object_matrix[j / 4][j % 4];
+                }
+                received.push_back(o);
+            }
+
+            if (dut->o_object_pose_dv) {
+                Object o;
+                o.index = dut->o_object_index;
+                o.id = dut->o_object_id;
+                o.flags = dut->o_object_flags;
+                o.dirty = dut->o_object_dirty;
+                for (int j = 0; j < 3; j++) {
+                    o.position[j] = dut->o_object_position[j];
+                }
+                o.angles[0] = dut->o_object_yaw;
+                o.angles[1] = dut->o_object_pitch;
+                o.angles[2] = dut->o_object_roll;
+                received_poses.push_back(o);
+            }
+
+            if (dut->o_view_projection_dv) {
+                for (int j = 0; j < 16; j++) {
+                    view_projection[j] = dut->o_view_projection[j / 4][j % 4];
+                }
+                view_projection_received++;
+            }
+
+            if (dut->o_packet_dropped) {
+                packets_dropped++;
+            }
+
+            // Read port has one cycle latency
+            dut->i_perf_counter_data = perf_counter(dut->o_perf_counter_addr);
+            dut->i_occlusion_counter_data = occlusion_counter(dut->o_occlusion_counter_addr);
+        }
+
+        m_trace->dump(sim_time);
+        sim_time++;
+    }
+}
+
+void ticks(int n) {
+    for (int i = 0; i < n; i++) tick();
+}
+
+// Mode 0, MSB first
+uint8_t spi_transfer(uint8_t tx) {
+    uint8_t rx = 0;
+    for (int bit = 7; bit >= 0; bit--) {
+        dut->SCK = 0;
+        dut->MOSI = (tx >> bit) & 1;
+        ticks(SCK_HALF_PERIOD_CLKS);
+
+        dut->SCK = 1;
+        rx = (rx << 1) | dut->MISO;
+        ticks(SCK_HALF_PERIOD_CLKS);
+    }
+    return rx;
+}
+
+void spi_begin() {
+    dut->CSn = 0;
+    ticks(SCK_HALF_PERIOD_CLKS);
+}
+
+void spi_end() {
+    dut->SCK = 0;
+    ticks(SCK_HALF_PERIOD_CLKS);
+    dut->CSn = 1;
+    ticks(4 * SCK_HALF_PERIOD_CLKS);
+}
+
+// Sends a full transaction, returns the bytes received on MISO
+std::vector<uint8_t> spi_transaction(const std::vector<uint8_t>& tx) {
+    std::vector<uint8_t> rx;
+    received.clear();
+    received_poses.clear();
+    num_objects = -1;
+
+    spi_begin();
+    for (uint8_t b : tx) {
+        rx.push_back(spi_transfer(b));
+    }
+    spi_end();
+
+    // Delta packets are replayed from the object table after the transaction
+    ticks(4 * NUM_DELTA_OBJECTS + 16);
+    return rx;
+}
+
+// CRC-16/CCITT, poly 0x1021, init 0xFFFF
+uint16_t crc16(const std::vector<uint8_t>& data) {
+    uint16_t crc = 0xFFFF;
+    for (uint8_t b : data) {
+        crc ^= b << 8;
+        for (int i = 0; i < 8; i++) {
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : (crc << 1);
+        }
+    }
+    return crc;
+}
+
+void push_u16(std::vector<uint8_t>& packet, int value) {
+    packet.push_back((value >> 8) & 0xFF);
+    packet.push_back(value & 0xFF);
+}
+
+Object random_object(int index) {
+    Object o;
+    o.index = index;
+    o.id = rand() % 16;
+    o.flags = rand() % 16;
+    o.dirty = 1;
+    for (int j = 0; j < 16; j++) {
+        o.matrix[j] = rand() % (1 << INPUT_MATRIX_DATAWIDTH);
+    }
+    return o;
+}
+
+void push_value(std::vector<uint8_t>& packet, int value) {
+    for (int b = MATRIX_VALUE_BYTES - 1; b >= 0; b--) {
+        packet.push_back((value >> (8 * b)) & 0xFF);
+    }
+}
+
+void push_object(std::vector<uint8_t>& packet, const Object& o) {
+    packet.push_back((o.id << 4) | o.flags);
+    for (int j = 0; j < 16; j++) {
+        for (int b = MATRIX_VALUE_BYTES - 1; b >= 0; b--) {
+            packet.push_back((o.matrix[j] >> (8 * b)) & 0xFF);
+        }
+    }
+}
+
+std::vector<uint8_t> delta_packet(int n, const std::vector<Object>& updates, bool corrupt) {
+    std::vector<uint8_t> packet;
+    packet.push_back(CMD_FRAME_DELTA);
+    push_u16(packet, n);
+    push_u16(packet, updates.size());
+    for (const Object& o : updates) {
+        push_u16(packet, o.index);
+        push_object(packet, o);
+    }
+    push_u16(packet, crc16(packet) ^ (corrupt ? 1 : 0));
+    return packet;
+}
+
+int check_objects(const char* name, const std::vector<Object>& expected) {
+    int errors = 0;
+
+    if (num_objects != (int)expected.size()) {
+        printf("Error: %s: num objects: expected %d, got %d\n", name, (int)expected.size(), num_objects);
+        errors++;
+    }
+
+    if (received.size() != expected.size()) {
+        printf("Error: %s: objects received: expected %d, got %d\n", name, (int)expected.size(), (int)received.size());
+        return errors + 1;
+    }
+
+    for (size_t i = 0; i < expected.size(); i++) {
+        const Object& e = expected[i];
+        const Object& r = received[i];
+        if (r.index != e.index || r.id != e.id || r.flags != e.flags || r.dirty != e.dirty) {
+            printf("Error: %s: object %d: expected index/id/flags/dirty %d/%d/%d/%d, got %d/%d/%d/%d\n",
+                   name, (int)i, e.index, e.id, e.flags, e.dirty, r.index, r.id, r.flags, r.dirty);
+            errors++;
+        }
+
+        for (int j = 0; j < 16; j++) {
+            if (r.matrix[j] != e.matrix[j]) {
+                printf("Error: %s: object %d, matrix[%d][%d]: expected %06X, got %06X\n",
+                       name, (int)i, j / 4, j % 4, e.matrix[j], r.matrix[j]);
+                errors++;
+            }
+        }
+    }
+
+    return errors;
+}
+
+int main(int argc, char** argv) {
+    srand(time(NULL));
+    Verilated::commandArgs(argc, argv);
+
+    dut = new Vmcu_fpga_com;
+
+    Verilated::traceEverOn(true);
+    m_trace = new VerilatedVcdC;
+    dut->trace(m_trace, 5);
+    m_trace->open("waveform.vcd");
+
+    dut->clk = 0;
+    dut->rstn = 0;
+    dut->i_mode = 0;
+    dut->i_new_frame = 1;
+    dut->SCK = 0;
+    dut->MOSI = 0;
+    dut->CSn = 1;
+
+    ticks(RESET_CLKS);
+    dut->rstn = 1;
+    ticks(RESET_CLKS);
+
+    int errors = 0;
+
+    // Full frame
+    std::vector<Object> frame;
+    std::vector<uint8_t> packet;
+    packet.push_back(CMD_FRAME);
+    packet.push_back(NUM_OBJECTS);
+    for (int i = 0; i < NUM_OBJECTS; i++) {
+        frame.push_back(random_object(i));
+        push_object(packet, frame[i]);
+    }
+    spi_transaction(packet);
+    errors += check_objects("frame", frame);
+
+    // Performance counters, data starts the byte after the dropped packet count
+    packet.assign(2 + PERF_NUM_COUNTERS * PERF_COUNTER_BYTES, 0x00);
+    packet[0] = CMD_READ_PERF_COUNTERS;
+    std::vector<uint8_t> rx = spi_transaction(packet);
+    for (int i = 0; i < PERF_NUM_COUNTERS; i++) {
+        uint32_t value = 0;
+        for (int b = 0; b < PERF_COUNTER_BYTES; b++) {
+            value = (value << 8) | rx[2 + i * PERF_COUNTER_BYTES + b];
+        }
+
+        if (value != perf_counter(i)) {
+            printf("Error: perf counter %d: expected %08X, got %08X\n", i, perf_counter(i), value);
+            errors++;
+        }
+    }
+
+    // Occlusion counters, read like the performance counters
+    packet.assign(2 + OCCLUSION_NUM_READ * OCCLUSION_COUNTER_BYTES, 0x00);
+    packet[0] = CMD_READ_OCCLUSION_COUNTERS;
+    rx = spi_transaction(packet);
+    for (int i = 0; i < OCCLUSION_NUM_READ; i++) {
+        uint32_t value = 0;
+        for (int b = 0; b < OCCLUSION_COUNTER_BYTES; b++) {
+            value = (value << 8) | rx[2 + i * OCCLUSION_COUNTER_BYTES + b];
+        }
+
+        if (value != occlusion_counter(i)) {
+            printf("Error: occlusion counter %d: expected %04X, got %04X\n", i, occlusion_counter(i), value);
+            errors++;
+        }
+    }
+
+    // Delta: all objects, then only some, then a corrupt packet, then none
+    std::vector<Object> table;
+    for (int i = 0; i < NUM_DELTA_OBJECTS; i++) {
+        table.push_back(random_object(i));
+    }
+    spi_transaction(delta_packet(NUM_DELTA_OBJECTS, table, false));
+    errors += check_objects("delta all", table);
+
+    std::vector<Object> updates;
+    for (Object& o : table) {
+        o.dirty = (o.index % 2 == 0);
+        if (o.dirty) {
+            o = random_object(o.index);
+            updates.push_back(o);
+        }
+    }
+    spi_transaction(delta_packet(NUM_DELTA_OBJECTS, updates, false));
+    errors += check_objects("delta some", table);
+
+    updates.clear();
+    updates.push_back(random_object(1));
+    spi_transaction(delta_packet(NUM_DELTA_OBJECTS, updates, true));
+    if (!received.empty() || packets_dropped != 1) {
+        printf("Error: corrupt packet: got %d objects, %d dropped\n", (int)received.size(), packets_dropped);
+        errors++;
+    }
+
+    updates.clear();
+    for (Object& o : table) {
+        o.dirty = 0;
+    }
+    rx = spi_transaction(delta_packet(NUM_DELTA_OBJECTS, updates, false));
+    errors += check_objects("delta none", table);
+
+    if (rx[1] != packets_dropped) {
+        printf("Error: dropped packet count: expected %d, got %d\n", packets_dropped, rx[1]);
+        errors++;
+    }
+
+    // View-projection matrix
+    int expected_view_projection[16];
+    packet.clear();
+    packet.push_back(CMD_VIEW_PROJECTION);
+    for (int j = 0; j < 16; j++) {
+        expected_view_projection[j] = rand() % (1 << INPUT_MATRIX_DATAWIDTH);
+        push_value(packet, expected_view_projection[j]);
+    }
+    spi_transaction(packet);
+    if (view_projection_received != 1) {
+        printf("Error: view projection received %d times\n", view_projection_received);
+        errors++;
+    }
+    for (int j = 0; j < 16; j++) {
+        if (view_projection[j] != expected_view_projection[j]) {
+            printf("Error: view projection[%d][%d]: expected %06X, got %06X\n",
+                   j / 4, j % 4, expected_view_projection[j], view_projection[j]);
+            errors++;
+        }
+    }
+
+    // Poses
+    std::vector<Object> poses;
+    packet.clear();
+    packet.push_back(CMD_FRAME_POSE);
+    push_u16(packet, NUM_OBJECTS);
+    for (int i = 0; i < NUM_OBJECTS; i++) {
+        Object o = random_object(i);
+        packet.push_back((o.id << 4) | o.flags);
+        for (int j = 0; j < 3; j++) {
+            o.position[j] = rand() % (1 << INPUT_MATRIX_DATAWIDTH);
+            push_value(packet, o.position[j]);
+        }
+        for (int j = 0; j < 3; j++) {
+            o.angles[j] = rand() % (1 << ANGLE_WIDTH);
+            push_u16(packet, o.angles[j]);
+        }
+        poses.push_back(o);
+    }
+    spi_transaction(packet);
+
+    if (num_objects != NUM_OBJECTS || received_poses.size() != poses.size() || !received.empty()) {
+        printf("Error: poses: num objects %d, %d poses, %d objects\n",
+               num_objects, (int)received_poses.size(), (int)received.size());
+        errors++;
+    } else {
+        for (size_t i = 0; i < poses.size(); i++) {
+            const Object& e = poses[i];
+            const Object& r = received_poses[i];
+            bool match = r.index == e.index && r.id == e.id && r.flags == e.flags;
+            for (int j = 0; j < 3; j++) {
+                match &= r.position[j] == e.position[j] && r.angles[j] == e.angles[j];
+            }
+            if (!match) {
+                printf("Error: pose %d does not match\n", (int)i);
+                errors++;
+            }
+        }
+    }
+
+    m_trace->close();
+    printf("%s: %d errors\n", errors ? "FAILED" : "PASSED", errors);
+
+    delete dut;
 
+    exit(errors ? EXIT_FAILURE : EXIT_SUCCESS);
 }
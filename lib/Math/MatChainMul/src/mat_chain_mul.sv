@@ -0,0 +1,228 @@
+// Pipelined 4x4 matrix multiplier for chains of products, C = L * R
+// The left operand L is held, and the right operands R are streamed through,
+// e.g. L = projection * view and R = the model matrix of each object.
+// One row of C is computed per cycle, so a new product can be issued every
+// 4 cycles. Results are buffered in a FIFO.
+
+`timescale 1ns / 1ps
+
+module mat_chain_mul #(
+    parameter unsigned DATAWIDTH = 24,
+    parameter unsigned FRACBITS = 13,
+    parameter unsigned FIFO_DEPTH = 8
+    ) (
+    input logic clk,
+    input logic rstn,
+
+    // Left operand, only load when nothing is in flight
+    input logic signed [DATAWIDTH-1:0] i_left[4][4],
+    input logic i_left_dv,
+
+    // Right operand
+    input logic signed [DATAWIDTH-1:0] i_right[4][4],
+    input logic i_right_dv,
+    input logic i_chain,    // The result replaces the left operand instead of going to the FIFO
+    output logic o_ready,
+
+    // Result FIFO, read with the same handshake as the MVP matrix input of
+    // render_pipeline: i_read_en is held until o_result_dv
+    input logic i_read_en,
+    output logic signed [DATAWIDTH-1:0] o_result[4][4],
+    output logic o_result_dv,
+    output logic o_empty
+    );
+
+    localparam unsigned OutputRangeStart = FRACBITS;
+    localparam unsigned OutputRangeEnd = DATAWIDTH + OutputRangeStart - 1;
+
+    localparam unsigned MATRIX_WIDTH = 16 * DATAWIDTH;
+    localparam unsigned FIFO_CAPACITY = FIFO_DEPTH - 1;     // sync_fifo is full at DEPTH - 1
+    localparam unsigned COUNT_WIDTH = $clog2(FIFO_DEPTH + 1);
+
+    logic signed [DATAWIDTH-1:0] r_left[4][4];
+
+    // Issue, R is held while its 4 rows are issued
+    logic signed [DATAWIDTH-1:0] r_right[4][4];
+    logic [1:0] r_row;
+    logic r_busy;
+    logic r_chain;
+
+    // Stage 1, products
+    logic signed [2*DATAWIDTH-1:0] r_products[4][4];    // [column][k]
+    logic [1:0] r_s1_row;
+    logic r_s1_dv;
+    logic r_s1_chain;
+
+    // Stage 2, sums
+    logic signed [2*DATAWIDTH+1:0] r_sums[4];
+    logic [1:0] r_s2_row;
+    logic r_s2_dv;
+    logic r_s2_chain;
+
+    // Stage 3, result rows
+    logic signed [DATAWIDTH-1:0] r_result[4][4];
+    logic signed [DATAWIDTH-1:0] w_result[4][4];
+
+    // Flow control, products in flight always have room in the FIFO
+    logic [COUNT_WIDTH-1:0] r_fifo_count;
+    logic [COUNT_WIDTH-1:0] r_in_flight;
+    logic r_chain_pending;
+
+    logic w_issue;
+    logic w_done;
+    logic w_fifo_write_en;
+    logic w_fifo_read_en;
+    logic w_fifo_empty;
+    /* verilator lint_off UNUSED */
+    logic w_fifo_full;
+    /* verilator lint_on UNUSED */
+
+    assign o_ready = (~r_busy || r_row == 2'd3) && ~r_chain_pending &&
+                     (r_fifo_count + r_in_flight < FIFO_CAPACITY);
+    assign w_issue = i_right_dv && o_ready;
+    assign w_done = r_s2_dv && r_s2_row == 2'd3;
+    assign w_fifo_write_en = w_done && ~r_s2_chain;
+
+    // Issue
+    always_ff @(posedge clk) begin
+        if (~rstn) begin
+            foreach (r_right[i,j]) r_right[i][j] <= '0;
+            r_row <= '0;
+            r_busy <= 1'b0;
+            r_chain <= 1'b0;
+        end else begin
+            if (w_issue) begin
+                r_right <= i_right;
+                r_chain <= i_chain;
+                r_row <= '0;
+                r_busy <= 1'b1;
+            end else if (r_busy) begin
+                r_row <= r_row + 1;
+                if (r_row == 2'd3) begin
+                    r_busy <= 1'b0;
+                end
+            end
+        end
+    end
+
+    // Stage 1
+    always_ff @(posedge clk) begin
+        if (~rstn) begin
+            foreach (r_products[i,j]) r_products[i][j] <= '0;
+            r_s1_row <= '0;
+            r_s1_dv <= 1'b0;
+            r_s1_chain <= 1'b0;
+        end else begin
+            foreach (r_products[j,k]) r_products[j][k] <= r_left[r_row][k] * r_right[k][j];
+            r_s1_row <= r_row;
+            r_s1_dv <= r_busy;
+            r_s1_chain <= r_chain;
+        end
+    end
+
+    // Stage 2
+    always_ff @(posedge clk) begin
+        if (~rstn) begin
+            foreach (r_sums[i]) r_sums[i] <= '0;
+            r_s2_row <= '0;
+            r_s2_dv <= 1'b0;
+            r_s2_chain <= 1'b0;
+        end else begin
+            foreach (r_sums[j]) begin
+                r_sums[j] <= (2*DATAWIDTH+2)'(r_products[j][0]) + (2*DATAWIDTH+2)'(r_products[j][1]) +
+                             (2*DATAWIDTH+2)'(r_products[j][2]) + (2*DATAWIDTH+2)'(r_products[j][3]);
+            end
+            r_s2_row <= r_s1_row;
+            r_s2_dv <= r_s1_dv;
+            r_s2_chain <= r_s1_chain;
+        end
+    end
+
+    // Stage 3, same truncation as mat_mul
+    always_comb begin
+        w_result = r_result;
+        foreach (r_sums[j]) begin
+            w_result[r_s2_row][j] = {r_sums[j][2*DATAWIDTH-1], r_sums[j][OutputRangeEnd-1:OutputRangeStart]};
+        end
+    end
+
+    always_ff @(posedge clk) begin
+        if (~rstn) begin
+            foreach (r_result[i,j]) r_result[i][j] <= '0;
+            foreach (r_left[i,j]) r_left[i][j] <= '0;
+        end else begin
+            if (r_s2_dv) begin
+                r_result <= w_result;
+            end
+
+            if (i_left_dv) begin
+                r_left <= i_left;
+            end else if (w_done && r_s2_chain) begin
+                r_left <= w_result;
+            end
+        end
+    end
+
+    // Flow control
+    always_ff @(posedge clk) begin
+        if (~rstn) begin
+            r_fifo_count <= '0;
+            r_in_flight <= '0;
+            r_chain_pending <= 1'b0;
+        end else begin
+            r_fifo_count <= r_fifo_count + COUNT_WIDTH'(w_fifo_write_en) - COUNT_WIDTH'(w_fifo_read_en);
+            r_in_flight <= r_in_flight + COUNT_WIDTH'(w_issue) - COUNT_WIDTH'(w_done);
+
+            if (w_issue && i_chain) begin
+                r_chain_pending <= 1'b1;
+            end else if (w_done && r_s2_chain) begin
+                r_chain_pending <= 1'b0;
+            end
+        end
+    end
+
+    // Result FIFO
+    logic [MATRIX_WIDTH-1:0] w_fifo_data_in;
+    logic [MATRIX_WIDTH-1:0] w_fifo_data_out;
+    logic r_read_pending;
+
+    always_comb begin
+        foreach (w_result[i,j]) begin
+            w_fifo_data_in[(15 - (i * 4 + j)) * DATAWIDTH +: DATAWIDTH] = w_result[i][j];
+            o_result[i][j] = w_fifo_data_out[(15 - (i * 4 + j)) * DATAWIDTH +: DATAWIDTH];
+        end
+    end
+
+    // Only one read in flight, as i_read_en is held until o_result_dv
+    assign w_fifo_read_en = i_read_en && ~w_fifo_empty && ~r_read_pending;
+
+    always_ff @(posedge clk) begin
+        if (~rstn) begin
+            r_read_pending <= 1'b0;
+        end else begin
+            r_read_pending <= w_fifo_read_en;
+        end
+    end
+
+    sync_fifo #(
+        .DATAWIDTH(MATRIX_WIDTH),
+        .DEPTH(FIFO_DEPTH)
+    ) result_fifo_inst (
+        .rstn(rstn),
+
+        .write_clk(clk),
+        .read_clk(clk),
+        .read_en(w_fifo_read_en),
+        .write_en(w_fifo_write_en),
+
+        .data_in(w_fifo_data_in),
+        .data_out(w_fifo_data_out),
+        .o_dv(o_result_dv),
+
+        .empty(w_fifo_empty),
+        .full(w_fifo_full)
+    );
+
+    assign o_empty = w_fifo_empty;
+
+endmodule
@@ -0,0 +1,154 @@
+#include <stdlib.h>
+#include <stdint.h>
+#include <cstdlib>
+#include <deque>
+#include <verilated.h>
+#include <verilated_vcd_c.h>
+#include "obj_dir/Vmat_chain_mul.h"
+
+#define DATA_WIDTH 24
+#define FRAC_BITS 13
+
+#define NUM_PRODUCTS 64
+#define RESET_CLKS 8
+#define MAX_SIM_TIME (2 * (RESET_CLKS + NUM_PRODUCTS * 16))
+
+vluint64_t sim_time = 0;
+vluint64_t posedge_cnt = 0;
+
+struct Matrix {
+    int64_t m[4][4];
+};
+
+// Sign extend a DATA_WIDTH value
+int64_t sext(int64_t v) {
+    v &= (1LL << DATA_WIDTH) - 1;
+    return (v & (1LL << (DATA_WIDTH - 1))) ? v - (1LL << DATA_WIDTH) : v;
+}
+
+// Same truncation as mat_mul: sign of the full sum, then the middle bits
+Matrix mat_mul(const Matrix& A, const Matrix& B) {
+    Matrix C;
+    for (int i = 0; i < 4; i++) {
+        for (int j = 0; j < 4; j++) {
+            int64_t sum = 0;
+            for (int k = 0; k < 4; k++) sum += A.m[i][k] * B.m[k][j];
+            int64_t sign = (sum >> (2 * DATA_WIDTH - 1)) & 1;
+            int64_t bits = (sum >> FRAC_BITS) & ((1LL << (DATA_WIDTH - 1)) - 1);
+            C.m[i][j] = sext((sign << (DATA_WIDTH - 1)) | bits);
+        }
+    }
+    return C;
+}
+
+// Values in [-2, 2)
+Matrix random_matrix() {
+    Matrix M;
+    for (int i = 0; i < 4; i++) {
+        for (int j = 0; j < 4; j++) {
+            M.m[i][j] = (rand() % (4 << FRAC_BITS)) - (2 << FRAC_BITS);
+        }
+    }
+    return M;
+}
+
+int main(int argc, char** argv) {
+    srand(time(NULL));
+    Verilated::commandArgs(argc, argv);
+
+    Vmat_chain_mul* dut = new Vmat_chain_mul;
+
+    Verilated::traceEverOn(true);
+    VerilatedVcdC* m_trace = new VerilatedVcdC;
+    dut->trace(m_trace, 5);
+    m_trace->open("waveform.vcd");
+
+    // L = projection * view, computed by chaining
+    Matrix projection = random_matrix();
+    Matrix view = random_matrix();
+    Matrix left = mat_mul(projection, view);
+
+    dut->clk = 0;
+    dut->rstn = 0;
+    dut->i_left_dv = 0;
+    dut->i_right_dv = 0;
+    dut->i_chain = 0;
+    dut->i_read_en = 0;
+
+    std::deque<Matrix> expected;
+    int issued = 0;     // 0: load projection, 1: chain view, then products
+    int checked = 0;
+    int errors = 0;
+
+    while (sim_time < MAX_SIM_TIME && checked < NUM_PRODUCTS) {
+        dut->clk ^= 1;
+        dut->eval();
+
+        if (dut->clk == 1) {
+            posedge_cnt++;
+            dut->rstn = posedge_cnt > RESET_CLKS;
+            dut->i_left_dv = 0;
+            dut->i_right_dv = 0;
+            dut->i_chain = 0;
+
+            if (dut->o_result_dv) {
+                Matrix e = expected.front();
+                expected.pop_front();
+                for (int i = 0; i < 4; i++) {
+                    for (int j = 0; j < 4; j++) {
+                        if (sext(dut->o_result[i][j]) != e.m[i][j]) {
+                            printf("Error: product %d, C[%d][%d]: expected %ld, got %ld\n",
+                                   checked, i, j, e.m[i][j], sext(dut->o_result[i][j]));
+                            errors++;
+                        }
+                    }
+                }
+                checked++;
+                dut->i_read_en = 0;
+            } else if (!dut->o_empty && rand() % 4 == 0) {
+                // Read slower than products are issued, such that the FIFO fills
+                dut->i_read_en = 1;
+            }
+
+            if (dut->rstn) {
+                if (issued == 0) {
+                    for (int i = 0; i < 4; i++) {
+                        for (int j = 0; j < 4; j++) {
+                            dut->i_left[i][j] = projection.m[i][j] & ((1 << DATA_WIDTH) - 1);
+                        }
+                    }
+                    dut->i_left_dv = 1;
+                    issued++;
+                } else if (dut->o_ready && issued < NUM_PRODUCTS + 2) {
+                    Matrix right = (issued == 1) ? view : random_matrix();
+                    for (int i = 0; i < 4; i++) {
+                        for (int j = 0; j < 4; j++) {
+                            dut->i_right[i][j] = right.m[i][j] & ((1 << DATA_WIDTH) - 1);
+                        }
+                    }
+                    dut->i_right_dv = 1;
+                    dut->i_chain = (issued == 1);
+                    if (issued > 1) {
+                        expected.push_back(mat_mul(left, right));
+                    }
+                    issued++;
+                }
+            }
+        }
+
+        m_trace->dump(sim_time);
+        sim_time++;
+    }
+
+    if (checked != NUM_PRODUCTS) {
+        printf("Error: only %d of %d products finished\n", checked, NUM_PRODUCTS);
+        errors++;
+    }
+
+    m_trace->close();
+    printf("%s: %d errors\n", errors ? "FAILED" : "PASSED", errors);
+
+    delete dut;
+
+    exit(errors ? EXIT_FAILURE : EXIT_SUCCESS);
+}
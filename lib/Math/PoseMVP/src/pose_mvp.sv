@@ -0,0 +1,260 @@
+`timescale 1ns / 1ps
+
+// Builds the MVP matrix of an object from its pose:
+//   MVP = VP * T(position) * R_y(yaw) * R_x(pitch) * R_z(roll)
+// A full turn is 1 << ANGLE_WIDTH, the bits below the quarter wave table
+// address are interpolated.
+// The three angles share one dual-issue quarter wave trig LUT, yaw and pitch
+// are looked up together, then roll.
+// With MULTIPLY_VIEW_PROJECTION = 0 only the model matrix T * R is output,
+// for when VP * model is done by mat_chain_mul.
+module pose_mvp #(
+    parameter unsigned DATA_WIDTH = 24,
+    parameter unsigned FRAC_BITS = 13,
+    parameter unsigned ANGLE_WIDTH = 16,
+    parameter unsigned QUARTER_LUT_ADDR_WIDTH = 8,
+    parameter unsigned MULTIPLY_VIEW_PROJECTION = 1
+) (
+    input logic clk,
+    input logic rstn,
+
+    // Shared by all objects, must be held while not ready
+    /* verilator lint_off UNUSED */
+    input logic signed [DATA_WIDTH-1:0] i_view_projection[4][4],
+    /* verilator lint_on UNUSED */
+
+    input logic signed [DATA_WIDTH-1:0] i_position[3],
+    input logic [ANGLE_WIDTH-1:0] i_yaw,
+    input logic [ANGLE_WIDTH-1:0] i_pitch,
+    input logic [ANGLE_WIDTH-1:0] i_roll,
+    input logic i_dv,
+    output logic o_ready,
+
+    // Only valid when o_dv is high
+    output logic signed [DATA_WIDTH-1:0] o_mvp[4][4],
+    output logic o_dv
+);
+
+    localparam int YAW = 0;
+    localparam int PITCH = 1;
+    localparam int ROLL = 2;
+
+    function automatic logic signed [DATA_WIDTH-1:0] fixed_mul(
+        input logic signed [DATA_WIDTH-1:0] a,
+        input logic signed [DATA_WIDTH-1:0] b
+    );
+        logic signed [2*DATA_WIDTH-1:0] p;
+        p = a * b;
+        return p[FRAC_BITS +: DATA_WIDTH];
+    endfunction
+
+    logic signed [DATA_WIDTH-1:0] r_position[3];
+    logic [ANGLE_WIDTH-1:0] r_angle[3];
+    logic [1:0] r_lookup_cnt;
+
+    logic signed [DATA_WIDTH-1:0] r_sin[3];
+    logic signed [DATA_WIDTH-1:0] r_cos[3];
+
+    // Products of two sines/cosines
+    logic signed [DATA_WIDTH-1:0] r_sy_sp, r_cy_sp;
+    logic signed [DATA_WIDTH-1:0] r_sy_cp, r_cy_cp;
+    logic signed [DATA_WIDTH-1:0] r_cp_sr, r_cp_cr;
+    logic signed [DATA_WIDTH-1:0] r_sy_sr, r_sy_cr;
+    logic signed [DATA_WIDTH-1:0] r_cy_sr, r_cy_cr;
+
+    logic signed [DATA_WIDTH-1:0] r_model[4][4];
+
+    // Trig LUT, port a looks up yaw then roll, port b pitch
+    logic [ANGLE_WIDTH-1:0] w_lookup_angle;
+    logic signed [DATA_WIDTH-1:0] w_sine_a, w_cosine_a;
+    logic signed [DATA_WIDTH-1:0] w_sine_b, w_cosine_b;
+
+    sin_cos_lu_quarter #(
+        .DATA_WIDTH(DATA_WIDTH),
+        .FRAC_BITS(FRAC_BITS),
+        .ANGLE_WIDTH(ANGLE_WIDTH),
+        .LUT_ADDR_WIDTH(QUARTER_LUT_ADDR_WIDTH)
+    ) sin_cos_lu_inst (
+        .clk(clk),
+        .angle_a(w_lookup_angle),
+        .angle_b(r_angle[PITCH]),
+        .sine_a(w_sine_a),
+        .cosine_a(w_cosine_a),
+        .sine_b(w_sine_b),
+        .cosine_b(w_cosine_b)
+    );
+
+    assign w_lookup_angle = (r_lookup_cnt == 2'd0) ? r_angle[YAW] : r_angle[ROLL];
+
+    // MVP = VP * model
+    logic w_mat_mul_dv;
+    logic w_mat_mul_ready;
+
+    // ========== STATE ==========
+    typedef enum logic [2:0] {
+        IDLE,
+        LOOKUP,
+        PRODUCTS,
+        ROTATION,
+        MULTIPLY,
+        MULTIPLY_WAIT
+    } state_t;
+    state_t current_state = IDLE, next_state;
+
+    always_ff @(posedge clk) begin
+        if (~rstn) begin
+            current_state <= IDLE;
+        end else begin
+            current_state <= next_state;
+        end
+    end
+
+    always_comb begin
+        next_state = current_state;
+
+        case (current_state)
+            IDLE: begin
+                if (i_dv) begin
+                    next_state = LOOKUP;
+                end
+            end
+
+            LOOKUP: begin
+                if (r_lookup_cnt == 2'd3) begin
+                    next_state = PRODUCTS;
+                end
+            end
+
+            PRODUCTS: begin
+                next_state = ROTATION;
+            end
+
+            ROTATION: begin
+                next_state = MULTIPLY;
+            end
+
+            MULTIPLY: begin
+                if (MULTIPLY_VIEW_PROJECTION == 0) begin
+                    next_state = IDLE;
+                end else if (w_mat_mul_ready) begin
+                    next_state = MULTIPLY_WAIT;
+                end
+            end
+
+            MULTIPLY_WAIT: begin
+                if (o_dv) begin
+                    next_state = IDLE;
+                end
+            end
+
+            default: begin
+                next_state = IDLE;
+            end
+        endcase
+    end
+
+    generate
+        if (MULTIPLY_VIEW_PROJECTION != 0) begin : g_view_projection
+            mat_mul #(
+                .DATAWIDTH(DATA_WIDTH),
+                .FRACBITS(FRAC_BITS)
+            ) mat_mul_inst (
+                .clk(clk),
+                .rstn(rstn),
+
+                .A(i_view_projection),
+                .B(r_model),
+                .i_dv(w_mat_mul_dv),
+
+                .C(o_mvp),
+                .o_dv(o_dv),
+                .o_ready(w_mat_mul_ready)
+            );
+        end else begin : g_model_only
+            assign o_mvp = r_model;
+            assign o_dv = (current_state == MULTIPLY);
+            assign w_mat_mul_ready = 1'b1;
+        end
+    endgenerate
+
+    assign o_ready = (current_state == IDLE);
+    assign w_mat_mul_dv = (current_state == MULTIPLY) && w_mat_mul_ready && (MULTIPLY_VIEW_PROJECTION != 0);
+
+    always_ff @(posedge clk) begin
+        if (~rstn) begin
+            foreach (r_position[i]) r_position[i] <= '0;
+            foreach (r_angle[i]) r_angle[i] <= '0;
+            r_lookup_cnt <= '0;
+        end else begin
+            case (current_state)
+                IDLE: begin
+                    r_lookup_cnt <= '0;
+
+                    if (i_dv) begin
+                        r_position <= i_position;
+                        r_angle[YAW] <= i_yaw;
+                        r_angle[PITCH] <= i_pitch;
+                        r_angle[ROLL] <= i_roll;
+                    end
+                end
+
+                // The LUT has two cycles latency, yaw and pitch are issued
+                // at count 0 and read at count 2, roll one cycle later
+                LOOKUP: begin
+                    r_lookup_cnt <= r_lookup_cnt + 1;
+
+                    if (r_lookup_cnt == 2'd2) begin
+                        r_sin[YAW] <= w_sine_a;
+                        r_cos[YAW] <= w_cosine_a;
+                        r_sin[PITCH] <= w_sine_b;
+                        r_cos[PITCH] <= w_cosine_b;
+                    end
+
+                    if (r_lookup_cnt == 2'd3) begin
+                        r_sin[ROLL] <= w_sine_a;
+                        r_cos[ROLL] <= w_cosine_a;
+                    end
+                end
+
+                PRODUCTS: begin
+                    r_sy_sp <= fixed_mul(r_sin[YAW], r_sin[PITCH]);
+                    r_cy_sp <= fixed_mul(r_cos[YAW], r_sin[PITCH]);
+                    r_sy_cp <= fixed_mul(r_sin[YAW], r_cos[PITCH]);
+                    r_cy_cp <= fixed_mul(r_cos[YAW], r_cos[PITCH]);
+                    r_cp_sr <= fixed_mul(r_cos[PITCH], r_sin[ROLL]);
+                    r_cp_cr <= fixed_mul(r_cos[PITCH], r_cos[ROLL]);
+                    r_sy_sr <= fixed_mul(r_sin[YAW], r_sin[ROLL]);
+                    r_sy_cr <= fixed_mul(r_sin[YAW], r_cos[ROLL]);
+                    r_cy_sr <= fixed_mul(r_cos[YAW], r_sin[ROLL]);
+                    r_cy_cr <= fixed_mul(r_cos[YAW], r_cos[ROLL]);
+                end
+
+                ROTATION: begin
+                    r_model[0][0] <= r_cy_cr + fixed_mul(r_sy_sp, r_sin[ROLL]);
+                    r_model[0][1] <= fixed_mul(r_sy_sp, r_cos[ROLL]) - r_cy_sr;
+                    r_model[0][2] <= r_sy_cp;
+                    r_model[0][3] <= r_position[0];
+
+                    r_model[1][0] <= r_cp_sr;
+                    r_model[1][1] <= r_cp_cr;
+                    r_model[1][2] <= -r_sin[PITCH];
+                    r_model[1][3] <= r_position[1];
+
+                    r_model[2][0] <= fixed_mul(r_cy_sp, r_sin[ROLL]) - r_sy_cr;
+                    r_model[2][1] <= r_sy_sr + fixed_mul(r_cy_sp, r_cos[ROLL]);
+                    r_model[2][2] <= r_cy_cp;
+                    r_model[2][3] <= r_position[2];
+
+                    r_model[3][0] <= '0;
+                    r_model[3][1] <= '0;
+                    r_model[3][2] <= '0;
+                    r_model[3][3] <= 1 << FRAC_BITS;
+                end
+
+                default: begin
+                end
+            endcase
+        end
+    end
+
+endmodule
@@ -0,0 +1,196 @@
+#include <stdlib.h>
+#include <stdint.h>
+#include <cstdlib>
+#include <verilated.h>
+#include <verilated_vcd_c.h>
+#include "obj_dir/Vpose_mvp.h"
+
+#define DATA_WIDTH 24
+#define FRAC_BITS 13
+#define ANGLE_WIDTH 16
+#define TRIG_LUT_SIZE (1 << ANGLE_WIDTH)
+#define QUARTER_LUT_ADDR_WIDTH 8
+#define QUARTER_WIDTH (ANGLE_WIDTH - 2)
+#define INTERP_BITS (QUARTER_WIDTH - QUARTER_LUT_ADDR_WIDTH)
+#define VALUE_WIDTH (FRAC_BITS + 1)
+
+#define NUM_POSES 32
+#define RESET_CLKS 8
+#define MAX_SIM_TIME (2 * (RESET_CLKS + NUM_POSES * 32))
+
+vluint64_t sim_time = 0;
+vluint64_t posedge_cnt = 0;
+
+int64_t sine_lut[TRIG_LUT_SIZE];
+int64_t cosine_lut[TRIG_LUT_SIZE];
+
+// Sign extend a DATA_WIDTH value
+int64_t sext(int64_t v) {
+    v &= (1LL << DATA_WIDTH) - 1;
+    return (v & (1LL << (DATA_WIDTH - 1))) ? v - (1LL << DATA_WIDTH) : v;
+}
+
+int64_t fixed_mul(int64_t a, int64_t b) {
+    return sext((a * b) >> FRAC_BITS);
+}
+
+// Same symmetry and interpolation as sin_cos_lu_quarter
+int64_t quarter_sine(int64_t* quarter_lut, int phase) {
+    phase &= TRIG_LUT_SIZE - 1;
+    int offset = phase & ((1 << QUARTER_WIDTH) - 1);
+    if (phase & (1 << QUARTER_WIDTH)) offset = (1 << QUARTER_WIDTH) - offset;
+
+    int64_t magnitude;
+    if (offset == (1 << QUARTER_WIDTH)) {
+        magnitude = 1 << FRAC_BITS;
+    } else {
+        int64_t entry = quarter_lut[offset >> INTERP_BITS];
+        int64_t frac = offset & ((1 << INTERP_BITS) - 1);
+        magnitude = (entry & ((1 << VALUE_WIDTH) - 1)) + (((entry >> VALUE_WIDTH) * frac) >> INTERP_BITS);
+    }
+
+    return (phase >> (ANGLE_WIDTH - 1)) ? -magnitude : magnitude;
+}
+
+// Expands the quarter wave table to full sine and cosine tables
+bool read_lut(const char* file) {
+    int64_t quarter_lut[1 << QUARTER_LUT_ADDR_WIDTH];
+
+    FILE* f = fopen(file, "r");
+    if (!f) return false;
+    for (int i = 0; i < (1 << QUARTER_LUT_ADDR_WIDTH); i++) {
+        unsigned int v;
+        if (fscanf(f, "%x", &v) != 1) return false;
+        quarter_lut[i] = v;
+    }
+    fclose(f);
+
+    for (int i = 0; i < TRIG_LUT_SIZE; i++) {
+        sine_lut[i] = quarter_sine(quarter_lut, i);
+        cosine_lut[i] = quarter_sine(quarter_lut, i + (1 << QUARTER_WIDTH));
+    }
+    return true;
+}
+
+// Same truncation as mat_mul: sign of the full sum, then the middle bits
+void mat_mul(int64_t A[4][4], int64_t B[4][4], int64_t C[4][4]) {
+    for (int i = 0; i < 4; i++) {
+        for (int j = 0; j < 4; j++) {
+            int64_t sum = 0;
+            for (int k = 0; k < 4; k++) sum += A[i][k] * B[k][j];
+            int64_t sign = (sum >> (2 * DATA_WIDTH - 1)) & 1;
+            int64_t bits = (sum >> FRAC_BITS) & ((1LL << (DATA_WIDTH - 1)) - 1);
+            C[i][j] = sext((sign << (DATA_WIDTH - 1)) | bits);
+        }
+    }
+}
+
+void expected_mvp(int64_t vp[4][4], int64_t pos[3], int yaw, int pitch, int roll, int64_t mvp[4][4]) {
+    int64_t sy = sine_lut[yaw], cy = cosine_lut[yaw];
+    int64_t sp = sine_lut[pitch], cp = cosine_lut[pitch];
+    int64_t sr = sine_lut[roll], cr = cosine_lut[roll];
+
+    int64_t sy_sp = fixed_mul(sy, sp), cy_sp = fixed_mul(cy, sp);
+
+    int64_t model[4][4] = {
+        {sext(fixed_mul(cy, cr) + fixed_mul(sy_sp, sr)), sext(fixed_mul(sy_sp, cr) - fixed_mul(cy, sr)), fixed_mul(sy, cp), pos[0]},
+        {fixed_mul(cp, sr), fixed_mul(cp, cr), sext(-sp), pos[1]},
+        {sext(fixed_mul(cy_sp, sr) - fixed_mul(sy, cr)), sext(fixed_mul(sy, sr) + fixed_mul(cy_sp, cr)), fixed_mul(cy, cp), pos[2]},
+        {0, 0, 0, 1 << FRAC_BITS}
+    };
+
+    mat_mul(vp, model, mvp);
+}
+
+int main(int argc, char** argv) {
+    srand(time(NULL));
+    Verilated::commandArgs(argc, argv);
+
+    if (!read_lut("quarter_sine_lut.mem")) {
+        printf("FAILED: could not read trig LUT files\n");
+        exit(EXIT_FAILURE);
+    }
+
+    Vpose_mvp* dut = new Vpose_mvp;
+
+    Verilated::traceEverOn(true);
+    VerilatedVcdC* m_trace = new VerilatedVcdC;
+    dut->trace(m_trace, 5);
+    m_trace->open("waveform.vcd");
+
+    // Projection like the one used in top, values in [-4, 4)
+    int64_t vp[4][4];
+    for (int i = 0; i < 4; i++) {
+        for (int j = 0; j < 4; j++) {
+            vp[i][j] = (rand() % (8 << FRAC_BITS)) - (4 << FRAC_BITS);
+            dut->i_view_projection[i][j] = vp[i][j] & ((1 << DATA_WIDTH) - 1);
+        }
+    }
+
+    dut->clk = 0;
+    dut->rstn = 0;
+    dut->i_dv = 0;
+
+    int64_t pos[3];
+    int yaw = 0, pitch = 0, roll = 0;
+    int poses_sent = 0;
+    int poses_checked = 0;
+    int errors = 0;
+
+    while (sim_time < MAX_SIM_TIME && poses_checked < NUM_POSES) {
+        dut->clk ^= 1;
+        dut->eval();
+
+        if (dut->clk == 1) {
+            posedge_cnt++;
+            dut->rstn = posedge_cnt > RESET_CLKS;
+            dut->i_dv = 0;
+
+            if (dut->o_dv) {
+                int64_t mvp[4][4];
+                expected_mvp(vp, pos, yaw, pitch, roll, mvp);
+                for (int i = 0; i < 4; i++) {
+                    for (int j = 0; j < 4; j++) {
+                        if (sext(dut->o_mvp[i][j]) != mvp[i][j]) {
+                            printf("Error: pose %d, mvp[%d][%d]: expected %ld, got %ld\n",
+                                   poses_checked, i, j, mvp[i][j], sext(dut->o_mvp[i][j]));
+                            errors++;
+                        }
+                    }
+                }
+                poses_checked++;
+            }
+
+            // Only one pose in flight, such that the expected pose is known
+            if (dut->rstn && dut->o_ready && poses_sent == poses_checked) {
+                for (int i = 0; i < 3; i++) {
+                    pos[i] = (rand() % (64 << FRAC_BITS)) - (32 << FRAC_BITS);
+                    dut->i_position[i] = pos[i] & ((1 << DATA_WIDTH) - 1);
+                }
+                yaw = rand() % TRIG_LUT_SIZE;
+                pitch = rand() % TRIG_LUT_SIZE;
+                roll = rand() % TRIG_LUT_SIZE;
+                dut->i_yaw = yaw;
+                dut->i_pitch = pitch;
+                dut->i_roll = roll;
+                dut->i_dv = 1;
+                poses_sent++;
+            }
+        }
+
+        m_trace->dump(sim_time);
+        sim_time++;
+    }
+
+    if (poses_checked != NUM_POSES) {
+        printf("Error: only %d of %d poses finished\n", poses_checked, NUM_POSES);
+        errors++;
+    }
+
+    m_trace->close();
+    printf("%s: %d errors\n", errors ? "FAILED" : "PASSED", errors);
+
+    delete dut;
+
+    exit(errors ? EXIT_FAILURE : EXIT_SUCCESS);
+}
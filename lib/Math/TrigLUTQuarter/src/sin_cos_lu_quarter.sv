@@ -0,0 +1,118 @@
+// Sine and cosine lookup from a single quarter wave table.
+// The other quadrants are derived by symmetry and cos(x) = sin(x + pi/2).
+// Angles between table entries are linearly interpolated, every entry holds
+// its value and the delta to the next entry, so one read is enough.
+// Two angles are looked up per clock, with two cycles latency.
+// A full turn is 1 << ANGLE_WIDTH, ANGLE_WIDTH must be > LUT_ADDR_WIDTH + 2.
+module sin_cos_lu_quarter #(
+    parameter unsigned DATA_WIDTH = 24,
+    parameter unsigned FRAC_BITS = 13,
+    parameter unsigned ANGLE_WIDTH = 16,
+    parameter unsigned LUT_ADDR_WIDTH = 8,
+    parameter unsigned DELTA_WIDTH = 8
+) (
+    input logic clk,
+
+    input logic [ANGLE_WIDTH-1:0] angle_a,
+    input logic [ANGLE_WIDTH-1:0] angle_b,
+
+    output logic signed [DATA_WIDTH-1:0] sine_a,
+    output logic signed [DATA_WIDTH-1:0] cosine_a,
+    output logic signed [DATA_WIDTH-1:0] sine_b,
+    output logic signed [DATA_WIDTH-1:0] cosine_b
+);
+
+    localparam unsigned QUARTER_WIDTH = ANGLE_WIDTH - 2;
+    localparam unsigned INTERP_BITS = QUARTER_WIDTH - LUT_ADDR_WIDTH;
+    localparam unsigned VALUE_WIDTH = FRAC_BITS + 1;
+    localparam unsigned ENTRY_WIDTH = DELTA_WIDTH + VALUE_WIDTH;
+
+    // 0: sine a, 1: cosine a, 2: sine b, 3: cosine b
+    localparam int NUM_LOOKUPS = 4;
+
+    // sin over [0, pi/2), each entry is {delta, value}.
+    // Two copies, each read on two ports
+    logic [ENTRY_WIDTH-1:0] rom_a [1 << LUT_ADDR_WIDTH];
+    logic [ENTRY_WIDTH-1:0] rom_b [1 << LUT_ADDR_WIDTH];
+
+    initial begin
+        $readmemh("quarter_sine_lut.mem", rom_a);
+        $readmemh("quarter_sine_lut.mem", rom_b);
+    end
+
+    // Offset into the quarter wave, mirrored in the second and fourth quadrant.
+    // The top bit is set when the mirrored offset is a full quarter (sin = 1)
+    function automatic logic [QUARTER_WIDTH:0] quarter_offset(
+        input logic [ANGLE_WIDTH-1:0] phase
+    );
+        logic [QUARTER_WIDTH:0] offset;
+        offset = {1'b0, phase[QUARTER_WIDTH-1:0]};
+
+        if (phase[QUARTER_WIDTH]) begin
+            return (QUARTER_WIDTH+1)'(1 << QUARTER_WIDTH) - offset;
+        end
+
+        return offset;
+    endfunction
+
+    function automatic logic signed [DATA_WIDTH-1:0] interpolate(
+        input logic [ENTRY_WIDTH-1:0] entry,
+        input logic [INTERP_BITS-1:0] frac,
+        input logic one,
+        input logic negative
+    );
+        logic [DELTA_WIDTH+INTERP_BITS-1:0] step;
+        logic [VALUE_WIDTH-1:0] magnitude;
+
+        step = entry[ENTRY_WIDTH-1 -: DELTA_WIDTH] * frac;
+
+        if (one) begin
+            magnitude = VALUE_WIDTH'(1 << FRAC_BITS);
+        end else begin
+            magnitude = entry[VALUE_WIDTH-1:0] + VALUE_WIDTH'(step >> INTERP_BITS);
+        end
+
+        return negative ? -DATA_WIDTH'(magnitude) : DATA_WIDTH'(magnitude);
+    endfunction
+
+    logic [ANGLE_WIDTH-1:0] w_phase[NUM_LOOKUPS];
+    logic [QUARTER_WIDTH:0] w_offset[NUM_LOOKUPS];
+
+    assign w_phase[0] = angle_a;
+    assign w_phase[1] = angle_a + ANGLE_WIDTH'(1 << QUARTER_WIDTH);
+    assign w_phase[2] = angle_b;
+    assign w_phase[3] = angle_b + ANGLE_WIDTH'(1 << QUARTER_WIDTH);
+
+    always_comb begin
+        for (int i = 0; i < NUM_LOOKUPS; i++) begin
+            w_offset[i] = quarter_offset(w_phase[i]);
+        end
+    end
+
+    // ========== STAGE 1: TABLE READ ==========
+    logic [ENTRY_WIDTH-1:0] r_entry[NUM_LOOKUPS];
+    logic [INTERP_BITS-1:0] r_frac[NUM_LOOKUPS];
+    logic r_one[NUM_LOOKUPS];
+    logic r_negative[NUM_LOOKUPS];
+
+    always_ff @(posedge clk) begin
+        r_entry[0] <= rom_a[w_offset[0][QUARTER_WIDTH-1:INTERP_BITS]];
+        r_entry[1] <= rom_a[w_offset[1][QUARTER_WIDTH-1:INTERP_BITS]];
+        r_entry[2] <= rom_b[w_offset[2][QUARTER_WIDTH-1:INTERP_BITS]];
+        r_entry[3] <= rom_b[w_offset[3][QUARTER_WIDTH-1:INTERP_BITS]];
+
+        for (int i = 0; i < NUM_LOOKUPS; i++) begin
+            r_frac[i] <= w_offset[i][INTERP_BITS-1:0];
+            r_one[i] <= w_offset[i][QUARTER_WIDTH];
+            r_negative[i] <= w_phase[i][ANGLE_WIDTH-1];
+        end
+    end
+
+    // ========== STAGE 2: INTERPOLATION ==========
+    always_ff @(posedge clk) begin
+        sine_a <= interpolate(r_entry[0], r_frac[0], r_one[0], r_negative[0]);
+        cosine_a <= interpolate(r_entry[1], r_frac[1], r_one[1], r_negative[1]);
+        sine_b <= interpolate(r_entry[2], r_frac[2], r_one[2], r_negative[2]);
+        cosine_b <= interpolate(r_entry[3], r_frac[3], r_one[3], r_negative[3]);
+    end
+endmodule
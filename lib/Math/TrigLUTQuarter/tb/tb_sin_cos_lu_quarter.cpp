@@ -0,0 +1,143 @@
+#include <math.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <verilated.h>
+#include <verilated_vcd_c.h>
+#include "obj_dir/Vsin_cos_lu_quarter.h"
+
+#define DATA_WIDTH 24
+#define FRAC_BITS 13
+#ifndef ANGLE_WIDTH
+#define ANGLE_WIDTH 16
+#endif
+#define LUT_ADDR_WIDTH 8
+#define VALUE_WIDTH (FRAC_BITS + 1)
+
+#define NUM_ANGLES (1 << ANGLE_WIDTH)
+#define QUARTER_WIDTH (ANGLE_WIDTH - 2)
+#define INTERP_BITS (QUARTER_WIDTH - LUT_ADDR_WIDTH)
+#define LATENCY 2
+
+// Allowed difference to the real sine, in LSBs. With 16 bit angles the
+// interpolation between the 256 entries covers 6 bits
+#define TOLERANCE 2
+
+vluint64_t sim_time = 0;
+
+int64_t quarter_lut[1 << LUT_ADDR_WIDTH];
+
+int64_t sext(int64_t v) {
+    v &= (1LL << DATA_WIDTH) - 1;
+    return (v & (1LL << (DATA_WIDTH - 1))) ? v - (1LL << DATA_WIDTH) : v;
+}
+
+bool read_lut(const char* file) {
+    FILE* f = fopen(file, "r");
+    if (!f) return false;
+    for (int i = 0; i < (1 << LUT_ADDR_WIDTH); i++) {
+        unsigned int v;
+        if (fscanf(f, "%x", &v) != 1) return false;
+        quarter_lut[i] = v;
+    }
+    fclose(f);
+    return true;
+}
+
+// Same symmetry and interpolation as sin_cos_lu_quarter
+int64_t expected_sine(int phase) {
+    phase &= NUM_ANGLES - 1;
+    int offset = phase & ((1 << QUARTER_WIDTH) - 1);
+    if (phase & (1 << QUARTER_WIDTH)) offset = (1 << QUARTER_WIDTH) - offset;
+
+    int64_t magnitude;
+    if (offset == (1 << QUARTER_WIDTH)) {
+        magnitude = 1 << FRAC_BITS;
+    } else {
+        int64_t entry = quarter_lut[offset >> INTERP_BITS];
+        int64_t value = entry & ((1 << VALUE_WIDTH) - 1);
+        int64_t delta = entry >> VALUE_WIDTH;
+        int64_t frac = offset & ((1 << INTERP_BITS) - 1);
+        magnitude = value + ((delta * frac) >> INTERP_BITS);
+    }
+
+    return (phase >> (ANGLE_WIDTH - 1)) ? -magnitude : magnitude;
+}
+
+int64_t expected_cosine(int phase) {
+    return expected_sine(phase + (1 << QUARTER_WIDTH));
+}
+
+double max_error = 0;
+
+int check(const char* name, int angle, int64_t got, int64_t exp, double real) {
+    int errors = 0;
+    max_error = fmax(max_error, fabs((double)got - real * (1 << FRAC_BITS)));
+    if (got != exp) {
+        printf("Error: %s(%d): expected %ld, got %ld\n", name, angle, exp, got);
+        errors++;
+    }
+    if (fabs((double)got - real * (1 << FRAC_BITS)) > TOLERANCE) {
+        printf("Error: %s(%d): %ld is too far from %f\n", name, angle, got, real * (1 << FRAC_BITS));
+        errors++;
+    }
+    return errors;
+}
+
+int main(int argc, char** argv) {
+    Verilated::commandArgs(argc, argv);
+
+    if (!read_lut("quarter_sine_lut.mem")) {
+        printf("FAILED: could not read quarter_sine_lut.mem\n");
+        exit(EXIT_FAILURE);
+    }
+
+    Vsin_cos_lu_quarter* dut = new Vsin_cos_lu_quarter;
+
+    Verilated::traceEverOn(true);
+    VerilatedVcdC* m_trace = new VerilatedVcdC;
+    dut->trace(m_trace, 5);
+    m_trace->open("waveform.vcd");
+
+    int angles_a[NUM_ANGLES + LATENCY];
+    int angles_b[NUM_ANGLES + LATENCY];
+    int errors = 0;
+
+    dut->clk = 0;
+
+    // Every angle on port a, a different walk over all angles on port b
+    for (int cycle = 0; cycle < NUM_ANGLES + LATENCY; cycle++) {
+        angles_a[cycle] = cycle % NUM_ANGLES;
+        angles_b[cycle] = (cycle * 7 + 1000) % NUM_ANGLES;
+        dut->angle_a = angles_a[cycle];
+        dut->angle_b = angles_b[cycle];
+
+        // Outputs of the angles applied LATENCY clocks ago
+        if (cycle >= LATENCY) {
+            int a = angles_a[cycle - LATENCY];
+            int b = angles_b[cycle - LATENCY];
+            double ta = 2 * M_PI * a / NUM_ANGLES;
+            double tb = 2 * M_PI * b / NUM_ANGLES;
+
+            errors += check("sin_a", a, sext(dut->sine_a), expected_sine(a), sin(ta));
+            errors += check("cos_a", a, sext(dut->cosine_a), expected_cosine(a), cos(ta));
+            errors += check("sin_b", b, sext(dut->sine_b), expected_sine(b), sin(tb));
+            errors += check("cos_b", b, sext(dut->cosine_b), expected_cosine(b), cos(tb));
+        }
+
+        dut->clk = 1;
+        dut->eval();
+        m_trace->dump(sim_time++);
+
+        dut->clk = 0;
+        dut->eval();
+        m_trace->dump(sim_time++);
+    }
+
+    m_trace->close();
+    printf("Angle width %d, max error %f LSB\n", ANGLE_WIDTH, max_error);
+    printf("%s: %d errors\n", errors ? "FAILED" : "PASSED", errors);
+
+    delete dut;
+
+    exit(errors ? EXIT_FAILURE : EXIT_SUCCESS);
+}
@@ -0,0 +1,135 @@
+// Asynchronous FIFO, for crossing between unrelated clocks
+//
+// Each side keeps a binary pointer for addressing and a gray coded copy,
+// which is passed through two flip-flops into the other clock domain. Only
+// one bit of a gray code changes per step, so a synchronized pointer is
+// always either the old or the new value. The pointers have one bit more
+// than the address, to tell a full FIFO from an empty one.
+//
+// full and empty are pessimistic: they are set straight away by the own
+// side, and only cleared once the other side's pointer has been
+// synchronized, a few cycles later.
+
+`timescale 1ns/1ps
+
+module async_fifo #(
+    parameter unsigned DATAWIDTH = 8,
+    parameter unsigned DEPTH = 16       // Power of two, at least 4
+    ) (
+    // "write_clk" clock domain
+    input logic write_clk,
+    input logic write_rstn,
+    input logic write_en,               // Ignored while full
+    input logic [DATAWIDTH-1:0] data_in,
+    output logic full,
+    output logic almost_full,           // One entry or less left, for writers that stall a cycle late
+
+    // "read_clk" clock domain
+    input logic read_clk,
+    input logic read_rstn,
+    input logic read_en,                // Ignored while empty
+    output logic [DATAWIDTH-1:0] data_out,
+    output logic o_dv,                  // The cycle after read_en
+    output logic empty
+    );
+
+    localparam unsigned ADDR_WIDTH = $clog2(DEPTH);
+    localparam unsigned PTR_WIDTH = ADDR_WIDTH + 1;
+
+    logic [DATAWIDTH-1:0] fifo[DEPTH];
+
+    logic [PTR_WIDTH-1:0] r_write_ptr;
+    logic [PTR_WIDTH-1:0] r_write_ptr_gray;
+    logic [PTR_WIDTH-1:0] r_read_ptr_gray_sync[2];
+
+    logic [PTR_WIDTH-1:0] r_read_ptr;
+    logic [PTR_WIDTH-1:0] r_read_ptr_gray;
+    logic [PTR_WIDTH-1:0] r_write_ptr_gray_sync[2];
+
+    function automatic logic [PTR_WIDTH-1:0] gray_to_binary(
+        input logic [PTR_WIDTH-1:0] gray
+    );
+        logic [PTR_WIDTH-1:0] binary;
+
+        binary[PTR_WIDTH-1] = gray[PTR_WIDTH-1];
+        for (int i = PTR_WIDTH - 2; i >= 0; i--) begin
+            binary[i] = binary[i+1] ^ gray[i];
+        end
+        return binary;
+    endfunction
+
+    // ============== WRITE, "write_clk" clock domain ==============
+
+    logic [PTR_WIDTH-1:0] w_write_ptr_next;
+    logic [PTR_WIDTH-1:0] w_write_ptr_gray_next;
+    logic [PTR_WIDTH-1:0] w_write_count_next;
+
+    always_comb begin
+        w_write_ptr_next = r_write_ptr + PTR_WIDTH'(write_en && ~full);
+        w_write_ptr_gray_next = w_write_ptr_next ^ (w_write_ptr_next >> 1);
+        w_write_count_next = w_write_ptr_next - gray_to_binary(r_read_ptr_gray_sync[1]);
+    end
+
+    always_ff @(posedge write_clk) begin
+        if (write_en && ~full) begin
+            fifo[r_write_ptr[ADDR_WIDTH-1:0]] <= data_in;
+        end
+    end
+
+    always_ff @(posedge write_clk) begin
+        if (~write_rstn) begin
+            r_write_ptr <= '0;
+            r_write_ptr_gray <= '0;
+            r_read_ptr_gray_sync[0] <= '0;
+            r_read_ptr_gray_sync[1] <= '0;
+            full <= 1'b0;
+            almost_full <= 1'b0;
+        end else begin
+            r_write_ptr <= w_write_ptr_next;
+            r_write_ptr_gray <= w_write_ptr_gray_next;
+
+            r_read_ptr_gray_sync[0] <= r_read_ptr_gray;
+            r_read_ptr_gray_sync[1] <= r_read_ptr_gray_sync[0];
+
+            // Full when the write pointer is a whole lap ahead, in gray code
+            // the two top bits differ and the rest are equal
+            full <= (w_write_ptr_gray_next == {~r_read_ptr_gray_sync[1][PTR_WIDTH-1:PTR_WIDTH-2],
+                                                r_read_ptr_gray_sync[1][PTR_WIDTH-3:0]});
+            almost_full <= (w_write_count_next >= PTR_WIDTH'(DEPTH - 1));
+        end
+    end
+
+    // ============== READ, "read_clk" clock domain ==============
+    logic [PTR_WIDTH-1:0] w_read_ptr_next;
+    logic [PTR_WIDTH-1:0] w_read_ptr_gray_next;
+
+    always_comb begin
+        w_read_ptr_next = r_read_ptr + PTR_WIDTH'(read_en && ~empty);
+        w_read_ptr_gray_next = w_read_ptr_next ^ (w_read_ptr_next >> 1);
+    end
+
+    always_ff @(posedge read_clk) begin
+        if (~read_rstn) begin
+            r_read_ptr <= '0;
+            r_read_ptr_gray <= '0;
+            r_write_ptr_gray_sync[0] <= '0;
+            r_write_ptr_gray_sync[1] <= '0;
+            empty <= 1'b1;
+            o_dv <= 1'b0;
+        end else begin
+            r_read_ptr <= w_read_ptr_next;
+            r_read_ptr_gray <= w_read_ptr_gray_next;
+
+            r_write_ptr_gray_sync[0] <= r_write_ptr_gray;
+            r_write_ptr_gray_sync[1] <= r_write_ptr_gray_sync[0];
+
+            empty <= (w_read_ptr_gray_next == r_write_ptr_gray_sync[1]);
+
+            if (read_en && ~empty) begin
+                data_out <= fifo[r_read_ptr[ADDR_WIDTH-1:0]];
+            end
+            o_dv <= read_en && ~empty;
+        end
+    end
+
+endmodule
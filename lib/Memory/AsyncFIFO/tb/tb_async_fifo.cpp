@@ -0,0 +1,149 @@
+#include <stdlib.h>
+#include <cstdlib>
+#include <algorithm>
+#include <verilated.h>
+#include <verilated_vcd_c.h>
+#include "obj_dir/Vasync_fifo.h"
+
+#define DATAWIDTH 16
+#define DATA_MASK ((1 << DATAWIDTH) - 1)
+
+#define RESET_CLKS 8
+#define NUM_ROUNDS 24
+#define WORDS_PER_ROUND 400
+#define MAX_HALF_PERIOD 13
+#define MAX_SIM_TIME (NUM_ROUNDS * WORDS_PER_ROUND * 2 * MAX_HALF_PERIOD * 16)
+
+vluint64_t sim_time = 0;
+
+int main(int argc, char** argv) {
+    srand(time(NULL));
+    Verilated::commandArgs(argc, argv);
+
+    Vasync_fifo* dut = new Vasync_fifo;
+
+    Verilated::traceEverOn(true);
+    VerilatedVcdC* m_trace = new VerilatedVcdC;
+    dut->trace(m_trace, 5);
+    m_trace->open("waveform.vcd");
+
+    dut->write_clk = 0;
+    dut->read_clk = 0;
+    dut->write_rstn = 0;
+    dut->read_rstn = 0;
+    dut->write_en = 0;
+    dut->read_en = 0;
+    dut->data_in = 0;
+
+    // The two clocks get random periods every round, so the ratio changes
+    // and the edges drift past each other. The writer and the reader each
+    // run at a random duty, such that the FIFO both fills up and runs dry.
+    // A counting sequence is written and must be read back in order. At the
+    // end the writer stops and the FIFO has to drain completely.
+    int errors = 0;
+    int num_written = 0;
+    int num_read = 0;
+    int num_full = 0;
+    int num_empty = 0;
+    int round = 0;
+    int write_half_period = 1 + rand() % MAX_HALF_PERIOD;
+    int read_half_period = 1 + rand() % MAX_HALF_PERIOD;
+    int write_duty = 1 + rand() % 4;
+    int read_duty = 1 + rand() % 4;
+    vluint64_t next_write_toggle = 0;
+    vluint64_t next_read_toggle = 0;
+    int write_posedges = 0;
+    int read_posedges = 0;
+    bool draining = false;
+
+    while (sim_time < MAX_SIM_TIME) {
+        // Start of a round, with new clock periods
+        if (!draining && num_written >= (round + 1) * WORDS_PER_ROUND) {
+            round++;
+            draining = round == NUM_ROUNDS;
+            write_half_period = 1 + rand() % MAX_HALF_PERIOD;
+            read_half_period = 1 + rand() % MAX_HALF_PERIOD;
+            write_duty = 1 + rand() % 4;
+            read_duty = 1 + rand() % 4;
+        }
+
+        // Advance to the next clock edge
+        sim_time = std::min(next_write_toggle, next_read_toggle);
+        bool write_edge = next_write_toggle == sim_time;
+        bool read_edge = next_read_toggle == sim_time;
+        if (write_edge) {
+            dut->write_clk ^= 1;
+            next_write_toggle += write_half_period;
+        }
+        if (read_edge) {
+            dut->read_clk ^= 1;
+            next_read_toggle += read_half_period;
+        }
+        dut->eval();
+
+        // The outputs are registered, so what is seen after the rising edge
+        // decides the transfer at the next one
+        if (write_edge && dut->write_clk) {
+            write_posedges++;
+            dut->write_rstn = write_posedges > RESET_CLKS;
+            dut->write_en = 0;
+
+            if (dut->write_rstn) {
+                num_full += dut->full;
+                if (dut->full && !dut->almost_full) {
+                    printf("Error: full but not almost full\n");
+                    errors++;
+                }
+                if (!draining && !dut->full && rand() % 4 < write_duty) {
+                    dut->write_en = 1;
+                    dut->data_in = num_written & DATA_MASK;
+                    num_written++;
+                }
+            }
+        }
+
+        if (read_edge && dut->read_clk) {
+            read_posedges++;
+            dut->read_rstn = read_posedges > RESET_CLKS;
+            dut->read_en = 0;
+
+            if (dut->read_rstn) {
+                if (dut->o_dv) {
+                    if (dut->data_out != (num_read & DATA_MASK)) {
+                        printf("Error: word %d: expected %d, got %d\n", num_read,
+                               num_read & DATA_MASK, dut->data_out);
+                        errors++;
+                    }
+                    num_read++;
+                }
+
+                num_empty += dut->empty;
+                if (!dut->empty && (draining || rand() % 4 < read_duty)) {
+                    dut->read_en = 1;
+                }
+
+                if (draining && dut->empty && !dut->o_dv && num_read == num_written) {
+                    break;
+                }
+            }
+        }
+
+        m_trace->dump(sim_time);
+    }
+
+    if (num_read != num_written || num_written < NUM_ROUNDS * WORDS_PER_ROUND) {
+        printf("Error: %d words written, %d read\n", num_written, num_read);
+        errors++;
+    }
+    if (num_full == 0 || num_empty == 0) {
+        printf("Error: full seen %d times, empty %d times\n", num_full, num_empty);
+        errors++;
+    }
+
+    m_trace->close();
+    printf("%s: %d errors\n", errors ? "FAILED" : "PASSED", errors);
+
+    delete dut;
+
+    exit(errors ? EXIT_FAILURE : EXIT_SUCCESS);
+}
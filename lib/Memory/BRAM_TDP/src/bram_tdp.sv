@@ -0,0 +1,48 @@
+// Dual-port BRAM where the read port is also allowed to write. The read port
+// is read-first, so a location can be read and overwritten in the same cycle
+// (used for clearing a buffer as it is scanned out).
+
+module bram_tdp #(
+    parameter unsigned WIDTH = 16,
+    parameter unsigned DEPTH = 32,
+    parameter string FILE = ""
+) (
+    input wire clk_write,
+    input wire clk_read,
+    input wire write_enable,
+    input wire [$clog2(DEPTH)-1:0] addr_write,
+    input wire [$clog2(DEPTH)-1:0] addr_read,
+    input wire [WIDTH-1:0] data_in,
+    output reg [WIDTH-1:0] data_out,
+
+    // Write back on the read port
+    input wire read_write_enable,
+    input wire [WIDTH-1:0] read_data_in
+);
+
+    logic [WIDTH-1:0] memory [DEPTH];
+
+    initial begin
+        if (FILE != "") begin
+            $readmemh(FILE, memory);
+        end
+    end
+
+    // Both ports write the same memory, which is what makes Vivado infer
+    // a true dual-port BRAM. Can therefore not use always_ff here.
+    /* verilator lint_off MULTIDRIVEN */
+    always @(posedge clk_write) begin
+        if (write_enable) begin
+            memory[addr_write] <= data_in;
+        end
+    end
+
+    always @(posedge clk_read) begin
+        data_out <= memory[addr_read];
+        if (read_write_enable) begin
+            memory[addr_read] <= read_data_in;
+        end
+    end
+    /* verilator lint_on MULTIDRIVEN */
+
+endmodule
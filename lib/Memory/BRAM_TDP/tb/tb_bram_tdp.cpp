@@ -0,0 +1,93 @@
+#include <stdlib.h>
+#include <iostream>
+#include <cstdlib>
+#include <verilated.h>
+#include <verilated_vcd_c.h>
+#include "obj_dir/Vbram_tdp.h"
+
+#define MAX_SIM_TIME 128
+#define DATA_WIDTH 4
+#define DEPTH 16
+#define CLEAR_VALUE 0
+
+vluint64_t sim_time = 0;
+vluint64_t posedge_cnt = 0;
+
+int main(int argc, char** argv) {
+    srand(time(NULL));
+    Verilated::commandArgs(argc, argv);
+
+    Vbram_tdp* dut = new Vbram_tdp;
+
+    Verilated::traceEverOn(true);
+    VerilatedVcdC* m_trace = new VerilatedVcdC;
+    dut->trace(m_trace, 5);
+    m_trace->open("waveform.vcd");
+
+    int expected[DEPTH];
+    for (int i = 0; i < DEPTH; i++) {
+        expected[i] = rand() % (1 << DATA_WIDTH);
+    }
+
+    dut->clk_write = 0;
+    dut->clk_read = 0;
+    dut->write_enable = 0;
+    dut->read_write_enable = 0;
+    dut->read_data_in = CLEAR_VALUE;
+    dut->addr_write = 0;
+    dut->addr_read = 0;
+
+    // Pass 0: fill memory on the write port
+    // Pass 1: read every location and clear it on the read port
+    // Pass 2: read every location again, all should now be cleared
+    int errors = 0;
+    int read_addr_last = -1;
+    int pass_last = -1;
+    while (sim_time < MAX_SIM_TIME) {
+        dut->clk_write ^= 1;
+        dut->clk_read ^= 1;
+        dut->eval();
+
+        if (dut->clk_write == 1) {
+            // Check data from read issued last cycle
+            if (read_addr_last >= 0) {
+                int exp = (pass_last == 1) ? expected[read_addr_last] : CLEAR_VALUE;
+                if (dut->data_out != exp) {
+                    printf("Error: addr %d, pass %d: expected %d, got %d\n",
+                           read_addr_last, pass_last, exp, dut->data_out);
+                    errors++;
+                }
+            }
+
+            int pass = posedge_cnt / DEPTH;
+            int addr = posedge_cnt % DEPTH;
+            read_addr_last = -1;
+
+            dut->write_enable = 0;
+            dut->read_write_enable = 0;
+
+            if (pass == 0) {
+                dut->write_enable = 1;
+                dut->addr_write = addr;
+                dut->data_in = expected[addr];
+            } else if (pass <= 2) {
+                dut->addr_read = addr;
+                dut->read_write_enable = (pass == 1);
+                read_addr_last = addr;
+                pass_last = pass;
+            }
+
+            posedge_cnt++;
+        }
+
+        m_trace->dump(sim_time);
+        sim_time++;
+    }
+
+    m_trace->close();
+    printf("%s: %d errors\n", errors ? "FAILED" : "PASSED", errors);
+
+    delete dut;
+
+    exit(errors ? EXIT_FAILURE : EXIT_SUCCESS);
+}
@@ -2,7 +2,9 @@ module buffer #(
     parameter unsigned WIDTH = 16,
     parameter unsigned DEPTH = 32,
     parameter string FILE = "",
-    parameter unsigned ADDR_WIDTH = $clog2(DEPTH)
+    parameter unsigned CLEAR_ON_READ = 0,  // Allow the read port to clear the locations it reads
+    parameter unsigned ADDR_WIDTH = $clog2(DEPTH),
+    parameter unsigned LENGTH_WIDTH = $clog2(DEPTH + 1)
 ) (
     input logic clk_write,
     input logic clk_read,
@@ -15,6 +17,8 @@ module buffer #(
     input logic [ADDR_WIDTH-1:0] addr_read,
 
     input logic [WIDTH-1:0] clear_value,
+    input logic [LENGTH_WIDTH-1:0] clear_length,   // Number of entries, from address 0, to clear
+    input logic read_clear,                        // (clk_read) Overwrite addr_read with clear_value
     input logic [WIDTH-1:0] data_in,
     output logic [WIDTH-1:0] data_out
 );
@@ -27,6 +31,7 @@ module buffer #(
     state_t state = IDLE;
 
     logic [ADDR_WIDTH-1:0] clear_counter;
+    logic [LENGTH_WIDTH-1:0] r_clear_length;
 
     logic [ADDR_WIDTH-1:0] bram_addr_write;
     logic [WIDTH-1:0] bram_data_write;
@@ -46,7 +51,7 @@ module buffer #(
             CLEARING: begin
                 bram_addr_write = clear_counter;
                 bram_data_write = clear_value;
-                bram_write_en = 1;
+                bram_write_en = LENGTH_WIDTH'(clear_counter) < r_clear_length;
             end
 
             default: begin
@@ -54,19 +59,40 @@ module buffer #(
         endcase
     end
 
-    bram_dp #(
-        .WIDTH(WIDTH),
-        .DEPTH(DEPTH),
-        .FILE(FILE)
-    ) bram_dp_inst (
-        .clk_write(clk_write),
-        .clk_read(clk_read),
-        .write_enable(bram_write_en),
-        .addr_write(bram_addr_write),
-        .addr_read(addr_read),
-        .data_in(bram_data_write),
-        .data_out(data_out)
-    );
+    generate
+        if (CLEAR_ON_READ != 0) begin : g_clear_on_read
+            bram_tdp #(
+                .WIDTH(WIDTH),
+                .DEPTH(DEPTH),
+                .FILE(FILE)
+            ) bram_tdp_inst (
+                .clk_write(clk_write),
+                .clk_read(clk_read),
+                .write_enable(bram_write_en),
+                .addr_write(bram_addr_write),
+                .addr_read(addr_read),
+                .data_in(bram_data_write),
+                .data_out(data_out),
+
+                .read_write_enable(read_clear),
+                .read_data_in(clear_value)
+            );
+        end else begin : g_read_only
+            bram_dp #(
+                .WIDTH(WIDTH),
+                .DEPTH(DEPTH),
+                .FILE(FILE)
+            ) bram_dp_inst (
+                .clk_write(clk_write),
+                .clk_read(clk_read),
+                .write_enable(bram_write_en),
+                .addr_write(bram_addr_write),
+                .addr_read(addr_read),
+                .data_in(bram_data_write),
+                .data_out(data_out)
+            );
+        end
+    endgenerate
 
     // State Machine for controlling the clear logic
     always_ff @(posedge clk_write) begin
@@ -75,10 +101,11 @@ module buffer #(
                 if (clear) begin
                     state <= CLEARING;
                     clear_counter <= 0;
+                    r_clear_length <= clear_length;
                 end
             end
             CLEARING: begin
-                if (clear_counter < ADDR_WIDTH'(DEPTH - 1)) begin
+                if (LENGTH_WIDTH'(clear_counter) + 1 < r_clear_length) begin
                     clear_counter <= clear_counter + 1;
                 end else begin
                     state <= IDLE;
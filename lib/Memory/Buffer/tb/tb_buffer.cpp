@@ -1,4 +1,3 @@
-#include <deque>
 #include <stdlib.h>
 #include <iostream>
 #include <cstdlib>
@@ -6,67 +5,131 @@
 #include <verilated_vcd_c.h>
 #include "obj_dir/Vbuffer.h"
 
-#define MAX_SIM_TIME 300
 #define FB_WIDTH 8
 #define FB_HEIGHT 4
 #define DATA_WIDTH 4
 #define FB_SIZE FB_WIDTH*FB_HEIGHT
+#define PARTIAL_CLEAR_LENGTH 20
 
 vluint64_t sim_time = 0;
-vluint64_t posedge_cnt_write = 0;
 
+Vbuffer* dut;
+VerilatedVcdC* m_trace;
+int errors = 0;
+int expected[FB_SIZE];
+
+// One cycle of both clocks, the inputs are taken at the rising edge
+void tick() {
+    dut->clk_write = 1;
+    dut->clk_read = 1;
+    dut->eval();
+    m_trace->dump(sim_time++);
+
+    dut->clk_write = 0;
+    dut->clk_read = 0;
+    dut->eval();
+    m_trace->dump(sim_time++);
+}
+
+void write(int addr, int data) {
+    dut->addr_write = addr;
+    dut->data_in = data;
+    dut->write_enable = 1;
+    tick();
+    dut->write_enable = 0;
+    expected[addr] = data;
+}
+
+int read(int addr, bool clear) {
+    dut->addr_read = addr;
+    dut->read_clear = clear;
+    tick();
+    dut->read_clear = 0;
+    return dut->data_out;
+}
+
+void clear(int length) {
+    dut->clear_length = length;
+    dut->clear = 1;
+    tick();
+    dut->clear = 0;
+    while (!dut->ready) {
+        tick();
+    }
+    for (int i = 0; i < length; i++) {
+        expected[i] = dut->clear_value;
+    }
+}
+
+void check_all(const char* test) {
+    for (int i = 0; i < FB_SIZE; i++) {
+        int data = read(i, false);
+        if (data != expected[i]) {
+            printf("Error: %s: address %d: expected %d, got %d\n", test, i, expected[i], data);
+            errors++;
+        }
+    }
+}
+
+void fill() {
+    for (int i = 0; i < FB_SIZE; i++) {
+        // Never the clear value, so a clear is always visible
+        write(i, (dut->clear_value + 1 + rand() % ((1 << DATA_WIDTH) - 1)) % (1 << DATA_WIDTH));
+    }
+}
 
 int main(int argc, char** argv) {
     srand(time(NULL));
     Verilated::commandArgs(argc, argv);
 
-    Vbuffer* dut = new Vbuffer;
+    dut = new Vbuffer;
 
     Verilated::traceEverOn(true);
-    VerilatedVcdC* m_trace = new VerilatedVcdC;
+    m_trace = new VerilatedVcdC;
     dut->trace(m_trace, 5);
     m_trace->open("waveform.vcd");
 
+    dut->clk_write = 0;
+    dut->clk_read = 0;
+    dut->write_enable = 0;
+    dut->clear = 0;
+    dut->read_clear = 0;
     dut->addr_read = 0;
+    dut->addr_write = 0;
+    dut->data_in = 0;
     dut->clear_value = rand() % (1 << DATA_WIDTH);
-
-    while (sim_time < MAX_SIM_TIME) {
-        dut->clk_write ^= 1;
-        dut->clk_read ^= 1;
-        dut->eval();
-
-
-        if (dut->clk_write == 1) {
-            posedge_cnt_write++;
-
-            dut->clear = 1;
-            if (posedge_cnt_write > 1) {
-                dut->clear = 0;
-            }
-
-            dut->addr_read += 1; 
-
-            if (posedge_cnt_write >= FB_SIZE*2 - 1) {
-                dut->addr_write = (dut->addr_read + 1);
-                if (dut->addr_write >= FB_SIZE) {
-                    dut->addr_write -= FB_SIZE;
-                } 
-                dut->data_in = rand() % (1 << DATA_WIDTH);
-                dut->write_enable = 1; 
-            }
-            
-            if (dut->addr_read == FB_SIZE) {
-                dut->addr_read = 0;
-            }
+    dut->clear_length = FB_SIZE;
+    dut->eval();
+
+    // Full clear
+    clear(FB_SIZE);
+    check_all("full clear");
+
+    // Written data reads back
+    fill();
+    check_all("write");
+
+    // A partial clear leaves the addresses above clear_length untouched
+    clear(PARTIAL_CLEAR_LENGTH);
+    check_all("partial clear");
+
+    // A read with read_clear returns the old value and leaves the clear
+    // value behind. Every other address is cleared on read.
+    fill();
+    for (int i = 0; i < FB_SIZE; i += 2) {
+        int data = read(i, true);
+        if (data != expected[i]) {
+            printf("Error: read clear: address %d: expected %d, got %d\n", i, expected[i], data);
+            errors++;
         }
-
-        m_trace->dump(sim_time);
-        sim_time++;
+        expected[i] = dut->clear_value;
     }
+    check_all("after read clear");
 
     m_trace->close();
+    printf("%s: %d errors\n", errors ? "FAILED" : "PASSED", errors);
 
     delete dut;
 
-    exit(EXIT_SUCCESS);
+    exit(errors ? EXIT_FAILURE : EXIT_SUCCESS);
 }
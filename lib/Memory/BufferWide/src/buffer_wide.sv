@@ -0,0 +1,149 @@
+// Buffer with words of several pixels and a write enable per pixel, such that
+// a span of pixels can be written in one cycle and a scanout reads a word once
+// for PIXELS_PER_WORD pixels. Otherwise the same as buffer: a clear state
+// machine, and optionally a read port that clears what it reads, a whole word
+// at a time.
+//
+// Vivado maps 8 or 9 bit pixels onto the native byte write enables. Narrower
+// pixels are split into one BRAM column per pixel.
+
+module buffer_wide #(
+    parameter unsigned PIXEL_WIDTH = 4,
+    parameter unsigned PIXELS_PER_WORD = 8,
+    parameter unsigned DEPTH = 32,                  // In words
+    parameter string FILE = "",
+    parameter unsigned CLEAR_ON_READ = 0,           // Allow the read port to clear the words it reads
+    parameter unsigned WORD_WIDTH = PIXEL_WIDTH * PIXELS_PER_WORD,
+    parameter unsigned ADDR_WIDTH = $clog2(DEPTH),
+    parameter unsigned LENGTH_WIDTH = $clog2(DEPTH + 1)
+) (
+    input logic clk_write,
+    input logic clk_read,
+
+    input logic write_enable,
+    input logic [PIXELS_PER_WORD-1:0] pixel_enable,     // Pixels of data_in that are written
+    input logic clear,
+    output logic ready,
+
+    input logic [ADDR_WIDTH-1:0] addr_write,
+    input logic [ADDR_WIDTH-1:0] addr_read,
+    input logic read_enable,                        // (clk_read) Otherwise data_out holds the last word read
+
+    input logic [PIXEL_WIDTH-1:0] clear_value,
+    input logic [LENGTH_WIDTH-1:0] clear_length,    // Number of words, from address 0, to clear
+    input logic read_clear,                         // (clk_read) Overwrite addr_read with clear_value
+    input logic [WORD_WIDTH-1:0] data_in,           // Pixel 0 in the lowest bits
+    output logic [WORD_WIDTH-1:0] data_out
+);
+
+    // State Machine States
+    typedef enum logic {
+        IDLE,               // Idle state, normal operation
+        CLEARING            // Clearing state, clearing the buffer
+    } state_t;
+    state_t state = IDLE;
+
+    logic [ADDR_WIDTH-1:0] clear_counter;
+    logic [LENGTH_WIDTH-1:0] r_clear_length;
+
+    logic [ADDR_WIDTH-1:0] bram_addr_write;
+    logic [WORD_WIDTH-1:0] bram_data_write;
+    logic [PIXELS_PER_WORD-1:0] bram_pixel_enable;
+    logic bram_write_en;
+
+    always_comb begin
+        ready = 1'b0;
+
+        case (state)
+            IDLE: begin
+                bram_addr_write = addr_write;
+                bram_data_write = data_in;
+                bram_pixel_enable = pixel_enable;
+                bram_write_en = write_enable;
+                ready = 1'b1;
+            end
+
+            CLEARING: begin
+                bram_addr_write = clear_counter;
+                bram_data_write = {PIXELS_PER_WORD{clear_value}};
+                bram_pixel_enable = '1;
+                bram_write_en = LENGTH_WIDTH'(clear_counter) < r_clear_length;
+            end
+
+            default: begin
+            end
+        endcase
+    end
+
+    logic [WORD_WIDTH-1:0] memory [DEPTH];
+
+    initial begin
+        if (FILE != "") begin
+            $readmemh(FILE, memory);
+        end
+    end
+
+    generate
+        if (CLEAR_ON_READ != 0) begin : g_clear_on_read
+            // Both ports write the same memory, which is what makes Vivado
+            // infer a true dual-port BRAM. Can therefore not use always_ff here.
+            /* verilator lint_off MULTIDRIVEN */
+            always @(posedge clk_write) begin
+                for (int i = 0; i < PIXELS_PER_WORD; i++) begin
+                    if (bram_write_en && bram_pixel_enable[i]) begin
+                        memory[bram_addr_write][i*PIXEL_WIDTH +: PIXEL_WIDTH] <= bram_data_write[i*PIXEL_WIDTH +: PIXEL_WIDTH];
+                    end
+                end
+            end
+
+            always @(posedge clk_read) begin
+                if (read_enable) begin
+                    data_out <= memory[addr_read];
+                end
+                if (read_clear) begin
+                    memory[addr_read] <= {PIXELS_PER_WORD{clear_value}};
+                end
+            end
+            /* verilator lint_on MULTIDRIVEN */
+        end else begin : g_read_only
+            always_ff @(posedge clk_write) begin
+                for (int i = 0; i < PIXELS_PER_WORD; i++) begin
+                    if (bram_write_en && bram_pixel_enable[i]) begin
+                        memory[bram_addr_write][i*PIXEL_WIDTH +: PIXEL_WIDTH] <= bram_data_write[i*PIXEL_WIDTH +: PIXEL_WIDTH];
+                    end
+                end
+            end
+
+            always_ff @(posedge clk_read) begin
+                if (read_enable) begin
+                    data_out <= memory[addr_read];
+                end
+            end
+        end
+    endgenerate
+
+    // State Machine for controlling the clear logic
+    always_ff @(posedge clk_write) begin
+        case (state)
+            IDLE: begin
+                if (clear) begin
+                    state <= CLEARING;
+                    clear_counter <= 0;
+                    r_clear_length <= clear_length;
+                end
+            end
+            CLEARING: begin
+                if (LENGTH_WIDTH'(clear_counter) + 1 < r_clear_length) begin
+                    clear_counter <= clear_counter + 1;
+                end else begin
+                    state <= IDLE;
+                end
+            end
+
+            default: begin
+                state <= IDLE;
+            end
+        endcase
+    end
+
+endmodule
@@ -0,0 +1,141 @@
+#include <stdlib.h>
+#include <stdint.h>
+#include <cstdlib>
+#include <verilated.h>
+#include <verilated_vcd_c.h>
+#include "obj_dir/Vbuffer_wide.h"
+
+// Must match the makefile
+#define PIXEL_WIDTH 4
+#define PIXELS_PER_WORD 8
+#define DEPTH 16
+
+#define NUM_WRITES 200
+#define MAX_SIM_TIME (2 * (DEPTH + NUM_WRITES + 2 * DEPTH + 8))
+
+vluint64_t sim_time = 0;
+vluint64_t posedge_cnt = 0;
+
+// Write data into word with a per pixel enable
+uint32_t merge(uint32_t word, uint32_t data, uint32_t enable) {
+    for (int i = 0; i < PIXELS_PER_WORD; i++) {
+        if (enable & (1u << i)) {
+            uint32_t mask = ((1u << PIXEL_WIDTH) - 1) << (i * PIXEL_WIDTH);
+            word = (word & ~mask) | (data & mask);
+        }
+    }
+    return word;
+}
+
+int main(int argc, char** argv) {
+    srand(time(NULL));
+    Verilated::commandArgs(argc, argv);
+
+    Vbuffer_wide* dut = new Vbuffer_wide;
+
+    Verilated::traceEverOn(true);
+    VerilatedVcdC* m_trace = new VerilatedVcdC;
+    dut->trace(m_trace, 5);
+    m_trace->open("waveform.vcd");
+
+    uint32_t clear_value = rand() % (1 << PIXEL_WIDTH);
+    uint32_t memory[DEPTH];
+    for (int i = 0; i < DEPTH; i++) {
+        memory[i] = 0;
+        for (int p = 0; p < PIXELS_PER_WORD; p++) {
+            memory[i] |= clear_value << (p * PIXEL_WIDTH);
+        }
+    }
+
+    dut->clk_write = 0;
+    dut->clk_read = 0;
+    dut->clear_value = clear_value;
+    dut->clear_length = DEPTH;
+    dut->read_clear = 0;
+    dut->read_enable = 0;
+    dut->write_enable = 0;
+    dut->clear = 0;
+
+    int writes = 0;
+    int reads = 0;
+    int read_addr_prev = -1;
+    uint32_t read_word = 0;     // Last word read, held while read_enable is low
+    bool read_hold = false;
+    bool read_held = false;
+    int errors = 0;
+
+    while (sim_time < MAX_SIM_TIME) {
+        dut->clk_write ^= 1;
+        dut->clk_read ^= 1;
+        dut->eval();
+
+        if (dut->clk_write == 1) {
+            posedge_cnt++;
+
+            // Check the read issued at the previous edge
+            if (read_addr_prev >= 0) {
+                if (dut->data_out != memory[read_addr_prev]) {
+                    printf("Error: word %d: expected %08x, got %08x\n",
+                           read_addr_prev, memory[read_addr_prev], dut->data_out);
+                    errors++;
+                }
+                read_word = memory[read_addr_prev];
+                read_addr_prev = -1;
+            } else if (read_hold) {
+                if (dut->data_out != read_word) {
+                    printf("Error: read data not held: expected %08x, got %08x\n",
+                           read_word, dut->data_out);
+                    errors++;
+                }
+                read_hold = false;
+            }
+
+            dut->clear = (posedge_cnt == 1);
+            dut->write_enable = 0;
+            dut->read_enable = 0;
+
+            if (posedge_cnt > 1 && dut->ready && writes < NUM_WRITES) {
+                // Random span
+                uint32_t data = ((uint32_t)rand() << 16) ^ rand();
+                uint32_t enable = rand() % (1 << PIXELS_PER_WORD);
+                int addr = rand() % DEPTH;
+
+                dut->addr_write = addr;
+                dut->data_in = data;
+                dut->pixel_enable = enable;
+                dut->write_enable = 1;
+                memory[addr] = merge(memory[addr], data, enable);
+                writes++;
+            } else if (writes == NUM_WRITES && reads < DEPTH) {
+                // A cycle without a read, on another address, before every
+                // second read
+                if (reads % 2 == 1 && !read_held) {
+                    dut->addr_read = (reads + 1) % DEPTH;
+                    read_hold = true;
+                    read_held = true;
+                } else {
+                    dut->addr_read = reads;
+                    dut->read_enable = 1;
+                    read_addr_prev = reads;
+                    read_held = false;
+                    reads++;
+                }
+            }
+        }
+
+        m_trace->dump(sim_time);
+        sim_time++;
+    }
+
+    if (reads != DEPTH) {
+        printf("Error: only %d of %d words read\n", reads, DEPTH);
+        errors++;
+    }
+
+    m_trace->close();
+    printf("%s: %d errors\n", errors ? "FAILED" : "PASSED", errors);
+
+    delete dut;
+
+    exit(errors ? EXIT_FAILURE : EXIT_SUCCESS);
+}
@@ -1,4 +1,5 @@
-// Syncronous FIFO Module
+// Syncronous FIFO Module. The pointers are binary, so both clocks must be
+// the same clock. Use async_fifo to cross between clock domains.
 
 `timescale 1ns/1ps
 
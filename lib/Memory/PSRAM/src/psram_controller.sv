@@ -0,0 +1,304 @@
+// Controller for a quad SPI PSRAM, like the APS6404L (64 Mbit)
+//
+// After power up the PSRAM is switched to QPI mode, where commands,
+// addresses and data all use the four SIO lines. Reads use Fast Quad Read
+// (EBh) with READ_WAIT_CYCLES wait cycles, writes use Quad Write (38h).
+//
+// sclk is clk / 2. The outputs change on the falling edge of sclk, and the
+// PSRAM samples them on the rising edge. Read data is sampled one clk after
+// the rising edge, together with the next falling edge, which leaves the
+// whole sclk period for the PSRAM output delay.
+//
+// A burst must stay inside one 1 KiB page, and is limited by the maximum
+// CE# low time of the PSRAM, 8 us for the APS6404L.
+
+`timescale 1ns / 1ps
+
+module psram_controller #(
+    parameter unsigned ADDR_WIDTH = 23,         // 8 MiB
+    parameter unsigned LENGTH_WIDTH = 6,        // Bursts of up to 2^LENGTH_WIDTH - 1 bytes
+    parameter unsigned READ_WAIT_CYCLES = 6,    // 1 to 15
+    parameter unsigned INIT_CYCLES = 15000,     // 150 us power up at 100 MHz
+    parameter unsigned DESELECT_CYCLES = 4      // CE# high between bursts, 1 to 16
+    ) (
+    input logic clk,
+    input logic rstn,
+
+    output logic ready,                         // A request is taken when ready
+
+    input logic i_read,
+    input logic i_write,
+    input logic [ADDR_WIDTH-1:0] i_addr,        // Byte address
+    input logic [LENGTH_WIDTH-1:0] i_length,    // Bytes, at least 1
+
+    output logic [7:0] o_read_data,
+    output logic o_read_dv,
+
+    // i_write_data is taken when o_write_next is set, and the next byte has
+    // to be there before it is taken again, four cycles later
+    input logic [7:0] i_write_data,
+    output logic o_write_next,
+
+    // PSRAM pins, the SIO tristate buffers are in the top
+    output logic o_psram_ce_n,
+    output logic o_psram_sclk,
+    output logic [3:0] o_psram_sio,
+    output logic [3:0] o_psram_sio_oe,
+    input logic [3:0] i_psram_sio
+    );
+
+    localparam logic [7:0] CMD_ENTER_QPI = 8'h35;
+    localparam logic [7:0] CMD_EXIT_QPI = 8'hF5;
+    localparam logic [7:0] CMD_QUAD_READ = 8'hEB;
+    localparam logic [7:0] CMD_QUAD_WRITE = 8'h38;
+
+    localparam unsigned INIT_COUNT_WIDTH = $clog2(INIT_CYCLES + 1);
+
+    typedef enum logic [2:0] {
+        INIT_WAIT,
+        IDLE,
+        COMMAND,
+        READ_WAIT,
+        READ_DATA,
+        WRITE_DATA,
+        DESELECT
+    } state_t;
+    state_t current_state = INIT_WAIT, next_state;
+
+    typedef enum logic [1:0] {
+        OP_INIT,
+        OP_READ,
+        OP_WRITE
+    } op_t;
+    op_t r_op;
+
+    logic [INIT_COUNT_WIDTH-1:0] r_init_cnt;
+    logic [1:0] r_init_step;            // 0: Exit QPI, 1: Enter QPI, 2: Done
+
+    // Command and address, shifted out MSB first
+    /* verilator lint_off UNUSED */
+    logic [31:0] r_shift;
+    /* verilator lint_on UNUSED */
+    logic r_spi;                        // One bit per sclk on SIO0, else one nibble
+    logic [3:0] r_periods;              // sclk periods of the command
+    logic [3:0] r_count;
+
+    logic [LENGTH_WIDTH:0] r_nibbles;   // Data nibbles left after the current one
+    logic [3:0] r_read_high;
+    logic [3:0] r_write_low;
+
+    // The next command, from IDLE
+    logic [31:0] w_shift;
+    logic w_spi;
+    logic [3:0] w_periods;
+    always_comb begin
+        if (r_init_step == 2'd0) begin
+            // In case the PSRAM is still in QPI mode from before a reconfiguration.
+            // In SPI mode this is an incomplete command, which is dropped.
+            w_shift = {CMD_EXIT_QPI, 24'h0};
+            w_spi = 1'b0;
+            w_periods = 4'd2;
+        end else if (r_init_step == 2'd1) begin
+            w_shift = {CMD_ENTER_QPI, 24'h0};
+            w_spi = 1'b1;
+            w_periods = 4'd8;
+        end else begin
+            w_shift = {i_write ? CMD_QUAD_WRITE : CMD_QUAD_READ, 24'(i_addr)};
+            w_spi = 1'b0;
+            w_periods = 4'd8;
+        end
+    end
+
+    // Outputs change with the falling edge of sclk
+    logic w_fall;
+    assign w_fall = o_psram_sclk;
+
+    always_ff @(posedge clk) begin
+        if (~rstn) begin
+            current_state <= INIT_WAIT;
+        end else begin
+            current_state <= next_state;
+        end
+    end
+
+    always_comb begin
+        next_state = current_state;
+        ready = 1'b0;
+
+        case (current_state)
+            INIT_WAIT: begin
+                if (r_init_cnt == INIT_COUNT_WIDTH'(INIT_CYCLES - 1)) begin
+                    next_state = IDLE;
+                end
+            end
+
+            IDLE: begin
+                ready = (r_init_step == 2'd2);
+                if (r_init_step != 2'd2 || i_read || i_write) begin
+                    next_state = COMMAND;
+                end
+            end
+
+            COMMAND: begin
+                if (w_fall && r_count == r_periods - 4'd1) begin
+                    case (r_op)
+                        OP_READ: next_state = READ_WAIT;
+                        OP_WRITE: next_state = WRITE_DATA;
+                        default: next_state = DESELECT;
+                    endcase
+                end
+            end
+
+            READ_WAIT: begin
+                if (w_fall && r_count == 4'(READ_WAIT_CYCLES - 1)) begin
+                    next_state = READ_DATA;
+                end
+            end
+
+            READ_DATA, WRITE_DATA: begin
+                if (w_fall && r_nibbles == '0) begin
+                    next_state = DESELECT;
+                end
+            end
+
+            DESELECT: begin
+                if (r_count == 4'(DESELECT_CYCLES - 1)) begin
+                    next_state = IDLE;
+                end
+            end
+
+            default: begin
+                next_state = IDLE;
+            end
+        endcase
+    end
+
+    always_ff @(posedge clk) begin
+        if (~rstn) begin
+            r_init_cnt <= '0;
+            r_init_step <= '0;
+            r_count <= '0;
+
+            o_psram_ce_n <= 1'b1;
+            o_psram_sclk <= 1'b0;
+            o_psram_sio <= '0;
+            o_psram_sio_oe <= '0;
+
+            o_read_dv <= 1'b0;
+            o_write_next <= 1'b0;
+        end else begin
+            o_read_dv <= 1'b0;
+            o_write_next <= 1'b0;
+
+            case (current_state)
+                INIT_WAIT: begin
+                    r_init_cnt <= r_init_cnt + 1;
+                end
+
+                IDLE: begin
+                    r_count <= '0;
+
+                    if (next_state == COMMAND) begin
+                        if (r_init_step != 2'd2) begin
+                            r_op <= OP_INIT;
+                            r_init_step <= r_init_step + 1;
+                        end else begin
+                            r_op <= i_write ? OP_WRITE : OP_READ;
+                        end
+                        r_shift <= w_shift;
+                        r_spi <= w_spi;
+                        r_periods <= w_periods;
+                        r_nibbles <= {i_length, 1'b0} - 1;
+
+                        o_psram_ce_n <= 1'b0;
+                        o_psram_sio <= w_spi ? {3'b0, w_shift[31]} : w_shift[31:28];
+                        o_psram_sio_oe <= w_spi ? 4'b0001 : 4'b1111;
+                    end
+                end
+
+                COMMAND: begin
+                    o_psram_sclk <= ~o_psram_sclk;
+
+                    if (w_fall) begin
+                        if (r_count == r_periods - 4'd1) begin
+                            r_count <= '0;
+
+                            case (r_op)
+                                OP_READ: begin
+                                    o_psram_sio_oe <= '0;
+                                end
+
+                                OP_WRITE: begin
+                                    o_psram_sio <= i_write_data[7:4];
+                                    r_write_low <= i_write_data[3:0];
+                                    o_write_next <= 1'b1;
+                                end
+
+                                default: begin
+                                end
+                            endcase
+                        end else begin
+                            r_count <= r_count + 1;
+                            if (r_spi) begin
+                                r_shift <= r_shift << 1;
+                                o_psram_sio <= {3'b0, r_shift[30]};
+                            end else begin
+                                r_shift <= r_shift << 4;
+                                o_psram_sio <= r_shift[27:24];
+                            end
+                        end
+                    end
+                end
+
+                READ_WAIT: begin
+                    o_psram_sclk <= ~o_psram_sclk;
+
+                    if (w_fall) begin
+                        r_count <= (next_state == READ_DATA) ? '0 : r_count + 1;
+                    end
+                end
+
+                READ_DATA: begin
+                    o_psram_sclk <= ~o_psram_sclk;
+
+                    // The nibble from the previous falling edge
+                    if (w_fall) begin
+                        if (r_nibbles[0]) begin
+                            r_read_high <= i_psram_sio;
+                        end else begin
+                            o_read_data <= {r_read_high, i_psram_sio};
+                            o_read_dv <= 1'b1;
+                        end
+                        r_nibbles <= r_nibbles - 1;
+                    end
+                end
+
+                WRITE_DATA: begin
+                    o_psram_sclk <= ~o_psram_sclk;
+
+                    if (w_fall && r_nibbles != '0) begin
+                        if (r_nibbles[0]) begin
+                            o_psram_sio <= r_write_low;
+                        end else begin
+                            o_psram_sio <= i_write_data[7:4];
+                            r_write_low <= i_write_data[3:0];
+                            o_write_next <= 1'b1;
+                        end
+                        r_nibbles <= r_nibbles - 1;
+                    end
+                end
+
+                DESELECT: begin
+                    o_psram_ce_n <= 1'b1;
+                    o_psram_sclk <= 1'b0;
+                    o_psram_sio_oe <= '0;
+                    r_count <= r_count + 1;
+                end
+
+                default: begin
+                end
+            endcase
+        end
+    end
+
+endmodule
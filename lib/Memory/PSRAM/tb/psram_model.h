@@ -0,0 +1,154 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+// Behavioural model of a quad SPI PSRAM like the APS6404L, driven by the
+// pins of psram_controller. Only the commands the controller uses are
+// supported: Enter QPI (35h) in SPI mode, and Exit QPI (F5h), Fast Quad
+// Read (EBh) and Quad Write (38h) in QPI mode. Bursts wrap inside their
+// 1 KiB page, like on the chip.
+//
+// update() has to be called after every eval, and returns the SIO lines
+// driven by the PSRAM.
+class PsramModel {
+public:
+    static const uint32_t PAGE_SIZE = 1024;
+
+    std::vector<uint8_t> mem;
+    bool qpi = false;
+    int errors = 0;
+    int num_reads = 0;
+    int num_writes = 0;
+
+    PsramModel(uint32_t size, int read_wait_cycles)
+        : mem(size, 0), read_wait_cycles(read_wait_cycles) {}
+
+    uint8_t update(bool ce_n, bool sclk, uint8_t sio, uint8_t sio_oe) {
+        if (ce_n) {
+            if (selected) {
+                deselect();
+            }
+            last_sclk = sclk;
+            return 0;
+        }
+        if (!selected) {
+            selected = true;
+            rises = 0;
+            cmd = 0;
+            addr = 0;
+            driving = false;
+        }
+
+        if (sclk && !last_sclk) {
+            rising_edge(sio & 0xF, sio_oe & 0xF);
+        } else if (!sclk && last_sclk) {
+            falling_edge();
+        }
+        last_sclk = sclk;
+
+        if (driving && (sio_oe & 0xF)) {
+            error("bus contention");
+        }
+        return driving ? out : 0;
+    }
+
+private:
+    int read_wait_cycles;
+
+    bool selected = false;
+    bool last_sclk = false;
+    int rises = 0;
+    uint8_t cmd = 0;
+    uint32_t addr = 0;
+    uint8_t write_byte = 0;
+    bool driving = false;
+    uint8_t out = 0;
+
+    void error(const char* message) {
+        printf("PSRAM error: %s (cmd %02X, addr %06X, clock %d)\n", message, cmd, addr, rises);
+        errors++;
+    }
+
+    // Inside the page of the start address
+    uint32_t address(uint32_t offset) {
+        return ((addr & ~(PAGE_SIZE - 1)) | ((addr + offset) & (PAGE_SIZE - 1))) % mem.size();
+    }
+
+    void rising_edge(uint8_t sio, uint8_t sio_oe) {
+        int r = rises++;
+
+        if (!qpi) {
+            if (r < 8) {
+                if (!(sio_oe & 1)) {
+                    error("SI not driven");
+                }
+                cmd = (cmd << 1) | (sio & 1);
+                if (r == 7 && cmd != 0x35) {
+                    error("unsupported SPI command");
+                }
+            }
+            return;
+        }
+
+        // Command and address, one nibble per clock
+        if (r < 8) {
+            if (sio_oe != 0xF) {
+                error("command not driven");
+            }
+            if (r < 2) {
+                cmd = (cmd << 4) | sio;
+                if (r == 1 && cmd != 0xF5 && cmd != 0xEB && cmd != 0x38) {
+                    error("unsupported QPI command");
+                }
+            } else {
+                addr = (addr << 4) | sio;
+            }
+            return;
+        }
+
+        if (cmd == 0x38) {
+            if (sio_oe != 0xF) {
+                error("write data not driven");
+            }
+            int nibble = r - 8;
+            if (nibble % 2 == 0) {
+                write_byte = sio << 4;
+            } else {
+                mem[address(nibble / 2)] = write_byte | sio;
+            }
+        }
+    }
+
+    // Read data is put out after the falling edge, nibble k after rising
+    // edge 8 + wait + k - 1
+    void falling_edge() {
+        if (!qpi || cmd != 0xEB || rises < 8 + read_wait_cycles) {
+            return;
+        }
+        int nibble = rises - 8 - read_wait_cycles;
+        uint8_t byte = mem[address(nibble / 2)];
+        out = (nibble % 2 == 0) ? (byte >> 4) : (byte & 0xF);
+        driving = true;
+    }
+
+    void deselect() {
+        if (!qpi && rises == 8 && cmd == 0x35) {
+            qpi = true;
+        } else if (qpi && rises == 2 && cmd == 0xF5) {
+            qpi = false;
+        } else if (qpi && rises >= 8 && cmd == 0xEB) {
+            num_reads++;
+        } else if (qpi && rises >= 8 && cmd == 0x38) {
+            num_writes++;
+            if ((rises - 8) % 2 != 0) {
+                error("write of half a byte");
+            }
+        } else if (qpi && rises > 0) {
+            error("incomplete command");
+        }
+        selected = false;
+        driving = false;
+    }
+};
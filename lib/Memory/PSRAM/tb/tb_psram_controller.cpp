@@ -0,0 +1,159 @@
+#include <stdlib.h>
+#include <cstdlib>
+#include <cstdint>
+#include <algorithm>
+#include <vector>
+#include <verilated.h>
+#include <verilated_vcd_c.h>
+#include "obj_dir/Vpsram_controller.h"
+#include "psram_model.h"
+
+#ifndef LENGTH_WIDTH
+#define LENGTH_WIDTH 6
+#endif
+#ifndef READ_WAIT_CYCLES
+#define READ_WAIT_CYCLES 6
+#endif
+
+#define MEM_SIZE (1 << 23)
+#define MAX_LENGTH ((1 << LENGTH_WIDTH) - 1)
+
+// Only a few pages, so reads mostly hit written data
+#define TEST_PAGES 4
+
+#define RESET_CLKS 8
+#define NUM_BURSTS 500
+#define MAX_SIM_TIME (2 * NUM_BURSTS * (4 * MAX_LENGTH + 64))
+
+vluint64_t sim_time = 0;
+vluint64_t posedge_cnt = 0;
+
+int main(int argc, char** argv) {
+    srand(time(NULL));
+    Verilated::commandArgs(argc, argv);
+
+    Vpsram_controller* dut = new Vpsram_controller;
+    PsramModel psram(MEM_SIZE, READ_WAIT_CYCLES);
+
+    Verilated::traceEverOn(true);
+    VerilatedVcdC* m_trace = new VerilatedVcdC;
+    dut->trace(m_trace, 5);
+    m_trace->open("waveform.vcd");
+
+    // The PSRAM starts with random contents, a copy is kept of what it
+    // should hold
+    for (uint32_t i = 0; i < MEM_SIZE; i++) {
+        psram.mem[i] = rand() & 0xFF;
+    }
+    std::vector<uint8_t> expected_mem = psram.mem;
+
+    dut->clk = 0;
+    dut->rstn = 0;
+    dut->i_read = 0;
+    dut->i_write = 0;
+    dut->i_addr = 0;
+    dut->i_length = 0;
+    dut->i_write_data = 0;
+    dut->i_psram_sio = 0;
+
+    // Random reads and writes of random length, each inside one page. The
+    // bytes read must match the copy, and so must the whole PSRAM at the
+    // end.
+    int errors = 0;
+    int num_bursts = 0;
+    int num_read_bytes = 0;
+    bool busy = false;
+    bool reading = false;
+    uint32_t burst_addr = 0;
+    int burst_length = 0;
+    int burst_pos = 0;
+    while (sim_time < MAX_SIM_TIME) {
+        dut->clk ^= 1;
+        dut->eval();
+        dut->i_psram_sio = psram.update(dut->o_psram_ce_n, dut->o_psram_sclk,
+                                        dut->o_psram_sio, dut->o_psram_sio_oe);
+
+        if (dut->clk == 1) {
+            posedge_cnt++;
+            dut->rstn = posedge_cnt > RESET_CLKS;
+            dut->i_read = 0;
+            dut->i_write = 0;
+
+            if (reading && dut->o_read_dv) {
+                uint8_t expected = expected_mem[burst_addr + burst_pos];
+                if (dut->o_read_data != expected) {
+                    printf("Error: read %06X: expected %02X, got %02X\n",
+                           burst_addr + burst_pos, expected, dut->o_read_data);
+                    errors++;
+                }
+                burst_pos++;
+                num_read_bytes++;
+            }
+
+            if (!reading && dut->o_write_next) {
+                burst_pos++;
+            }
+            if (!reading && burst_pos < burst_length) {
+                dut->i_write_data = expected_mem[burst_addr + burst_pos];
+            }
+
+            if (busy && dut->ready) {
+                if (burst_pos != burst_length) {
+                    printf("Error: burst %06X: %d of %d bytes\n", burst_addr, burst_pos, burst_length);
+                    errors++;
+                }
+                busy = false;
+                num_bursts++;
+                if (num_bursts == NUM_BURSTS) {
+                    break;
+                }
+            }
+
+            if (!busy && dut->rstn && dut->ready && rand() % 4 == 0) {
+                uint32_t page = rand() % TEST_PAGES;
+                uint32_t offset = rand() % PsramModel::PAGE_SIZE;
+                burst_addr = page * PsramModel::PAGE_SIZE + offset;
+                burst_length = 1 + rand() % std::min<uint32_t>(MAX_LENGTH, PsramModel::PAGE_SIZE - offset);
+                burst_pos = 0;
+                reading = rand() % 2;
+                busy = true;
+
+                dut->i_addr = burst_addr;
+                dut->i_length = burst_length;
+                if (reading) {
+                    dut->i_read = 1;
+                } else {
+                    dut->i_write = 1;
+                    for (int i = 0; i < burst_length; i++) {
+                        expected_mem[burst_addr + i] = rand() & 0xFF;
+                    }
+                    dut->i_write_data = expected_mem[burst_addr];
+                }
+            }
+        }
+
+        m_trace->dump(sim_time);
+        sim_time++;
+    }
+
+    if (num_bursts != NUM_BURSTS || num_read_bytes == 0) {
+        printf("Error: %d of %d bursts, %d bytes read\n", num_bursts, NUM_BURSTS, num_read_bytes);
+        errors++;
+    }
+    if (psram.mem != expected_mem) {
+        printf("Error: PSRAM contents differ\n");
+        errors++;
+    }
+    if (!psram.qpi) {
+        printf("Error: PSRAM not in QPI mode\n");
+        errors++;
+    }
+    errors += psram.errors;
+
+    m_trace->close();
+    printf("%s: %d errors\n", errors ? "FAILED" : "PASSED", errors);
+
+    delete dut;
+
+    exit(errors ? EXIT_FAILURE : EXIT_SUCCESS);
+}
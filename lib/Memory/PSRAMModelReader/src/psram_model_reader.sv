@@ -0,0 +1,438 @@
+// Model reader with the faces and vertices in external PSRAM
+//
+// Same interface and header ROM as model_reader, but the face and vertex
+// data is streamed from PSRAM instead of on-chip ROMs, so the models are
+// only limited by the 8 MiB of the PSRAM. Face i is at byte address
+// PSRAM_FACES_ADDR + i * INDEX_BYTES and vertex i at PSRAM_VERTEX_ADDR +
+// i * VERTEX_BYTES, each element packed like a line of the ROM files and
+// stored MSB first.
+//
+// Each stream has a prefetch FIFO, which is refilled with burst reads of
+// up to BURST_BYTES while there is room for a whole burst. The two streams
+// take turns on the PSRAM. Bursts are split at the 1 KiB PSRAM pages.
+
+`timescale 1ns / 1ps
+
+/* verilator lint_off PINCONNECTEMPTY */
+module psram_model_reader #(
+    parameter integer MODEL_INDEX_WIDTH = 4,
+    parameter integer INDEX_ADDR_WIDTH = 15,
+    parameter integer VERTEX_ADDR_WIDTH = 15,
+    parameter integer COORDINATE_WIDTH = 24,
+    parameter string  MODEL_HEADER_FILE = "model_headers.mem",
+
+    parameter integer PSRAM_ADDR_WIDTH = 23,
+    parameter integer PSRAM_FACES_ADDR = 'h000000,
+    parameter integer PSRAM_VERTEX_ADDR = 'h400000,
+    parameter integer PSRAM_INIT_CYCLES = 15000,
+    parameter integer BURST_BYTES = 32,
+    parameter integer FIFO_DEPTH = 16               // Power of two, larger than a burst of elements
+)(
+    input  logic                             clk,
+    input  logic                             rstn,  // Also initializes the PSRAM
+    input  logic                             reset, // Starts reading model_index
+    output logic                             ready,
+
+    input  logic [MODEL_INDEX_WIDTH-1:0]     model_index,
+
+    input  logic                             index_read_en,
+    input  logic                             vertex_read_en,
+
+    output logic [INDEX_ADDR_WIDTH-1:0]         index_data[3],
+    output logic signed [COORDINATE_WIDTH-1:0]  vertex_data[3],
+
+    output logic                             index_o_dv,
+    output logic                             vertex_o_dv,
+    output logic                             index_data_last,
+    output logic                             vertex_data_last,
+
+    // PSRAM pins
+    output logic                             o_psram_ce_n,
+    output logic                             o_psram_sclk,
+    output logic [3:0]                       o_psram_sio,
+    output logic [3:0]                       o_psram_sio_oe,
+    input  logic [3:0]                       i_psram_sio
+);
+
+    localparam integer VERTEX_DATA_WIDTH = COORDINATE_WIDTH * 3;
+    localparam integer INDEX_DATA_WIDTH = INDEX_ADDR_WIDTH * 3;
+    localparam integer HEADER_DATA_WIDTH = INDEX_ADDR_WIDTH + VERTEX_ADDR_WIDTH;
+
+    localparam integer INDEX_BYTES = (INDEX_DATA_WIDTH + 7) / 8;
+    localparam integer VERTEX_BYTES = (VERTEX_DATA_WIDTH + 7) / 8;
+    localparam integer INDEX_BYTE_CNT_WIDTH = $clog2(INDEX_BYTES);
+    localparam integer VERTEX_BYTE_CNT_WIDTH = $clog2(VERTEX_BYTES);
+
+    // Most elements completed by one burst, which can start with a part of one
+    localparam integer INDEX_BURST_ELEMENTS = (BURST_BYTES + INDEX_BYTES - 1) / INDEX_BYTES;
+    localparam integer VERTEX_BURST_ELEMENTS = (BURST_BYTES + VERTEX_BYTES - 1) / VERTEX_BYTES;
+
+    localparam integer LENGTH_WIDTH = $clog2(BURST_BYTES + 1);
+    localparam integer PAGE_WIDTH = 10;
+    localparam integer COUNT_WIDTH = $clog2(FIFO_DEPTH + 1);
+
+    logic [MODEL_INDEX_WIDTH-1:0] header_addr;
+    logic [HEADER_DATA_WIDTH-1:0] header_data;
+
+    // Header ROM
+    rom #(
+        .WIDTH(HEADER_DATA_WIDTH),
+        .DEPTH(1 << MODEL_INDEX_WIDTH),
+        .FILE(MODEL_HEADER_FILE)
+    ) headers_rom (
+        .clk(clk),
+        .addr(header_addr),
+        .data(header_data)
+    );
+
+    // ========== PSRAM ==========
+    logic w_psram_ready;
+    logic w_psram_read;
+    logic [PSRAM_ADDR_WIDTH-1:0] w_psram_addr;
+    logic [LENGTH_WIDTH-1:0] w_psram_length;
+    logic [7:0] w_psram_data;
+    logic w_psram_dv;
+
+    psram_controller #(
+        .ADDR_WIDTH(PSRAM_ADDR_WIDTH),
+        .LENGTH_WIDTH(LENGTH_WIDTH),
+        .INIT_CYCLES(PSRAM_INIT_CYCLES)
+    ) psram_controller_inst (
+        .clk(clk),
+        .rstn(rstn),
+
+        .ready(w_psram_ready),
+
+        .i_read(w_psram_read),
+        .i_write(1'b0),
+        .i_addr(w_psram_addr),
+        .i_length(w_psram_length),
+
+        .o_read_data(w_psram_data),
+        .o_read_dv(w_psram_dv),
+
+        .i_write_data('0),
+        .o_write_next(),
+
+        .o_psram_ce_n(o_psram_ce_n),
+        .o_psram_sclk(o_psram_sclk),
+        .o_psram_sio(o_psram_sio),
+        .o_psram_sio_oe(o_psram_sio_oe),
+        .i_psram_sio(i_psram_sio)
+    );
+
+    // Bytes left in the burst, the stream and the page, whichever is less
+    function automatic logic [LENGTH_WIDTH-1:0] burst_length(
+        input logic [PSRAM_ADDR_WIDTH-1:0] addr,
+        input logic [PSRAM_ADDR_WIDTH-1:0] end_addr
+    );
+        logic [PSRAM_ADDR_WIDTH-1:0] length;
+        logic [PSRAM_ADDR_WIDTH-1:0] remaining;
+        logic [PSRAM_ADDR_WIDTH-1:0] page_left;
+
+        length = PSRAM_ADDR_WIDTH'(BURST_BYTES);
+        remaining = end_addr - addr;
+        page_left = PSRAM_ADDR_WIDTH'(1 << PAGE_WIDTH) - PSRAM_ADDR_WIDTH'(addr[PAGE_WIDTH-1:0]);
+        if (remaining < length) length = remaining;
+        if (page_left < length) length = page_left;
+        return LENGTH_WIDTH'(length);
+    endfunction
+
+    // ========== STREAMS ==========
+    logic w_fifo_rstn;
+    assign w_fifo_rstn = rstn && ~reset;
+
+    // Next byte to fetch and the end of the model
+    logic [PSRAM_ADDR_WIDTH-1:0] r_index_fetch_addr;
+    logic [PSRAM_ADDR_WIDTH-1:0] r_index_fetch_end;
+    logic [PSRAM_ADDR_WIDTH-1:0] r_vertex_fetch_addr;
+    logic [PSRAM_ADDR_WIDTH-1:0] r_vertex_fetch_end;
+
+    // Next element to output and the end of the model, for the last flags
+    logic [INDEX_ADDR_WIDTH-1:0] r_index_out_addr;
+    logic [INDEX_ADDR_WIDTH-1:0] r_index_end_addr;
+    logic [VERTEX_ADDR_WIDTH-1:0] r_vertex_out_addr;
+    logic [VERTEX_ADDR_WIDTH-1:0] r_vertex_end_addr;
+
+    // Elements in the FIFOs
+    logic [COUNT_WIDTH-1:0] r_index_count;
+    logic [COUNT_WIDTH-1:0] r_vertex_count;
+
+    // Burst in flight
+    logic r_burst_valid;        // Cleared by reset, the rest of the burst is dropped
+    logic r_burst_vertex;
+
+    // Elements are assembled from the bytes, MSB first
+    logic [(INDEX_BYTES-1)*8-1:0] r_index_shift;
+    logic [(VERTEX_BYTES-1)*8-1:0] r_vertex_shift;
+    logic [INDEX_BYTE_CNT_WIDTH-1:0] r_index_byte_cnt;
+    logic [VERTEX_BYTE_CNT_WIDTH-1:0] r_vertex_byte_cnt;
+
+    /* verilator lint_off UNUSED */
+    logic [INDEX_BYTES*8-1:0] w_index_element;
+    logic [VERTEX_BYTES*8-1:0] w_vertex_element;
+    /* verilator lint_on UNUSED */
+    logic w_index_byte;
+    logic w_vertex_byte;
+    logic w_index_push;
+    logic w_vertex_push;
+
+    always_comb begin
+        w_index_element = {r_index_shift, w_psram_data};
+        w_vertex_element = {r_vertex_shift, w_psram_data};
+
+        w_index_byte = w_psram_dv && r_burst_valid && ~r_burst_vertex;
+        w_vertex_byte = w_psram_dv && r_burst_valid && r_burst_vertex;
+        w_index_push = w_index_byte && r_index_byte_cnt == INDEX_BYTE_CNT_WIDTH'(INDEX_BYTES - 1);
+        w_vertex_push = w_vertex_byte && r_vertex_byte_cnt == VERTEX_BYTE_CNT_WIDTH'(VERTEX_BYTES - 1);
+    end
+
+    // Prefetch FIFOs
+    logic w_index_pop;
+    logic w_vertex_pop;
+    logic [INDEX_DATA_WIDTH-1:0] w_index_fifo_data;
+    logic [VERTEX_DATA_WIDTH-1:0] w_vertex_fifo_data;
+    logic w_index_fifo_dv;
+    logic w_vertex_fifo_dv;
+    logic w_index_empty;
+    logic w_vertex_empty;
+
+    sync_fifo #(
+        .DATAWIDTH(INDEX_DATA_WIDTH),
+        .DEPTH(FIFO_DEPTH)
+    ) index_fifo_inst (
+        .rstn(w_fifo_rstn),
+        .write_clk(clk),
+        .read_clk(clk),
+        .read_en(w_index_pop),
+        .write_en(w_index_push),
+        .data_in(w_index_element[INDEX_DATA_WIDTH-1:0]),
+        .data_out(w_index_fifo_data),
+        .o_dv(w_index_fifo_dv),
+        .empty(w_index_empty),
+        .full()
+    );
+
+    sync_fifo #(
+        .DATAWIDTH(VERTEX_DATA_WIDTH),
+        .DEPTH(FIFO_DEPTH)
+    ) vertex_fifo_inst (
+        .rstn(w_fifo_rstn),
+        .write_clk(clk),
+        .read_clk(clk),
+        .read_en(w_vertex_pop),
+        .write_en(w_vertex_push),
+        .data_in(w_vertex_element[VERTEX_DATA_WIDTH-1:0]),
+        .data_out(w_vertex_fifo_data),
+        .o_dv(w_vertex_fifo_dv),
+        .empty(w_vertex_empty),
+        .full()
+    );
+
+    // State machine states
+    typedef enum logic [2:0] {
+        IDLE,
+        WAIT_HEADER_0_READ,
+        READ_HEADER_0,
+        WAIT_HEADER_1_READ,
+        READ_HEADER_1,
+        READY
+    } state_t;
+    state_t current_state, next_state;
+
+    always_ff @(posedge clk) begin
+        if (reset || ~rstn) begin
+            current_state <= IDLE;
+        end
+        else begin
+            current_state <= next_state;
+        end
+    end
+
+    // State transitions
+    always_comb begin
+        ready = 1'b0;
+
+        case (current_state)
+            IDLE: begin
+                next_state = WAIT_HEADER_0_READ;
+            end
+
+            WAIT_HEADER_0_READ: begin
+                next_state = READ_HEADER_0;
+            end
+
+            READ_HEADER_0: begin
+                next_state = WAIT_HEADER_1_READ;
+            end
+
+            WAIT_HEADER_1_READ: begin
+                next_state = READ_HEADER_1;
+            end
+
+            READ_HEADER_1: begin
+                next_state = READY;
+            end
+
+            READY: begin
+                next_state = READY;
+                ready = 1'b1;
+            end
+
+            default: begin
+                next_state = IDLE;
+            end
+        endcase
+    end
+
+    // Burst requests, when there is room for all elements of a burst. The
+    // last stream served waits if both want one.
+    logic w_index_want;
+    logic w_vertex_want;
+    logic w_issue_index;
+    logic w_issue_vertex;
+    logic r_last_burst_vertex;
+    logic [LENGTH_WIDTH-1:0] w_index_length;
+    logic [LENGTH_WIDTH-1:0] w_vertex_length;
+
+    always_comb begin
+        w_index_want = (current_state == READY) && (r_index_fetch_addr != r_index_fetch_end) &&
+                       (r_index_count <= COUNT_WIDTH'(FIFO_DEPTH - 1 - INDEX_BURST_ELEMENTS));
+        w_vertex_want = (current_state == READY) && (r_vertex_fetch_addr != r_vertex_fetch_end) &&
+                        (r_vertex_count <= COUNT_WIDTH'(FIFO_DEPTH - 1 - VERTEX_BURST_ELEMENTS));
+
+        w_issue_index = w_psram_ready && w_index_want && (~w_vertex_want || r_last_burst_vertex);
+        w_issue_vertex = w_psram_ready && w_vertex_want && ~w_issue_index;
+
+        w_index_length = burst_length(r_index_fetch_addr, r_index_fetch_end);
+        w_vertex_length = burst_length(r_vertex_fetch_addr, r_vertex_fetch_end);
+
+        w_psram_read = w_issue_index || w_issue_vertex;
+        w_psram_addr = w_issue_vertex ? r_vertex_fetch_addr : r_index_fetch_addr;
+        w_psram_length = w_issue_vertex ? w_vertex_length : w_index_length;
+
+        // Like the ROMs, one element per read_en until the output is taken
+        w_index_pop = (current_state == READY) && index_read_en && ~index_o_dv &&
+                      ~w_index_fifo_dv && ~w_index_empty;
+        w_vertex_pop = (current_state == READY) && vertex_read_en && ~vertex_o_dv &&
+                       ~w_vertex_fifo_dv && ~w_vertex_empty;
+    end
+
+    // State operations
+    always_ff @(posedge clk) begin
+        if (reset || ~rstn) begin
+            foreach (index_data[i]) index_data[i] <= '0;
+            index_o_dv <= '0;
+            index_data_last <= '0;
+
+            foreach (vertex_data[i]) vertex_data[i] <= '0;
+            vertex_o_dv <= '0;
+            vertex_data_last <= '0;
+
+            r_index_fetch_addr <= '0;
+            r_index_fetch_end <= '0;
+            r_vertex_fetch_addr <= '0;
+            r_vertex_fetch_end <= '0;
+
+            r_index_count <= '0;
+            r_vertex_count <= '0;
+            r_index_byte_cnt <= '0;
+            r_vertex_byte_cnt <= '0;
+
+            r_burst_valid <= 1'b0;
+            r_last_burst_vertex <= 1'b0;
+        end else begin
+            case (current_state)
+                IDLE: begin
+                    header_addr <= model_index;
+                end
+
+                READ_HEADER_0: begin
+                    // Read start indices from header
+                    r_index_out_addr <= header_data[HEADER_DATA_WIDTH-1:VERTEX_ADDR_WIDTH];
+                    r_vertex_out_addr <= header_data[VERTEX_ADDR_WIDTH-1:0];
+                    r_index_fetch_addr <= PSRAM_ADDR_WIDTH'(PSRAM_FACES_ADDR) +
+                        PSRAM_ADDR_WIDTH'(header_data[HEADER_DATA_WIDTH-1:VERTEX_ADDR_WIDTH]) * PSRAM_ADDR_WIDTH'(INDEX_BYTES);
+                    r_vertex_fetch_addr <= PSRAM_ADDR_WIDTH'(PSRAM_VERTEX_ADDR) +
+                        PSRAM_ADDR_WIDTH'(header_data[VERTEX_ADDR_WIDTH-1:0]) * PSRAM_ADDR_WIDTH'(VERTEX_BYTES);
+
+                    // Increment header addr to read end indices
+                    header_addr <= model_index + 1;
+                end
+
+                READ_HEADER_1: begin
+                    // Read end indices from header
+                    r_index_end_addr <= header_data[HEADER_DATA_WIDTH-1:VERTEX_ADDR_WIDTH];
+                    r_vertex_end_addr <= header_data[VERTEX_ADDR_WIDTH-1:0];
+                    r_index_fetch_end <= PSRAM_ADDR_WIDTH'(PSRAM_FACES_ADDR) +
+                        PSRAM_ADDR_WIDTH'(header_data[HEADER_DATA_WIDTH-1:VERTEX_ADDR_WIDTH]) * PSRAM_ADDR_WIDTH'(INDEX_BYTES);
+                    r_vertex_fetch_end <= PSRAM_ADDR_WIDTH'(PSRAM_VERTEX_ADDR) +
+                        PSRAM_ADDR_WIDTH'(header_data[VERTEX_ADDR_WIDTH-1:0]) * PSRAM_ADDR_WIDTH'(VERTEX_BYTES);
+                end
+
+                READY: begin
+                    // Start a burst
+                    if (w_issue_index) begin
+                        r_index_fetch_addr <= r_index_fetch_addr + PSRAM_ADDR_WIDTH'(w_index_length);
+                    end
+                    if (w_issue_vertex) begin
+                        r_vertex_fetch_addr <= r_vertex_fetch_addr + PSRAM_ADDR_WIDTH'(w_vertex_length);
+                    end
+                    if (w_psram_read) begin
+                        r_burst_valid <= 1'b1;
+                        r_burst_vertex <= w_issue_vertex;
+                        r_last_burst_vertex <= w_issue_vertex;
+                    end
+
+                    // Handle face data
+                    if (index_read_en && index_o_dv) begin
+                        foreach (index_data[i]) index_data[i] <= '0;
+                        index_o_dv <= '0;
+                        index_data_last <= '0;
+                    end else if (w_index_fifo_dv) begin
+                        index_data[0] <= w_index_fifo_data[VERTEX_ADDR_WIDTH-1:0];
+                        index_data[1] <= w_index_fifo_data[2*VERTEX_ADDR_WIDTH-1:VERTEX_ADDR_WIDTH];
+                        index_data[2] <= w_index_fifo_data[3*VERTEX_ADDR_WIDTH-1:2*VERTEX_ADDR_WIDTH];
+
+                        index_o_dv <= 1'b1;
+                        index_data_last <= (r_index_out_addr == r_index_end_addr - 1);
+                        r_index_out_addr <= r_index_out_addr + 1;
+                    end
+
+                    // Handle vertex data
+                    if (vertex_read_en && vertex_o_dv) begin
+                        foreach (vertex_data[i]) vertex_data[i] <= '0;
+                        vertex_o_dv <= '0;
+                        vertex_data_last <= '0;
+                    end else if (w_vertex_fifo_dv) begin
+                        vertex_data[0] <= w_vertex_fifo_data[COORDINATE_WIDTH-1:0];
+                        vertex_data[1] <= w_vertex_fifo_data[2*COORDINATE_WIDTH-1:COORDINATE_WIDTH];
+                        vertex_data[2] <= w_vertex_fifo_data[3*COORDINATE_WIDTH-1:2*COORDINATE_WIDTH];
+
+                        vertex_o_dv <= 1'b1;
+                        vertex_data_last <= (r_vertex_out_addr == r_vertex_end_addr - 1);
+                        r_vertex_out_addr <= r_vertex_out_addr + 1;
+                    end
+                end
+
+                default: begin
+                    // Do nothing
+                end
+            endcase
+
+            // Assemble the elements of the burst
+            if (w_index_byte) begin
+                r_index_shift <= w_index_element[(INDEX_BYTES-1)*8-1:0];
+                r_index_byte_cnt <= w_index_push ? '0 : r_index_byte_cnt + 1;
+            end
+            if (w_vertex_byte) begin
+                r_vertex_shift <= w_vertex_element[(VERTEX_BYTES-1)*8-1:0];
+                r_vertex_byte_cnt <= w_vertex_push ? '0 : r_vertex_byte_cnt + 1;
+            end
+
+            r_index_count <= r_index_count + COUNT_WIDTH'(w_index_push) - COUNT_WIDTH'(w_index_pop);
+            r_vertex_count <= r_vertex_count + COUNT_WIDTH'(w_vertex_push) - COUNT_WIDTH'(w_vertex_pop);
+        end
+    end
+
+endmodule
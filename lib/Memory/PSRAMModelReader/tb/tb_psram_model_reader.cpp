@@ -0,0 +1,204 @@
+#include <stdlib.h>
+#include <cstdlib>
+#include <cstdint>
+#include <verilated.h>
+#include <verilated_vcd_c.h>
+#include "obj_dir/Vpsram_model_reader.h"
+#include "../../PSRAM/tb/psram_model.h"
+
+#ifndef PSRAM_FACES_ADDR
+#define PSRAM_FACES_ADDR 0
+#endif
+#ifndef PSRAM_VERTEX_ADDR
+#define PSRAM_VERTEX_ADDR 0x400000
+#endif
+
+#define PSRAM_SIZE (1 << 23)
+#define READ_WAIT_CYCLES 6
+
+#define INDEX_ADDR_WIDTH 16
+#define COORDINATE_WIDTH 24
+#define INDEX_BYTES 6
+#define VERTEX_BYTES 9
+
+// Must match model_headers.mem
+#define NUM_FACES 1000
+#define NUM_VERTICES 2500
+const int face_start[3] = {0, 300, 1000};
+const int vertex_start[3] = {0, 200, 2500};
+
+#define RESET_CLKS 8
+#define MAX_SIM_TIME 800000
+
+vluint64_t sim_time = 0;
+vluint64_t posedge_cnt = 0;
+
+// Element i, packed like a line of the ROM files and stored MSB first
+uint32_t face_index(PsramModel& psram, int face, int j) {
+    uint32_t addr = PSRAM_FACES_ADDR + face * INDEX_BYTES;
+    uint32_t value = 0;
+    for (int k = 0; k < 2; k++) {
+        value |= psram.mem[addr + INDEX_BYTES - 1 - (2 * j + k)] << (8 * k);
+    }
+    return value;
+}
+
+uint32_t vertex_coordinate(PsramModel& psram, int vertex, int j) {
+    uint32_t addr = PSRAM_VERTEX_ADDR + vertex * VERTEX_BYTES;
+    uint32_t value = 0;
+    for (int k = 0; k < 3; k++) {
+        value |= psram.mem[addr + VERTEX_BYTES - 1 - (3 * j + k)] << (8 * k);
+    }
+    return value;
+}
+
+int main(int argc, char** argv) {
+    srand(time(NULL));
+    Verilated::commandArgs(argc, argv);
+
+    Vpsram_model_reader* dut = new Vpsram_model_reader;
+    PsramModel psram(PSRAM_SIZE, READ_WAIT_CYCLES);
+
+    Verilated::traceEverOn(true);
+    VerilatedVcdC* m_trace = new VerilatedVcdC;
+    dut->trace(m_trace, 5);
+    m_trace->open("waveform.vcd");
+
+    for (uint32_t i = 0; i < NUM_FACES * INDEX_BYTES; i++) {
+        psram.mem[PSRAM_FACES_ADDR + i] = rand() & 0xFF;
+    }
+    for (uint32_t i = 0; i < NUM_VERTICES * VERTEX_BYTES; i++) {
+        psram.mem[PSRAM_VERTEX_ADDR + i] = rand() & 0xFF;
+    }
+
+    dut->clk = 0;
+    dut->rstn = 0;
+    dut->reset = 0;
+    dut->model_index = 0;
+    dut->index_read_en = 0;
+    dut->vertex_read_en = 0;
+    dut->i_psram_sio = 0;
+
+    // Model 1 is started and restarted after a part, in the middle of a
+    // burst. Then models 0 and 1 are read completely. Faces and vertices
+    // are read at the same time, with random gaps like the pipeline. Every
+    // element must come in order, and the last one with the last flag.
+    const int models[3] = {1, 0, 1};
+    const int partial_vertices = 100;
+
+    int errors = 0;
+    int run = 0;
+    int faces_read = 0;
+    int vertices_read = 0;
+    bool index_dv_last = false;
+    bool vertex_dv_last = false;
+    bool start = true;
+    while (sim_time < MAX_SIM_TIME && run < 3) {
+        dut->clk ^= 1;
+        dut->eval();
+        dut->i_psram_sio = psram.update(dut->o_psram_ce_n, dut->o_psram_sclk,
+                                        dut->o_psram_sio, dut->o_psram_sio_oe);
+
+        if (dut->clk == 1) {
+            posedge_cnt++;
+            dut->rstn = posedge_cnt > RESET_CLKS;
+            dut->reset = 0;
+
+            int model = models[run];
+            int num_faces = face_start[model + 1] - face_start[model];
+            int num_vertices = vertex_start[model + 1] - vertex_start[model];
+
+            if (start && dut->rstn) {
+                dut->model_index = model;
+                dut->reset = 1;
+                dut->index_read_en = 0;
+                dut->vertex_read_en = 0;
+                index_dv_last = false;
+                vertex_dv_last = false;
+                faces_read = 0;
+                vertices_read = 0;
+                start = false;
+            } else if (dut->rstn) {
+                // Faces
+                if (dut->index_o_dv && !index_dv_last) {
+                    int face = face_start[model] + faces_read;
+                    if (faces_read >= num_faces) {
+                        printf("Error: model %d: face after the last\n", model);
+                        errors++;
+                    } else {
+                        for (int j = 0; j < 3; j++) {
+                            if (dut->index_data[j] != face_index(psram, face, j)) {
+                                printf("Error: face %d[%d]: expected %d, got %d\n", face, j,
+                                       face_index(psram, face, j), dut->index_data[j]);
+                                errors++;
+                            }
+                        }
+                        if (dut->index_data_last != (faces_read == num_faces - 1)) {
+                            printf("Error: face %d: last flag %d\n", face, dut->index_data_last);
+                            errors++;
+                        }
+                    }
+                    faces_read++;
+                }
+                if (index_dv_last && dut->index_read_en) {
+                    dut->index_read_en = 0;
+                } else if (faces_read < num_faces && rand() % 2) {
+                    dut->index_read_en = 1;
+                }
+                index_dv_last = dut->index_o_dv;
+
+                // Vertices
+                if (dut->vertex_o_dv && !vertex_dv_last) {
+                    int vertex = vertex_start[model] + vertices_read;
+                    if (vertices_read >= num_vertices) {
+                        printf("Error: model %d: vertex after the last\n", model);
+                        errors++;
+                    } else {
+                        for (int j = 0; j < 3; j++) {
+                            uint32_t got = dut->vertex_data[j] & ((1 << COORDINATE_WIDTH) - 1);
+                            if (got != vertex_coordinate(psram, vertex, j)) {
+                                printf("Error: vertex %d[%d]: expected %06X, got %06X\n", vertex, j,
+                                       vertex_coordinate(psram, vertex, j), got);
+                                errors++;
+                            }
+                        }
+                        if (dut->vertex_data_last != (vertices_read == num_vertices - 1)) {
+                            printf("Error: vertex %d: last flag %d\n", vertex, dut->vertex_data_last);
+                            errors++;
+                        }
+                    }
+                    vertices_read++;
+                }
+                if (vertex_dv_last && dut->vertex_read_en) {
+                    dut->vertex_read_en = 0;
+                } else if (vertices_read < num_vertices && rand() % 2) {
+                    dut->vertex_read_en = 1;
+                }
+                vertex_dv_last = dut->vertex_o_dv;
+
+                bool done = (run == 0) ? vertices_read >= partial_vertices
+                                       : faces_read == num_faces && vertices_read == num_vertices;
+                if (done) {
+                    run++;
+                    start = true;
+                }
+            }
+        }
+
+        m_trace->dump(sim_time);
+        sim_time++;
+    }
+
+    if (run != 3) {
+        printf("Error: stopped in run %d, %d faces and %d vertices read\n", run, faces_read, vertices_read);
+        errors++;
+    }
+    errors += psram.errors;
+
+    m_trace->close();
+    printf("%s: %d errors\n", errors ? "FAILED" : "PASSED", errors);
+
+    delete dut;
+
+    exit(errors ? EXIT_FAILURE : EXIT_SUCCESS);
+}
@@ -0,0 +1,51 @@
+// Skid buffer for a valid/ready stream. A word is transferred when valid
+// and ready are both high. Both o_ready and the outputs are registered, so
+// the buffer breaks the combinational paths between two stages, and still
+// takes a word every cycle. When the output stalls, the word already
+// accepted is held in the skid register.
+
+`timescale 1ns / 1ps
+
+module skid_buffer #(
+    parameter unsigned DATA_WIDTH = 8
+    ) (
+    input logic clk,
+    input logic rstn,
+
+    input logic [DATA_WIDTH-1:0] i_data,
+    input logic i_valid,
+    output logic o_ready,
+
+    output logic [DATA_WIDTH-1:0] o_data,
+    output logic o_valid,
+    input logic i_ready
+    );
+
+    logic [DATA_WIDTH-1:0] r_skid_data;
+    logic r_skid_valid;
+
+    assign o_ready = ~r_skid_valid;
+
+    always_ff @(posedge clk) begin
+        if (~rstn) begin
+            o_valid <= 1'b0;
+            r_skid_valid <= 1'b0;
+        end else begin
+            if (~o_valid || i_ready) begin
+                // Output register is free
+                if (r_skid_valid) begin
+                    o_data <= r_skid_data;
+                    o_valid <= 1'b1;
+                    r_skid_valid <= 1'b0;
+                end else begin
+                    o_data <= i_data;
+                    o_valid <= i_valid;
+                end
+            end else if (i_valid && o_ready) begin
+                r_skid_data <= i_data;
+                r_skid_valid <= 1'b1;
+            end
+        end
+    end
+
+endmodule
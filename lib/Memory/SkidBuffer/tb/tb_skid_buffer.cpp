@@ -0,0 +1,101 @@
+#include <stdlib.h>
+#include <cstdlib>
+#include <verilated.h>
+#include <verilated_vcd_c.h>
+#include "obj_dir/Vskid_buffer.h"
+
+#define DATA_WIDTH 16
+#define DATA_MASK ((1 << DATA_WIDTH) - 1)
+
+#define RESET_CLKS 8
+#define RANDOM_CLKS 4000
+#define FULL_RATE_CLKS 200
+#define MAX_SIM_TIME (2 * (RESET_CLKS + RANDOM_CLKS + FULL_RATE_CLKS + 8))
+
+vluint64_t sim_time = 0;
+vluint64_t posedge_cnt = 0;
+
+int main(int argc, char** argv) {
+    srand(time(NULL));
+    Verilated::commandArgs(argc, argv);
+
+    Vskid_buffer* dut = new Vskid_buffer;
+
+    Verilated::traceEverOn(true);
+    VerilatedVcdC* m_trace = new VerilatedVcdC;
+    dut->trace(m_trace, 5);
+    m_trace->open("waveform.vcd");
+
+    dut->clk = 0;
+    dut->rstn = 0;
+    dut->i_valid = 0;
+    dut->i_ready = 0;
+    dut->i_data = 0;
+
+    // A counting sequence is sent with random valid and ready, and must come
+    // out complete and in order. A word is only changed after it has been
+    // taken. At the end both sides are always ready, and a word has to be
+    // transferred every cycle.
+    int errors = 0;
+    int num_sent = 0;
+    int num_received = 0;
+    int full_rate_received = 0;
+    bool pending = false;
+    while (sim_time < MAX_SIM_TIME) {
+        dut->clk ^= 1;
+        dut->eval();
+
+        // All outputs are registered, so the transfers at the next rising
+        // edge are known when the inputs are set
+        if (dut->clk == 1) {
+            posedge_cnt++;
+            dut->rstn = posedge_cnt > RESET_CLKS;
+
+            if (dut->rstn) {
+                bool full_rate = posedge_cnt > RESET_CLKS + RANDOM_CLKS;
+
+                // A word not taken yet stays valid
+                if (!pending) {
+                    pending = full_rate || rand() % 3 != 0;
+                }
+                dut->i_valid = pending;
+                dut->i_data = num_sent & DATA_MASK;
+                dut->i_ready = full_rate || rand() % 2;
+
+                if (pending && dut->o_ready) {
+                    num_sent++;
+                    pending = false;
+                }
+
+                if (dut->o_valid && dut->i_ready) {
+                    if (dut->o_data != (num_received & DATA_MASK)) {
+                        printf("Error: word %d: expected %d, got %d\n", num_received,
+                               num_received & DATA_MASK, dut->o_data);
+                        errors++;
+                    }
+                    num_received++;
+                    full_rate_received += full_rate;
+                }
+            }
+        }
+
+        m_trace->dump(sim_time);
+        sim_time++;
+    }
+
+    if (num_sent - num_received > 2) {
+        printf("Error: %d words sent, %d received\n", num_sent, num_received);
+        errors++;
+    }
+    if (full_rate_received < FULL_RATE_CLKS - 2) {
+        printf("Error: %d of %d words at full rate\n", full_rate_received, FULL_RATE_CLKS);
+        errors++;
+    }
+
+    m_trace->close();
+    printf("%s: %d errors\n", errors ? "FAILED" : "PASSED", errors);
+
+    delete dut;
+
+    exit(errors ? EXIT_FAILURE : EXIT_SUCCESS);
+}
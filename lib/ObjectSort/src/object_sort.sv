@@ -0,0 +1,204 @@
+// Front-to-back sort of the objects of a frame, with a depth bucketed list.
+// The key of an object is the w of its origin in clip space, i.e. the
+// translation entry MVP[3][3], which grows with the distance to the camera.
+// Objects behind the camera (negative key) go last, as do objects beyond
+// the last bucket.
+//
+// Objects are pushed one per cycle, and pushed to the front of the list of
+// their bucket. After i_flush the buckets are read out nearest first, so
+// objects within one bucket come out in reverse order. The payload is e.g.
+// the index of the object in the object table.
+
+`timescale 1ns / 1ps
+
+module object_sort #(
+    parameter unsigned KEY_WIDTH = 24,
+    parameter unsigned KEY_SHIFT = 14,      // Bucket is key >> KEY_SHIFT, 2.0 with Q.13 keys
+    parameter unsigned NUM_BUCKETS = 64,
+    parameter unsigned MAX_OBJECTS = 256,
+    parameter unsigned DATA_WIDTH = 10,
+
+    parameter unsigned BUCKET_WIDTH = $clog2(NUM_BUCKETS),
+    parameter unsigned OBJECT_ADDR_WIDTH = $clog2(MAX_OBJECTS)
+    ) (
+    input logic clk,
+    input logic rstn,
+
+    // Objects of the frame, dropped when not ready
+    input logic signed [KEY_WIDTH-1:0] i_key,
+    input logic [DATA_WIDTH-1:0] i_data,
+    input logic i_dv,
+    input logic i_flush,    // All objects pushed, after the last i_dv
+    output logic o_ready,
+
+    // Sorted objects, o_dv is held until i_next
+    output logic [DATA_WIDTH-1:0] o_data,
+    output logic o_dv,
+    input logic i_next,
+    output logic finished   // All objects read out, pulsed also with no objects
+    );
+
+    localparam unsigned NODE_WIDTH = DATA_WIDTH + OBJECT_ADDR_WIDTH + 1;
+
+    // Bucket lists. A node is {data, next, tail}
+    logic [OBJECT_ADDR_WIDTH-1:0] r_head[NUM_BUCKETS];
+    logic [NUM_BUCKETS-1:0] r_bucket_used;
+    logic [OBJECT_ADDR_WIDTH:0] r_num_objects;
+
+    logic signed [KEY_WIDTH-1:0] w_key_bucket;
+    logic [BUCKET_WIDTH-1:0] w_bucket;
+    logic w_push;
+    logic [NODE_WIDTH-1:0] w_node_write;
+    logic [NODE_WIDTH-1:0] w_node_read;
+
+    logic [BUCKET_WIDTH-1:0] r_bucket;
+    logic [OBJECT_ADDR_WIDTH-1:0] r_node;
+
+    logic [DATA_WIDTH-1:0] w_node_data;
+    logic [OBJECT_ADDR_WIDTH-1:0] w_node_next;
+    logic w_node_tail;
+
+    bram_dp #(
+        .WIDTH(NODE_WIDTH),
+        .DEPTH(MAX_OBJECTS)
+    ) node_inst (
+        .clk_write(clk),
+        .clk_read(clk),
+        .write_enable(w_push),
+        .addr_write(r_num_objects[OBJECT_ADDR_WIDTH-1:0]),
+        .addr_read(r_node),
+        .data_in(w_node_write),
+        .data_out(w_node_read)
+    );
+
+    // ====== STATE ======
+    typedef enum logic [2:0] {
+        INSERT,
+        SCAN,           // Find the next bucket with objects
+        NODE_READ,
+        OUTPUT,
+        DONE
+    } state_t;
+    state_t current_state = INSERT, next_state;
+
+    always_comb begin
+        w_key_bucket = i_key >>> KEY_SHIFT;
+        if (w_key_bucket < 0 || w_key_bucket >= $signed(KEY_WIDTH'(NUM_BUCKETS - 1))) begin
+            w_bucket = BUCKET_WIDTH'(NUM_BUCKETS - 1);
+        end else begin
+            w_bucket = w_key_bucket[BUCKET_WIDTH-1:0];
+        end
+
+        o_ready = (current_state == INSERT) && (r_num_objects < (OBJECT_ADDR_WIDTH+1)'(MAX_OBJECTS));
+        w_push = i_dv && o_ready;
+        w_node_write = {i_data, r_head[w_bucket], ~r_bucket_used[w_bucket]};
+
+        {w_node_data, w_node_next, w_node_tail} = w_node_read;
+        o_data = w_node_data;
+        o_dv = (current_state == OUTPUT);
+    end
+
+    always_ff @(posedge clk) begin
+        if (~rstn) begin
+            current_state <= INSERT;
+        end else begin
+            current_state <= next_state;
+        end
+    end
+
+    always_comb begin
+        next_state = current_state;
+
+        case (current_state)
+            INSERT: begin
+                if (i_flush) begin
+                    next_state = (r_bucket_used != '0) ? SCAN : DONE;
+                end
+            end
+
+            SCAN: begin
+                if (r_bucket_used[r_bucket]) begin
+                    next_state = NODE_READ;
+                end
+            end
+
+            NODE_READ: begin
+                next_state = OUTPUT;
+            end
+
+            OUTPUT: begin
+                if (i_next) begin
+                    if (~w_node_tail) begin
+                        next_state = NODE_READ;
+                    end else if ((r_bucket_used & ~(NUM_BUCKETS'(1) << r_bucket)) != '0) begin
+                        next_state = SCAN;
+                    end else begin
+                        next_state = DONE;
+                    end
+                end
+            end
+
+            DONE: begin
+                next_state = INSERT;
+            end
+
+            default: begin
+                next_state = INSERT;
+            end
+        endcase
+    end
+
+    always_ff @(posedge clk) begin
+        if (~rstn) begin
+            foreach (r_head[i]) r_head[i] <= '0;
+            r_bucket_used <= '0;
+            r_num_objects <= '0;
+            r_bucket <= '0;
+            r_node <= '0;
+            finished <= 1'b0;
+        end else begin
+            finished <= 1'b0;
+
+            case (current_state)
+                INSERT: begin
+                    if (w_push) begin
+                        r_head[w_bucket] <= r_num_objects[OBJECT_ADDR_WIDTH-1:0];
+                        r_bucket_used[w_bucket] <= 1'b1;
+                        r_num_objects <= r_num_objects + 1;
+                    end
+                    r_bucket <= '0;
+                end
+
+                SCAN: begin
+                    if (r_bucket_used[r_bucket]) begin
+                        r_node <= r_head[r_bucket];
+                    end else begin
+                        r_bucket <= r_bucket + 1;
+                    end
+                end
+
+                OUTPUT: begin
+                    if (i_next) begin
+                        if (~w_node_tail) begin
+                            r_node <= w_node_next;
+                        end else begin
+                            // The bucket is empty now
+                            r_bucket_used[r_bucket] <= 1'b0;
+                            r_bucket <= r_bucket + 1;
+                        end
+                    end
+                end
+
+                DONE: begin
+                    r_bucket_used <= '0;
+                    r_num_objects <= '0;
+                    finished <= 1'b1;
+                end
+
+                default: begin
+                end
+            endcase
+        end
+    end
+
+endmodule
@@ -0,0 +1,150 @@
+#include <stdlib.h>
+#include <stdint.h>
+#include <cstdlib>
+#include <vector>
+#include <verilated.h>
+#include <verilated_vcd_c.h>
+#include "obj_dir/Vobject_sort.h"
+
+#define NUM_FRAMES 16
+#define RESET_CLKS 8
+#define MAX_SIM_TIME (2 * (RESET_CLKS + NUM_FRAMES * (MAX_OBJECTS + 8) * 16))
+
+vluint64_t sim_time = 0;
+vluint64_t posedge_cnt = 0;
+
+struct Object {
+    int key;
+    int data;
+};
+
+int bucket(int key) {
+    int b = key >> KEY_SHIFT;
+    return (b < 0 || b >= NUM_BUCKETS - 1) ? NUM_BUCKETS - 1 : b;
+}
+
+// Buckets nearest first, each in reverse order of insertion
+std::vector<int> expected_order(const std::vector<Object>& objects) {
+    std::vector<int> order;
+    for (int b = 0; b < NUM_BUCKETS; b++) {
+        for (int i = (int)objects.size() - 1; i >= 0; i--) {
+            if (bucket(objects[i].key) == b) order.push_back(objects[i].data);
+        }
+    }
+    return order;
+}
+
+int main(int argc, char** argv) {
+    srand(time(NULL));
+    Verilated::commandArgs(argc, argv);
+
+    Vobject_sort* dut = new Vobject_sort;
+
+    Verilated::traceEverOn(true);
+    VerilatedVcdC* m_trace = new VerilatedVcdC;
+    dut->trace(m_trace, 5);
+    m_trace->open("waveform.vcd");
+
+    dut->clk = 0;
+    dut->rstn = 0;
+    dut->i_dv = 0;
+    dut->i_flush = 0;
+    dut->i_next = 0;
+
+    enum { SETUP, PUSH, FLUSH, READ } phase = SETUP;
+
+    int errors = 0;
+    int frame = 0;
+    int to_push = 0;
+    std::vector<Object> objects;
+    std::vector<int> expected;
+    size_t num_read = 0;
+
+    while (sim_time < MAX_SIM_TIME && frame < NUM_FRAMES) {
+        dut->clk ^= 1;
+        dut->eval();
+
+        // Inputs are set after the rising edge, and the outputs seen here
+        // hold until the next one
+        if (dut->clk == 1) {
+            posedge_cnt++;
+            dut->rstn = posedge_cnt > RESET_CLKS;
+            dut->i_dv = 0;
+            dut->i_flush = 0;
+            dut->i_next = 0;
+
+            if (dut->rstn) {
+                switch (phase) {
+                    case SETUP:
+                        // Empty frame, overfull frame or a random number of objects
+                        objects.clear();
+                        num_read = 0;
+                        to_push = (frame % 4 == 1) ? 0 : (frame % 4 == 3) ? MAX_OBJECTS + 4
+                                                                          : 1 + rand() % MAX_OBJECTS;
+                        phase = PUSH;
+                        break;
+
+                    case PUSH:
+                        if (to_push == 0) {
+                            phase = FLUSH;
+                        } else if (rand() % 4 != 0) {
+                            // Keys behind the camera, and beyond the last bucket
+                            int key = rand() % (NUM_BUCKETS << (KEY_SHIFT + 1)) - (1 << KEY_SHIFT);
+                            int data = rand() & 0xFF;
+                            dut->i_key = key & ((1 << KEY_WIDTH) - 1);
+                            dut->i_data = data;
+                            dut->i_dv = 1;
+                            if (dut->o_ready) {
+                                objects.push_back({key, data});
+                            }
+                            to_push--;
+                        }
+                        break;
+
+                    case FLUSH:
+                        dut->i_flush = 1;
+                        expected = expected_order(objects);
+                        phase = READ;
+                        break;
+
+                    case READ:
+                        if (dut->finished) {
+                            if (num_read != expected.size()) {
+                                printf("Error: frame %d, %zu of %zu objects read\n", frame, num_read, expected.size());
+                                errors++;
+                            }
+                            frame++;
+                            phase = SETUP;
+                        } else if (dut->o_dv && rand() % 3 != 0) {
+                            dut->i_next = 1;
+                            if (num_read >= expected.size()) {
+                                printf("Error: frame %d, object %zu too many\n", frame, num_read);
+                                errors++;
+                            } else if (dut->o_data != expected[num_read]) {
+                                printf("Error: frame %d, object %zu: expected %d, got %d\n",
+                                       frame, num_read, expected[num_read], dut->o_data);
+                                errors++;
+                            }
+                            num_read++;
+                        }
+                        break;
+                }
+            }
+        }
+
+        m_trace->dump(sim_time);
+        sim_time++;
+    }
+
+    if (frame != NUM_FRAMES) {
+        printf("Error: only %d of %d frames finished\n", frame, NUM_FRAMES);
+        errors++;
+    }
+
+    m_trace->close();
+    printf("%s: %d errors\n", errors ? "FAILED" : "PASSED", errors);
+
+    delete dut;
+
+    exit(errors ? EXIT_FAILURE : EXIT_SUCCESS);
+}
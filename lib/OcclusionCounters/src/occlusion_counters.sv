@@ -0,0 +1,210 @@
+`timescale 1ns / 1ps
+
+// Occlusion query counters, one per object. Counts the pixels of each object
+// that passed the depth test. Like perf_counters, i_frame_start ends the
+// frame, and the read ports read the counts of the previous frame. Read port
+// b is for the MCU, such that it can read the counts while port a is used by
+// conditional rendering.
+//
+// The counters are in BRAM, in two banks that swap at every frame. Instead of
+// clearing a bank when it becomes active, every entry is tagged with the
+// frame it was counted in, and an entry with an older tag counts as zero.
+// The counters saturate.
+//
+// The tag is two bits, so an entry that is not counted again would match
+// the frame tag four frames later. While a bank holds the snapshot, it is
+// scrubbed in the cycles without a pixel: entries with a stale tag are
+// rewritten as a zero count of the previous frame. A frame must therefore
+// have at least NUM_OBJECTS cycles without a pixel.
+module occlusion_counters #(
+    parameter unsigned NUM_OBJECTS = 1024,
+    parameter unsigned COUNTER_WIDTH = 16,
+
+    parameter unsigned OBJECT_INDEX_WIDTH = $clog2(NUM_OBJECTS)
+    ) (
+    input logic clk,
+    input logic rstn,
+
+    output logic o_ready,   // The counters are cleared after reset
+
+    input logic i_frame_start,
+    input logic [OBJECT_INDEX_WIDTH-1:0] i_object_index,
+    input logic i_pixel_pass,
+
+    // Data is valid the cycle after the address
+    input logic [OBJECT_INDEX_WIDTH-1:0] i_read_addr,
+    output logic [COUNTER_WIDTH-1:0] o_read_data,
+
+    input logic [OBJECT_INDEX_WIDTH-1:0] i_read_addr_b,
+    output logic [COUNTER_WIDTH-1:0] o_read_data_b
+    );
+
+    localparam unsigned ADDR_WIDTH = OBJECT_INDEX_WIDTH + 1;
+    localparam unsigned ENTRY_WIDTH = 2 + COUNTER_WIDTH;    // {frame tag, count}
+    localparam unsigned DEPTH = 2 * (1 << OBJECT_INDEX_WIDTH);
+
+    logic [1:0] r_frame;    // Bank is r_frame[0]
+
+    logic r_clearing;
+    logic [ADDR_WIDTH-1:0] r_clear_addr;
+
+    // Scrub of the snapshot bank, through the counting read port
+    logic [OBJECT_INDEX_WIDTH-1:0] r_scrub_index;
+    logic r_scrub_done;
+    logic w_scrub_read;
+    logic r_scrub_valid;    // The entry has been read
+    logic [ADDR_WIDTH-1:0] r_scrub_addr;
+
+    // Stage 1, the entry has been read
+    logic r_s1_valid;
+    logic [ADDR_WIDTH-1:0] r_s1_addr;
+    logic [1:0] r_s1_frame;
+
+    // Stage 2, the entry written the cycle before. The read in stage 1 was
+    // issued before it was written, so it is forwarded
+    logic r_s2_valid;
+    logic [ADDR_WIDTH-1:0] r_s2_addr;
+    logic [COUNTER_WIDTH-1:0] r_s2_count;
+
+    logic [ENTRY_WIDTH-1:0] w_count_read;
+    logic [ENTRY_WIDTH-1:0] w_snapshot_read;
+    logic [ENTRY_WIDTH-1:0] w_snapshot_read_b;
+    logic [COUNTER_WIDTH-1:0] w_count;
+    logic [COUNTER_WIDTH-1:0] w_count_next;
+
+    logic w_write_en;
+    logic [ADDR_WIDTH-1:0] w_addr_write;
+    logic [ENTRY_WIDTH-1:0] w_data_write;
+
+    // Counting and read port, same contents
+    bram_dp #(
+        .WIDTH(ENTRY_WIDTH),
+        .DEPTH(DEPTH)
+    ) count_inst (
+        .clk_write(clk),
+        .clk_read(clk),
+        .write_enable(w_write_en),
+        .addr_write(w_addr_write),
+        .addr_read(w_scrub_read ? {~r_frame[0], r_scrub_index} : {r_frame[0], i_object_index}),
+        .data_in(w_data_write),
+        .data_out(w_count_read)
+    );
+
+    bram_dp #(
+        .WIDTH(ENTRY_WIDTH),
+        .DEPTH(DEPTH)
+    ) snapshot_inst (
+        .clk_write(clk),
+        .clk_read(clk),
+        .write_enable(w_write_en),
+        .addr_write(w_addr_write),
+        .addr_read({~r_frame[0], i_read_addr}),
+        .data_in(w_data_write),
+        .data_out(w_snapshot_read)
+    );
+
+    bram_dp #(
+        .WIDTH(ENTRY_WIDTH),
+        .DEPTH(DEPTH)
+    ) snapshot_b_inst (
+        .clk_write(clk),
+        .clk_read(clk),
+        .write_enable(w_write_en),
+        .addr_write(w_addr_write),
+        .addr_read({~r_frame[0], i_read_addr_b}),
+        .data_in(w_data_write),
+        .data_out(w_snapshot_read_b)
+    );
+
+    // Not in the cycle of i_frame_start, such that the bank is still the
+    // snapshot bank when the entry is written back, and not while the last
+    // pixel of the previous frame is written into what is now the snapshot bank
+    assign w_scrub_read = ~r_clearing && ~r_scrub_done && ~i_pixel_pass && ~i_frame_start
+                          && ~(r_s1_valid && r_s1_frame != r_frame);
+
+    always_comb begin
+        if (r_s2_valid && r_s2_addr == r_s1_addr) begin
+            w_count = r_s2_count;
+        end else if (w_count_read[ENTRY_WIDTH-1 -: 2] == r_s1_frame) begin
+            w_count = w_count_read[COUNTER_WIDTH-1:0];
+        end else begin
+            w_count = '0;
+        end
+        w_count_next = (w_count == '1) ? w_count : w_count + 1;
+
+        if (r_clearing) begin
+            w_write_en = 1'b1;
+            w_addr_write = r_clear_addr;
+            w_data_write = '0;
+        end else if (r_s1_valid) begin
+            w_write_en = 1'b1;
+            w_addr_write = r_s1_addr;
+            w_data_write = {r_s1_frame, w_count_next};
+        end else begin
+            // Never with a pixel in stage 1, as the read was issued instead
+            w_write_en = r_scrub_valid && (w_count_read[ENTRY_WIDTH-1 -: 2] != r_frame - 2'd1);
+            w_addr_write = r_scrub_addr;
+            w_data_write = {r_frame - 2'd1, COUNTER_WIDTH'(0)};
+        end
+
+        // The snapshot bank was counted in the previous frame
+        if (w_snapshot_read[ENTRY_WIDTH-1 -: 2] == r_frame - 2'd1) begin
+            o_read_data = w_snapshot_read[COUNTER_WIDTH-1:0];
+        end else begin
+            o_read_data = '0;
+        end
+
+        if (w_snapshot_read_b[ENTRY_WIDTH-1 -: 2] == r_frame - 2'd1) begin
+            o_read_data_b = w_snapshot_read_b[COUNTER_WIDTH-1:0];
+        end else begin
+            o_read_data_b = '0;
+        end
+
+        o_ready = ~r_clearing;
+    end
+
+    always_ff @(posedge clk) begin
+        if (~rstn) begin
+            r_frame <= '0;
+            r_clearing <= 1'b1;
+            r_clear_addr <= '0;
+            r_s1_valid <= 1'b0;
+            r_s2_valid <= 1'b0;
+            r_scrub_index <= '0;
+            r_scrub_done <= 1'b0;
+            r_scrub_valid <= 1'b0;
+        end else begin
+            if (r_clearing) begin
+                r_clear_addr <= r_clear_addr + 1;
+                if (r_clear_addr == ADDR_WIDTH'(DEPTH - 1)) begin
+                    r_clearing <= 1'b0;
+                end
+            end
+
+            if (i_frame_start) begin
+                r_frame <= r_frame + 1;
+            end
+
+            if (i_frame_start) begin
+                r_scrub_index <= '0;
+                r_scrub_done <= 1'b0;
+            end else if (w_scrub_read) begin
+                r_scrub_index <= r_scrub_index + 1;
+                if (r_scrub_index == OBJECT_INDEX_WIDTH'(NUM_OBJECTS - 1)) begin
+                    r_scrub_done <= 1'b1;
+                end
+            end
+            r_scrub_valid <= w_scrub_read;
+            r_scrub_addr <= {~r_frame[0], r_scrub_index};
+
+            r_s1_valid <= i_pixel_pass && ~r_clearing;
+            r_s1_addr <= {r_frame[0], i_object_index};
+            r_s1_frame <= r_frame;
+
+            r_s2_valid <= r_s1_valid && ~r_clearing;
+            r_s2_addr <= r_s1_addr;
+            r_s2_count <= w_count_next;
+        end
+    end
+
+endmodule
@@ -0,0 +1,141 @@
+#include <stdlib.h>
+#include <iostream>
+#include <cstdlib>
+#include <verilated.h>
+#include <verilated_vcd_c.h>
+#include "obj_dir/Vocclusion_counters.h"
+
+#define NUM_OBJECTS 16
+#define COUNTER_WIDTH 6
+#define COUNTER_MAX ((1 << COUNTER_WIDTH) - 1)
+
+#define RESET_CLKS 8
+#define FRAME_CLKS 200
+#define NUM_FRAMES 12
+
+// Only has pixels in STALE_FRAME, its entry must not match the frame tag again
+// four frames later
+#define STALE_OBJECT (NUM_OBJECTS - 1)
+#define STALE_FRAME 1
+#define MAX_SIM_TIME (2 * (RESET_CLKS + 2 * NUM_OBJECTS + FRAME_CLKS * NUM_FRAMES))
+
+vluint64_t sim_time = 0;
+vluint64_t posedge_cnt = 0;
+
+int main(int argc, char** argv) {
+    srand(time(NULL));
+    Verilated::commandArgs(argc, argv);
+
+    Vocclusion_counters* dut = new Vocclusion_counters;
+
+    Verilated::traceEverOn(true);
+    VerilatedVcdC* m_trace = new VerilatedVcdC;
+    dut->trace(m_trace, 5);
+    m_trace->open("waveform.vcd");
+
+    int counters[NUM_OBJECTS] = {0};
+    int snapshot[NUM_OBJECTS] = {0};
+
+    dut->clk = 0;
+    dut->rstn = 0;
+    dut->i_frame_start = 0;
+    dut->i_pixel_pass = 0;
+    dut->i_object_index = 0;
+    dut->i_read_addr = 0;
+    dut->i_read_addr_b = 0;
+
+    // Every frame the snapshot of the previous frame is read back while the
+    // current frame is counted, on port b in reverse order. Object 0 gets enough pixels to saturate, and
+    // only every other frame has pixels for the upper half of the objects,
+    // such that stale entries of two frames ago have to read as zero. The last
+    // object only has pixels in STALE_FRAME, for entries of four or more
+    // frames ago.
+    int errors = 0;
+    int frame = 0;
+    int frame_cycle = 0;
+    int object_index = 0;
+    int read_addr_last = -1;
+    int read_addr_b_last = -1;
+    while (sim_time < MAX_SIM_TIME && frame < NUM_FRAMES) {
+        dut->clk ^= 1;
+        dut->eval();
+
+        if (dut->clk == 1) {
+            // Check data from read issued last cycle
+            if (read_addr_last >= 0 && dut->o_read_data != snapshot[read_addr_last]) {
+                printf("Error: frame %d, object %d: expected %d, got %d\n",
+                       frame, read_addr_last, snapshot[read_addr_last], dut->o_read_data);
+                errors++;
+            }
+            read_addr_last = -1;
+            if (read_addr_b_last >= 0 && dut->o_read_data_b != snapshot[read_addr_b_last]) {
+                printf("Error: frame %d, object %d on port b: expected %d, got %d\n",
+                       frame, read_addr_b_last, snapshot[read_addr_b_last], dut->o_read_data_b);
+                errors++;
+            }
+            read_addr_b_last = -1;
+
+            dut->rstn = posedge_cnt >= RESET_CLKS;
+            dut->i_frame_start = 0;
+            dut->i_pixel_pass = 0;
+
+            if (dut->rstn && dut->o_ready) {
+                if (frame == STALE_FRAME && frame_cycle < 8) {
+                    object_index = STALE_OBJECT;
+                    dut->i_object_index = object_index;
+                    dut->i_pixel_pass = 1;
+                    counters[object_index]++;
+                } else if (rand() % 2) {
+                    // Runs of the same object, as when rasterizing a triangle
+                    if (rand() % 4 == 0) {
+                        object_index = (rand() % 2) ? 0 : rand() % ((frame % 2) ? NUM_OBJECTS : NUM_OBJECTS / 2);
+                    }
+                    if (object_index == STALE_OBJECT) {
+                        object_index = 0;
+                    }
+                    dut->i_object_index = object_index;
+                    dut->i_pixel_pass = 1;
+                    if (counters[object_index] < COUNTER_MAX) {
+                        counters[object_index]++;
+                    }
+                }
+
+                if (frame_cycle == FRAME_CLKS - 1) {
+                    dut->i_frame_start = 1;
+                    for (int i = 0; i < NUM_OBJECTS; i++) {
+                        snapshot[i] = counters[i];
+                        counters[i] = 0;
+                    }
+                    frame++;
+                }
+
+                // The snapshot of the first frame is not valid yet
+                if (frame > 0 && frame_cycle < NUM_OBJECTS) {
+                    dut->i_read_addr = frame_cycle;
+                    read_addr_last = frame_cycle;
+                    dut->i_read_addr_b = NUM_OBJECTS - 1 - frame_cycle;
+                    read_addr_b_last = NUM_OBJECTS - 1 - frame_cycle;
+                }
+
+                frame_cycle = (frame_cycle + 1) % FRAME_CLKS;
+            }
+
+            posedge_cnt++;
+        }
+
+        m_trace->dump(sim_time);
+        sim_time++;
+    }
+
+    if (frame != NUM_FRAMES) {
+        printf("Error: only %d of %d frames counted\n", frame, NUM_FRAMES);
+        errors++;
+    }
+
+    m_trace->close();
+    printf("%s: %d errors\n", errors ? "FAILED" : "PASSED", errors);
+
+    delete dut;
+
+    exit(errors ? EXIT_FAILURE : EXIT_SUCCESS);
+}
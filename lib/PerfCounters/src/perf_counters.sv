@@ -0,0 +1,49 @@
+`timescale 1ns / 1ps
+
+// Bank of event counters. Every counter is incremented each cycle its event
+// is high. On i_frame_start all counters are copied to a snapshot and reset,
+// and the read port reads the snapshot, such that every counter read belongs
+// to the same (previous) frame.
+module perf_counters #(
+    parameter unsigned NUM_COUNTERS = 16,
+    parameter unsigned COUNTER_WIDTH = 32,
+
+    parameter unsigned ADDR_WIDTH = $clog2(NUM_COUNTERS)
+    ) (
+    input logic clk,
+    input logic rstn,
+
+    input logic i_frame_start,
+    input logic [NUM_COUNTERS-1:0] i_events,
+
+    // Data is valid the cycle after the address
+    input logic [ADDR_WIDTH-1:0] i_read_addr,
+    output logic [COUNTER_WIDTH-1:0] o_read_data
+    );
+
+    logic [COUNTER_WIDTH-1:0] r_counters[NUM_COUNTERS];
+    logic [COUNTER_WIDTH-1:0] r_snapshot[NUM_COUNTERS];
+
+    always_ff @(posedge clk) begin
+        if (~rstn) begin
+            foreach (r_counters[i]) r_counters[i] <= '0;
+            foreach (r_snapshot[i]) r_snapshot[i] <= '0;
+        end else if (i_frame_start) begin
+            foreach (r_counters[i]) begin
+                r_snapshot[i] <= r_counters[i] + COUNTER_WIDTH'(i_events[i]);
+                r_counters[i] <= '0;
+            end
+        end else begin
+            foreach (r_counters[i]) r_counters[i] <= r_counters[i] + COUNTER_WIDTH'(i_events[i]);
+        end
+    end
+
+    always_ff @(posedge clk) begin
+        if (~rstn) begin
+            o_read_data <= '0;
+        end else begin
+            o_read_data <= r_snapshot[i_read_addr];
+        end
+    end
+
+endmodule
@@ -0,0 +1,96 @@
+#include <stdlib.h>
+#include <iostream>
+#include <cstdlib>
+#include <verilated.h>
+#include <verilated_vcd_c.h>
+#include "obj_dir/Vperf_counters.h"
+
+#define NUM_COUNTERS 8
+#define COUNTER_WIDTH 16
+#define COUNTER_MASK ((1 << COUNTER_WIDTH) - 1)
+
+#define RESET_CLKS 8
+#define FRAME_CLKS 100
+#define NUM_FRAMES 10
+#define MAX_SIM_TIME (2 * (RESET_CLKS + FRAME_CLKS * NUM_FRAMES))
+
+vluint64_t sim_time = 0;
+vluint64_t posedge_cnt = 0;
+
+int main(int argc, char** argv) {
+    srand(time(NULL));
+    Verilated::commandArgs(argc, argv);
+
+    Vperf_counters* dut = new Vperf_counters;
+
+    Verilated::traceEverOn(true);
+    VerilatedVcdC* m_trace = new VerilatedVcdC;
+    dut->trace(m_trace, 5);
+    m_trace->open("waveform.vcd");
+
+    int counters[NUM_COUNTERS] = {0};
+    int snapshot[NUM_COUNTERS] = {0};
+
+    dut->clk = 0;
+    dut->rstn = 0;
+    dut->i_frame_start = 0;
+    dut->i_events = 0;
+    dut->i_read_addr = 0;
+
+    // Every frame the snapshot of the previous frame is read back while the
+    // counters keep counting random events for the current frame
+    int errors = 0;
+    int read_addr_last = -1;
+    while (sim_time < MAX_SIM_TIME) {
+        dut->clk ^= 1;
+        dut->eval();
+
+        if (dut->clk == 1) {
+            // Check data from read issued last cycle
+            if (read_addr_last >= 0 && dut->o_read_data != snapshot[read_addr_last]) {
+                printf("Error: counter %d: expected %d, got %d\n",
+                       read_addr_last, snapshot[read_addr_last], dut->o_read_data);
+                errors++;
+            }
+            read_addr_last = -1;
+
+            dut->rstn = posedge_cnt >= RESET_CLKS;
+            dut->i_frame_start = 0;
+            dut->i_events = 0;
+
+            if (posedge_cnt >= RESET_CLKS) {
+                int frame_cycle = (posedge_cnt - RESET_CLKS) % FRAME_CLKS;
+
+                dut->i_events = rand() % (1 << NUM_COUNTERS);
+                for (int i = 0; i < NUM_COUNTERS; i++) {
+                    counters[i] = (counters[i] + ((dut->i_events >> i) & 1)) & COUNTER_MASK;
+                }
+
+                if (frame_cycle == FRAME_CLKS - 1) {
+                    dut->i_frame_start = 1;
+                    for (int i = 0; i < NUM_COUNTERS; i++) {
+                        snapshot[i] = counters[i];
+                        counters[i] = 0;
+                    }
+                }
+
+                if (frame_cycle < NUM_COUNTERS) {
+                    dut->i_read_addr = frame_cycle;
+                    read_addr_last = frame_cycle;
+                }
+            }
+
+            posedge_cnt++;
+        }
+
+        m_trace->dump(sim_time);
+        sim_time++;
+    }
+
+    m_trace->close();
+    printf("%s: %d errors\n", errors ? "FAILED" : "PASSED", errors);
+
+    delete dut;
+
+    exit(errors ? EXIT_FAILURE : EXIT_SUCCESS);
+}
@@ -28,6 +28,8 @@ module rasterizer_backend #(
     input logic i_dv,
     input logic i_last,
 
+    input logic i_stall,    // Output can not take pixels, the next one is still written
+
     output logic [ADDRWIDTH-1:0] o_fb_addr_write,
     output logic o_fb_write_en,
 
@@ -36,7 +38,11 @@ module rasterizer_backend #(
 
     output logic ready,
     output logic done,
-    output logic finished
+    output logic finished,
+
+    // Performance counter events: [0] pixel tested, [1] pixel passed the
+    // depth test, which is not known here
+    output logic [1:0] o_perf_events
     );
 
     // Register later used input signals
@@ -93,7 +99,7 @@ module rasterizer_backend #(
             end
 
             RASTERIZE: begin
-                if (r_x >= {{(ADDRWIDTH-DATAWIDTH){1'b0}}, r_bb_br[0]} && r_y >= {{(ADDRWIDTH-DATAWIDTH){1'b0}}, r_bb_br[1]}) begin
+                if (~i_stall && r_x >= {{(ADDRWIDTH-DATAWIDTH){1'b0}}, r_bb_br[0]} && r_y >= {{(ADDRWIDTH-DATAWIDTH){1'b0}}, r_bb_br[1]}) begin
                     next_state = DONE;
                 end
             end
@@ -109,6 +115,10 @@ module rasterizer_backend #(
         endcase
     end
 
+    // Performance counter events
+    assign o_perf_events[0] = (current_state == RASTERIZE) && ~i_stall;
+    assign o_perf_events[1] = 1'b0;
+
     // Calculate start address
     logic [ADDRWIDTH-1:0] w_addr_start;
     logic signed [2*DATAWIDTH-1:0] w_addr_start_y;
@@ -127,93 +137,105 @@ module rasterizer_backend #(
 
     // Compute
     always_ff @(posedge clk) begin
-        case (current_state)
-            IDLE: begin
-                finished <= 1'b0;
-
-                if (i_dv) begin
-                    r_bb_tl[0] <= bb_tl[0]; r_bb_tl[1] <= bb_tl[1];
-                    r_bb_br[0] <= bb_br[0]; r_bb_br[1] <= bb_br[1];
-
-                    r_edge_delta0[0] <= edge_delta0[0]; r_edge_delta0[1] <= edge_delta0[1];
-                    r_edge_delta1[0] <= edge_delta1[0]; r_edge_delta1[1] <= edge_delta1[1];
-                    r_edge_delta2[0] <= edge_delta2[0]; r_edge_delta2[1] <= edge_delta2[1];
+        // The outputs are not written in IDLE, so they start out cleared
+        if (~rstn) begin
+            o_fb_write_en <= 1'b0;
+            finished <= 1'b0;
+        end else begin
+            case (current_state)
+                IDLE: begin
+                    finished <= 1'b0;
 
-                    r_x <= {{(ADDRWIDTH-DATAWIDTH){bb_tl[0][DATAWIDTH-1]}}, bb_tl[0]};
-                    r_y <= {{(ADDRWIDTH-DATAWIDTH){bb_tl[1][DATAWIDTH-1]}}, bb_tl[1]};
+                    if (i_dv) begin
+                        r_bb_tl[0] <= bb_tl[0]; r_bb_tl[1] <= bb_tl[1];
+                        r_bb_br[0] <= bb_br[0]; r_bb_br[1] <= bb_br[1];
 
-                    r_edge0 <= edge_val0;
-                    r_edge1 <= edge_val1;
-                    r_edge2 <= edge_val2;
+                        r_edge_delta0[0] <= edge_delta0[0]; r_edge_delta0[1] <= edge_delta0[1];
+                        r_edge_delta1[0] <= edge_delta1[0]; r_edge_delta1[1] <= edge_delta1[1];
+                        r_edge_delta2[0] <= edge_delta2[0]; r_edge_delta2[1] <= edge_delta2[1];
 
-                    r_edge_row_start0 <= edge_val0;
-                    r_edge_row_start1 <= edge_val1;
-                    r_edge_row_start2 <= edge_val2;
+                        r_x <= {{(ADDRWIDTH-DATAWIDTH){bb_tl[0][DATAWIDTH-1]}}, bb_tl[0]};
+                        r_y <= {{(ADDRWIDTH-DATAWIDTH){bb_tl[1][DATAWIDTH-1]}}, bb_tl[1]};
 
-                    r_z <= z;
-                    r_z_row_start <= z;
-                    r_z_delta[0] <= z_delta[0];
-                    r_z_delta[1] <= z_delta[1];
+                        r_edge0 <= edge_val0;
+                        r_edge1 <= edge_val1;
+                        r_edge2 <= edge_val2;
 
-                    r_addr <= w_addr_start;
-                    r_addr_delta_y <= {{(ADDRWIDTH-DATAWIDTH){1'b0}}, SCREEN_WIDTH - (bb_br[0] - bb_tl[0])};
+                        r_edge_row_start0 <= edge_val0;
+                        r_edge_row_start1 <= edge_val1;
+                        r_edge_row_start2 <= edge_val2;
 
-                    r_i_last <= i_last;
-                end
-            end
-
-            RASTERIZE: begin
-                if (r_x < {{(ADDRWIDTH-DATAWIDTH){r_bb_br[0][DATAWIDTH-1]}}, r_bb_br[0]}) begin
-                    // Increment in x-direction
-                    r_addr <= r_addr + 1;
+                        r_z <= z;
+                        r_z_row_start <= z;
+                        r_z_delta[0] <= z_delta[0];
+                        r_z_delta[1] <= z_delta[1];
 
-                    r_edge0 <= r_edge0 + {{DATAWIDTH{r_edge_delta0[0][DATAWIDTH-1]}}, r_edge_delta0[0]};
-                    r_edge1 <= r_edge1 + {{DATAWIDTH{r_edge_delta1[0][DATAWIDTH-1]}}, r_edge_delta1[0]};
-                    r_edge2 <= r_edge2 + {{DATAWIDTH{r_edge_delta2[0][DATAWIDTH-1]}}, r_edge_delta2[0]};
+                        r_addr <= w_addr_start;
+                        r_addr_delta_y <= {{(ADDRWIDTH-DATAWIDTH){1'b0}}, SCREEN_WIDTH - (bb_br[0] - bb_tl[0])};
 
-                    r_x <= r_x + 1;
-                    r_z <= r_z + r_z_delta[0];
+                        r_i_last <= i_last;
+                    end
                 end
-                else begin
-                    // Increment in y-direction
-                    r_edge0 <= r_edge_row_start0 + {{DATAWIDTH{r_edge_delta0[1][DATAWIDTH-1]}}, r_edge_delta0[1]};
-                    r_edge_row_start0 <= r_edge_row_start0 + {{DATAWIDTH{r_edge_delta0[1][DATAWIDTH-1]}}, r_edge_delta0[1]};
 
-                    r_edge1 <= r_edge_row_start1 + {{DATAWIDTH{r_edge_delta1[1][DATAWIDTH-1]}}, r_edge_delta1[1]};
-                    r_edge_row_start1 <= r_edge_row_start1 + {{DATAWIDTH{r_edge_delta1[1][DATAWIDTH-1]}}, r_edge_delta1[1]};
-
-                    r_edge2 <= r_edge_row_start2 + {{DATAWIDTH{r_edge_delta2[1][DATAWIDTH-1]}}, r_edge_delta2[1]};
-                    r_edge_row_start2 <= r_edge_row_start2 + {{DATAWIDTH{r_edge_delta2[1][DATAWIDTH-1]}}, r_edge_delta2[1]};
-
-                    r_y <= r_y + 1;
-                    r_addr <= r_addr + r_addr_delta_y;
-
-                    r_x <= {{(ADDRWIDTH-DATAWIDTH){r_bb_tl[0][DATAWIDTH-1]}}, r_bb_tl[0]};
-
-                    r_z_row_start <= r_z_row_start + r_z_delta[1];
-                    r_z <= r_z_row_start + r_z_delta[1];
+                RASTERIZE: begin
+                    if (i_stall) begin
+                        o_fb_write_en <= 1'b0;
+                    end else begin
+                        if (r_x < {{(ADDRWIDTH-DATAWIDTH){r_bb_br[0][DATAWIDTH-1]}}, r_bb_br[0]}) begin
+                            // Increment in x-direction
+                            r_addr <= r_addr + 1;
+
+                            r_edge0 <= r_edge0 + {{DATAWIDTH{r_edge_delta0[0][DATAWIDTH-1]}}, r_edge_delta0[0]};
+                            r_edge1 <= r_edge1 + {{DATAWIDTH{r_edge_delta1[0][DATAWIDTH-1]}}, r_edge_delta1[0]};
+                            r_edge2 <= r_edge2 + {{DATAWIDTH{r_edge_delta2[0][DATAWIDTH-1]}}, r_edge_delta2[0]};
+
+                            r_x <= r_x + 1;
+                            r_z <= r_z + r_z_delta[0];
+                        end
+                        else begin
+                            // Increment in y-direction
+                            r_edge0 <= r_edge_row_start0 + {{DATAWIDTH{r_edge_delta0[1][DATAWIDTH-1]}}, r_edge_delta0[1]};
+                            r_edge_row_start0 <= r_edge_row_start0 + {{DATAWIDTH{r_edge_delta0[1][DATAWIDTH-1]}}, r_edge_delta0[1]};
+
+                            r_edge1 <= r_edge_row_start1 + {{DATAWIDTH{r_edge_delta1[1][DATAWIDTH-1]}}, r_edge_delta1[1]};
+                            r_edge_row_start1 <= r_edge_row_start1 + {{DATAWIDTH{r_edge_delta1[1][DATAWIDTH-1]}}, r_edge_delta1[1]};
+
+                            r_edge2 <= r_edge_row_start2 + {{DATAWIDTH{r_edge_delta2[1][DATAWIDTH-1]}}, r_edge_delta2[1]};
+                            r_edge_row_start2 <= r_edge_row_start2 + {{DATAWIDTH{r_edge_delta2[1][DATAWIDTH-1]}}, r_edge_delta2[1]};
+
+                            r_y <= r_y + 1;
+                            r_addr <= r_addr + r_addr_delta_y;
+
+                            r_x <= {{(ADDRWIDTH-DATAWIDTH){r_bb_tl[0][DATAWIDTH-1]}}, r_bb_tl[0]};
+
+                            r_z_row_start <= r_z_row_start + r_z_delta[1];
+                            r_z <= r_z_row_start + r_z_delta[1];
+                        end
+
+                        // Check if point is inside triangle
+                        if ($signed(r_edge0) > $signed({(2*DATAWIDTH){1'b0}}) && $signed(r_edge1) > $signed({(2*DATAWIDTH){1'b0}}) && $signed(r_edge2) > $signed({(2*DATAWIDTH){1'b0}})) begin
+                            o_fb_write_en <= 1'b1;
+                        end
+                        else begin
+                            o_fb_write_en <= 1'b0;
+                        end
+                    end
                 end
 
-                // Check if point is inside triangle
-                if ($signed(r_edge0) > $signed({(2*DATAWIDTH){1'b0}}) && $signed(r_edge1) > $signed({(2*DATAWIDTH){1'b0}}) && $signed(r_edge2) > $signed({(2*DATAWIDTH){1'b0}})) begin
-                    o_fb_write_en <= 1'b1;
-                end
-                else begin
+                DONE: begin
                     o_fb_write_en <= 1'b0;
-                end
-            end
 
-            DONE: begin
-                if (r_i_last) begin
-                    finished <= 1'b1;
-                end else begin
-                    finished <= 1'b0;
+                    if (r_i_last) begin
+                        finished <= 1'b1;
+                    end else begin
+                        finished <= 1'b0;
+                    end
                 end
-            end
 
-            default begin
-            end
-        endcase
+                default begin
+                end
+            endcase
+        end
     end
 
     assign depth_data = $unsigned(r_z[DATAWIDTH-1:0]);
@@ -26,6 +26,7 @@ int main(int argc, char** argv) {
         dut->bb_tl[1] = 4;
         dut->bb_br[0] = 9;
         dut->bb_br[1] = 7;
+        dut->i_stall = 0;
 
         if (dut->clk == 1) {
             posedge_cnt++;
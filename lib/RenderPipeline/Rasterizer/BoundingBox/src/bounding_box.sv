@@ -1,11 +1,25 @@
+// Bounding box of a triangle, clamped to a tile
+//
+// PIPELINE_STAGES registers are placed into the path:
+//   0: Combinational, as a single cycle
+//   1: Register after the 3-way min/max
+//   2: Also after the clamp, the valid compare is after it
+//   3: Also on the outputs
+// The results are the same, only PIPELINE_STAGES cycles later.
+
 module bounding_box #(
     parameter signed TILE_MIN_X = 0,
     parameter signed TILE_MAX_X = 32,
     parameter signed TILE_MIN_Y = 0,
     parameter signed TILE_MAX_Y = 16,
 
-    parameter unsigned COORD_WIDTH = 10
+    parameter unsigned COORD_WIDTH = 10,
+    parameter unsigned PIPELINE_STAGES = 0
 ) (
+    /* verilator lint_off UNUSED */
+    input logic clk,    // Unused with PIPELINE_STAGES = 0
+    /* verilator lint_on UNUSED */
+
     input logic signed [COORD_WIDTH-1:0] x0,
     input logic signed [COORD_WIDTH-1:0] y0,
     input logic signed [COORD_WIDTH-1:0] x1,
@@ -23,6 +37,12 @@ module bounding_box #(
 
     // logic to store intermediate bbox coordinates
     logic signed [COORD_WIDTH-1:0] i_min_x, i_max_x, i_min_y, i_max_y;
+    logic signed [COORD_WIDTH-1:0] s_min_x, s_max_x, s_min_y, s_max_y;
+
+    // Clamped bbox
+    logic signed [COORD_WIDTH-1:0] w_min_x, w_max_x, w_min_y, w_max_y;
+    logic signed [COORD_WIDTH-1:0] c_min_x, c_max_x, c_min_y, c_max_y;
+    logic w_valid;
 
     always_comb begin
         // Calculate bbox of vertex 0, 1 and 2
@@ -30,16 +50,75 @@ module bounding_box #(
         i_max_x = (x0 > x1) ? ((x0 > x2) ? x0 : x2) : ((x1 > x2) ? x1 : x2);
         i_min_y = (y0 < y1) ? ((y0 < y2) ? y0 : y2) : ((y1 < y2) ? y1 : y2);
         i_max_y = (y0 > y1) ? ((y0 > y2) ? y0 : y2) : ((y1 > y2) ? y1 : y2);
+    end
+
+    generate
+        if (PIPELINE_STAGES >= 1) begin : g_minmax_reg
+            always_ff @(posedge clk) begin
+                s_min_x <= i_min_x;
+                s_max_x <= i_max_x;
+                s_min_y <= i_min_y;
+                s_max_y <= i_max_y;
+            end
+        end else begin : g_minmax_comb
+            always_comb begin
+                s_min_x = i_min_x;
+                s_max_x = i_max_x;
+                s_min_y = i_min_y;
+                s_max_y = i_max_y;
+            end
+        end
+    endgenerate
 
+    always_comb begin
         // Clamp min and max values of bbox to edges tile
-        min_x = (i_min_x < TILE_MIN_X) ? TILE_MIN_X : i_min_x;
-        max_x = (i_max_x > TILE_MAX_X) ? TILE_MAX_X : i_max_x;
-        min_y = (i_min_y < TILE_MIN_Y) ? TILE_MIN_Y : i_min_y;
-        max_y = (i_max_y > TILE_MAX_Y) ? TILE_MAX_Y : i_max_y;
+        w_min_x = (s_min_x < TILE_MIN_X) ? TILE_MIN_X : s_min_x;
+        w_max_x = (s_max_x > TILE_MAX_X) ? TILE_MAX_X : s_max_x;
+        w_min_y = (s_min_y < TILE_MIN_Y) ? TILE_MIN_Y : s_min_y;
+        w_max_y = (s_max_y > TILE_MAX_Y) ? TILE_MAX_Y : s_max_y;
+    end
+
+    generate
+        if (PIPELINE_STAGES >= 2) begin : g_clamp_reg
+            always_ff @(posedge clk) begin
+                c_min_x <= w_min_x;
+                c_max_x <= w_max_x;
+                c_min_y <= w_min_y;
+                c_max_y <= w_max_y;
+            end
+        end else begin : g_clamp_comb
+            always_comb begin
+                c_min_x = w_min_x;
+                c_max_x = w_max_x;
+                c_min_y = w_min_y;
+                c_max_y = w_max_y;
+            end
+        end
+    endgenerate
 
+    always_comb begin
         // Check if bbox is inside tile
-        valid = (min_x < max_x) && (min_y < max_y);
+        w_valid = (c_min_x < c_max_x) && (c_min_y < c_max_y);
     end
 
-endmodule
+    generate
+        if (PIPELINE_STAGES >= 3) begin : g_output_reg
+            always_ff @(posedge clk) begin
+                min_x <= c_min_x;
+                max_x <= c_max_x;
+                min_y <= c_min_y;
+                max_y <= c_max_y;
+                valid <= w_valid;
+            end
+        end else begin : g_output_comb
+            always_comb begin
+                min_x = c_min_x;
+                max_x = c_max_x;
+                min_y = c_min_y;
+                max_y = c_max_y;
+                valid = w_valid;
+            end
+        end
+    endgenerate
 
+endmodule
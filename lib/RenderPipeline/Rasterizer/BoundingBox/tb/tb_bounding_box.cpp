@@ -1,35 +1,141 @@
-#include <iostream>
+#include <stdlib.h>
+#include <cstdlib>
+#include <algorithm>
+#include <deque>
 #include <verilated.h>
 #include <verilated_vcd_c.h>
 #include "obj_dir/Vbounding_box.h"
 
+#ifndef PIPELINE_STAGES
+#define PIPELINE_STAGES 0
+#endif
 
-void test_case(Vbounding_box* dut, int x0, int y0, int x1, int y1, int x2, int y2) {
-    dut->x0 = x0;
-    dut->y0 = y0;
-    dut->x1 = x1;
-    dut->y1 = y1;
-    dut->x2 = x2;
-    dut->y2 = y2;
+#define COORD_WIDTH 10
+#define COORD_MASK ((1 << COORD_WIDTH) - 1)
+#define TILE_MIN_X 0
+#define TILE_MAX_X 32
+#define TILE_MIN_Y 0
+#define TILE_MAX_Y 16
 
-    dut->eval();
+#define NUM_CLKS 4000
+#define MAX_SIM_TIME (2 * (NUM_CLKS + PIPELINE_STAGES))
 
-    std::cout << "Test case: (" << x0 << ", " << y0 << "), (" << x1 << ", " << y1 << "), (" << x2 << ", " << y2 << ")\n";
-    std::cout << "  min_x: " << dut->min_x << " max_x: " << dut->max_x << " min_y: " << dut->min_y << " max_y: " << dut->max_y << "\n";
-    std::cout << "  valid: " << int(dut->valid) << "\n\n";
+vluint64_t sim_time = 0;
+
+typedef struct {
+    int x[3];
+    int y[3];
+} Triangle;
+
+typedef struct {
+    int min_x;
+    int max_x;
+    int min_y;
+    int max_y;
+    bool valid;
+} BoundingBox;
+
+// The single cycle bounding box
+BoundingBox bounding_box(const Triangle& t) {
+    BoundingBox bb;
+    bb.min_x = std::max(std::min({t.x[0], t.x[1], t.x[2]}), TILE_MIN_X);
+    bb.max_x = std::min(std::max({t.x[0], t.x[1], t.x[2]}), TILE_MAX_X);
+    bb.min_y = std::max(std::min({t.y[0], t.y[1], t.y[2]}), TILE_MIN_Y);
+    bb.max_y = std::min(std::max({t.y[0], t.y[1], t.y[2]}), TILE_MAX_Y);
+    bb.valid = bb.min_x < bb.max_x && bb.min_y < bb.max_y;
+    return bb;
+}
+
+// Mostly around the tile, sometimes anywhere
+int random_coord(int tile_max) {
+    if (rand() % 8 == 0) {
+        return rand() % (1 << COORD_WIDTH) - (1 << (COORD_WIDTH - 1));
+    }
+    return rand() % (2 * tile_max) - tile_max / 2;
 }
 
 int main(int argc, char** argv) {
+    srand(time(NULL));
     Verilated::commandArgs(argc, argv);
 
     Vbounding_box* dut = new Vbounding_box;
 
-    test_case(dut, 1, 1, 10, 10, 5, 5);
-    test_case(dut, -5, -5, 10, 10, 20, 20);
-    test_case(dut, 35, 5, 40, 10, 30, 8);
-    test_case(dut, -35, -5, -40, -10, -30, -8);
-    test_case(dut, 0, 0, 0, 0, 0, 0);
+    Verilated::traceEverOn(true);
+    VerilatedVcdC* m_trace = new VerilatedVcdC;
+    dut->trace(m_trace, 5);
+    m_trace->open("waveform.vcd");
+
+    // The fixed cases first, then random triangles
+    std::deque<Triangle> tests = {
+        {{1, 10, 5}, {1, 10, 5}},
+        {{-5, 10, 20}, {-5, 10, 20}},
+        {{35, 40, 30}, {5, 10, 8}},
+        {{-35, -40, -30}, {-5, -10, -8}},
+        {{0, 0, 0}, {0, 0, 0}}
+    };
+
+    // A new triangle every cycle. The outputs have to match the single
+    // cycle bounding box of the triangle from PIPELINE_STAGES cycles ago.
+    int errors = 0;
+    int num_valid = 0;
+    std::deque<Triangle> in_flight;
+    dut->clk = 0;
+    while (sim_time < MAX_SIM_TIME) {
+        dut->clk ^= 1;
+        dut->eval();
+
+        if (dut->clk == 1) {
+            Triangle t;
+            if (!tests.empty()) {
+                t = tests.front();
+                tests.pop_front();
+            } else {
+                for (int i = 0; i < 3; i++) {
+                    t.x[i] = random_coord(TILE_MAX_X);
+                    t.y[i] = random_coord(TILE_MAX_Y);
+                }
+            }
+
+            dut->x0 = t.x[0] & COORD_MASK;
+            dut->y0 = t.y[0] & COORD_MASK;
+            dut->x1 = t.x[1] & COORD_MASK;
+            dut->y1 = t.y[1] & COORD_MASK;
+            dut->x2 = t.x[2] & COORD_MASK;
+            dut->y2 = t.y[2] & COORD_MASK;
+            dut->eval();
+
+            in_flight.push_back(t);
+            if ((int)in_flight.size() > PIPELINE_STAGES) {
+                BoundingBox expected = bounding_box(in_flight.front());
+                in_flight.pop_front();
+
+                if ((dut->min_x & COORD_MASK) != (expected.min_x & COORD_MASK) ||
+                    (dut->max_x & COORD_MASK) != (expected.max_x & COORD_MASK) ||
+                    (dut->min_y & COORD_MASK) != (expected.min_y & COORD_MASK) ||
+                    (dut->max_y & COORD_MASK) != (expected.max_y & COORD_MASK) ||
+                    dut->valid != expected.valid) {
+                    printf("Error: expected (%d, %d) - (%d, %d) valid %d, got raw (%d, %d) - (%d, %d) valid %d\n",
+                           expected.min_x, expected.min_y, expected.max_x, expected.max_y, expected.valid,
+                           dut->min_x, dut->min_y, dut->max_x, dut->max_y, dut->valid);
+                    errors++;
+                }
+                num_valid += expected.valid;
+            }
+        }
+
+        m_trace->dump(sim_time);
+        sim_time++;
+    }
+
+    if (num_valid == 0) {
+        printf("Error: no valid bounding box tested\n");
+        errors++;
+    }
+
+    m_trace->close();
+    printf("%s: %d errors\n", errors ? "FAILED" : "PASSED", errors);
 
     delete dut;
-    return 0;
+
+    exit(errors ? EXIT_FAILURE : EXIT_SUCCESS);
 }
@@ -0,0 +1,98 @@
+// Edge function of the edge v1 -> v2 at point p, and its x and y deltas
+//
+// PIPELINE_STAGES registers are placed into the path, each one taking a
+// piece of the subtract, multiply, subtract chain:
+//   0: Combinational, as a single cycle
+//   1: Register after the multiplies, the DSP output register
+//   2: Also after the input subtracts, the DSP input register
+//   3: Also on the outputs
+// The results are the same, only PIPELINE_STAGES cycles later.
+
+`timescale 1ns / 1ps
+
+module edge_compute #(
+    parameter unsigned DATAWIDTH = 24,
+    parameter unsigned PIPELINE_STAGES = 0
+    ) (
+    /* verilator lint_off UNUSED */
+    input logic clk,    // Unused with PIPELINE_STAGES = 0
+    /* verilator lint_on UNUSED */
+
+    input logic signed [DATAWIDTH-1:0] v1[2],
+    input logic signed [DATAWIDTH-1:0] v2[2],
+    input logic signed [DATAWIDTH-1:0] p[2],
+
+    output logic signed [2*DATAWIDTH-1:0] edge_function,
+    output logic signed [DATAWIDTH-1:0] edge_delta[2]
+    );
+
+    // One bit more, so the differences can not overflow
+    logic signed [DATAWIDTH:0] w_diff[4];
+    logic signed [DATAWIDTH:0] s_diff[4];
+
+    logic signed [2*DATAWIDTH-1:0] w_product[2];
+    logic signed [2*DATAWIDTH-1:0] s_product[2];
+    logic signed [DATAWIDTH-1:0] w_delta[2];
+    logic signed [DATAWIDTH-1:0] s_delta[2];
+
+    logic signed [2*DATAWIDTH-1:0] w_edge_function;
+
+    // Subtract
+    always_comb begin
+        w_diff[0] = p[0] - v1[0];
+        w_diff[1] = v2[1] - v1[1];
+        w_diff[2] = p[1] - v1[1];
+        w_diff[3] = v2[0] - v1[0];
+    end
+
+    generate
+        if (PIPELINE_STAGES >= 2) begin : g_diff_reg
+            always_ff @(posedge clk) s_diff <= w_diff;
+        end else begin : g_diff_comb
+            always_comb s_diff = w_diff;
+        end
+    endgenerate
+
+    // Multiply, truncated to the output width like the single cycle version
+    /* verilator lint_off WIDTH */
+    always_comb begin
+        w_product[0] = s_diff[0] * s_diff[1];
+        w_product[1] = s_diff[2] * s_diff[3];
+        w_delta = '{s_diff[1], -s_diff[3]};
+    end
+    /* verilator lint_on WIDTH */
+
+    generate
+        if (PIPELINE_STAGES >= 1) begin : g_product_reg
+            always_ff @(posedge clk) begin
+                s_product <= w_product;
+                s_delta <= w_delta;
+            end
+        end else begin : g_product_comb
+            always_comb begin
+                s_product = w_product;
+                s_delta = w_delta;
+            end
+        end
+    endgenerate
+
+    // Subtract
+    always_comb begin
+        w_edge_function = s_product[0] - s_product[1];
+    end
+
+    generate
+        if (PIPELINE_STAGES >= 3) begin : g_output_reg
+            always_ff @(posedge clk) begin
+                edge_function <= w_edge_function;
+                edge_delta <= s_delta;
+            end
+        end else begin : g_output_comb
+            always_comb begin
+                edge_function = w_edge_function;
+                edge_delta = s_delta;
+            end
+        end
+    endgenerate
+
+endmodule
@@ -0,0 +1,118 @@
+#include <stdlib.h>
+#include <cstdlib>
+#include <cstdint>
+#include <deque>
+#include <verilated.h>
+#include <verilated_vcd_c.h>
+#include "obj_dir/Vedge_compute.h"
+
+#ifndef DATAWIDTH
+#define DATAWIDTH 12
+#endif
+#ifndef PIPELINE_STAGES
+#define PIPELINE_STAGES 0
+#endif
+
+#define DATA_MASK ((1LL << DATAWIDTH) - 1)
+#define EDGE_MASK ((1LL << (2 * DATAWIDTH)) - 1)
+
+#define NUM_CLKS 4000
+#define MAX_SIM_TIME (2 * (NUM_CLKS + PIPELINE_STAGES))
+
+vluint64_t sim_time = 0;
+
+typedef struct {
+    int64_t v1[2];
+    int64_t v2[2];
+    int64_t p[2];
+} EdgeInput;
+
+typedef struct {
+    int64_t edge_function;
+    int64_t edge_delta[2];
+} EdgeOutput;
+
+// The single cycle edge function, truncated to the output widths
+EdgeOutput edge_compute(const EdgeInput& in) {
+    EdgeOutput out;
+    out.edge_function = (((in.p[0] - in.v1[0]) * (in.v2[1] - in.v1[1])) -
+                         ((in.p[1] - in.v1[1]) * (in.v2[0] - in.v1[0]))) & EDGE_MASK;
+    out.edge_delta[0] = (in.v2[1] - in.v1[1]) & DATA_MASK;
+    out.edge_delta[1] = -(in.v2[0] - in.v1[0]) & DATA_MASK;
+    return out;
+}
+
+// Mostly screen coordinates, sometimes the extremes, so the truncation of
+// overflowing products is covered as well
+int64_t random_coord() {
+    switch (rand() % 8) {
+        case 0: return -(1LL << (DATAWIDTH - 1));
+        case 1: return (1LL << (DATAWIDTH - 1)) - 1;
+        case 2: return rand() % (1 << DATAWIDTH) - (1 << (DATAWIDTH - 1));
+        default: return rand() % 320;
+    }
+}
+
+int main(int argc, char** argv) {
+    srand(time(NULL));
+    Verilated::commandArgs(argc, argv);
+
+    Vedge_compute* dut = new Vedge_compute;
+
+    Verilated::traceEverOn(true);
+    VerilatedVcdC* m_trace = new VerilatedVcdC;
+    dut->trace(m_trace, 5);
+    m_trace->open("waveform.vcd");
+
+    // A new edge every cycle. The outputs have to match the single cycle
+    // edge function of the input from PIPELINE_STAGES cycles ago.
+    int errors = 0;
+    std::deque<EdgeInput> in_flight;
+    dut->clk = 0;
+    while (sim_time < MAX_SIM_TIME) {
+        dut->clk ^= 1;
+        dut->eval();
+
+        if (dut->clk == 1) {
+            EdgeInput in;
+            for (int i = 0; i < 2; i++) {
+                in.v1[i] = random_coord();
+                in.v2[i] = random_coord();
+                in.p[i] = random_coord();
+
+                dut->v1[i] = in.v1[i] & DATA_MASK;
+                dut->v2[i] = in.v2[i] & DATA_MASK;
+                dut->p[i] = in.p[i] & DATA_MASK;
+            }
+            dut->eval();
+
+            in_flight.push_back(in);
+            if ((int)in_flight.size() > PIPELINE_STAGES) {
+                EdgeOutput expected = edge_compute(in_flight.front());
+                in_flight.pop_front();
+
+                if ((int64_t)(dut->edge_function & EDGE_MASK) != expected.edge_function ||
+                    (int64_t)(dut->edge_delta[0] & DATA_MASK) != expected.edge_delta[0] ||
+                    (int64_t)(dut->edge_delta[1] & DATA_MASK) != expected.edge_delta[1]) {
+                    printf("Error: expected %lld (%lld, %lld), got %lld (%lld, %lld)\n",
+                           (long long)expected.edge_function,
+                           (long long)expected.edge_delta[0], (long long)expected.edge_delta[1],
+                           (long long)(dut->edge_function & EDGE_MASK),
+                           (long long)(dut->edge_delta[0] & DATA_MASK),
+                           (long long)(dut->edge_delta[1] & DATA_MASK));
+                    errors++;
+                }
+            }
+        }
+
+        m_trace->dump(sim_time);
+        sim_time++;
+    }
+
+    m_trace->close();
+    printf("%s: %d errors\n", errors ? "FAILED" : "PASSED", errors);
+
+    delete dut;
+
+    exit(errors ? EXIT_FAILURE : EXIT_SUCCESS);
+}
@@ -1,37 +1,23 @@
 `timescale 1ns / 1ps
 /* verilator lint_off UNUSED */
 
-/* verilator lint_off DECLFILENAME */
-module edge_compute #(
-    parameter unsigned DATAWIDTH = 24
-    ) (
-    input logic signed [DATAWIDTH-1:0] v1[2],
-    input logic signed [DATAWIDTH-1:0] v2[2],
-    input logic signed [DATAWIDTH-1:0] p[2],
-
-    output logic signed [2*DATAWIDTH-1:0] edge_function,
-    output logic signed [DATAWIDTH-1:0] edge_delta[2]
-    );
-
-    /* verilator lint_off WIDTH */
-    always_comb begin
-        edge_function = ((p[0] - v1[0]) * (v2[1] - v1[1])) - ((p[1] - v1[1]) * (v2[0] - v1[0]));
-        edge_delta = '{v2[1] - v1[1], -(v2[0] - v1[0])};
-    end
-    /* verilator lint_on WIDTH */
-endmodule
-/* verilator lint_on DECLFILENAME */
-
 module rasterizer_frontend #(
     parameter unsigned DATAWIDTH = 12,
     parameter signed [DATAWIDTH-1:0] SCREEN_WIDTH = 320,
     parameter signed [DATAWIDTH-1:0] SCREEN_HEIGHT = 320,
-    parameter unsigned IDWIDTH = 4
+    parameter unsigned IDWIDTH = 4,
+
+    // Pipeline registers in edge_compute and bounding_box, 0 to 3. Each edge
+    // function then takes EDGE_PIPELINE_STAGES cycles more, and the area
+    // the larger of the two. More would also miss the area reciprocal, which
+    // is only taken in REGISTER_AREA_RECIPROCAL.
+    parameter unsigned EDGE_PIPELINE_STAGES = 0,
+    parameter unsigned BBOX_PIPELINE_STAGES = 0
     ) (
     input logic clk,
     input logic rstn,
 
-    output logic ready,
+    output logic ready,  // Triangle is taken when i_triangle_dv and ready
     input  logic next,   // Can safely output next triangle
 
     input logic signed [DATAWIDTH-1:0] i_v0[3],
@@ -40,6 +26,9 @@ module rasterizer_frontend #(
     input logic i_triangle_dv,
     input logic i_triangle_last,
 
+    // Dynamic resolution, the viewport is the top left SCREEN >> i_res_shift
+    input logic [1:0] i_res_shift,
+
     output logic signed [DATAWIDTH-1:0] bb_tl[2],
     output logic signed [DATAWIDTH-1:0] bb_br[2],
     output logic signed [2*DATAWIDTH-1:0] edge_val0,
@@ -55,7 +44,11 @@ module rasterizer_frontend #(
     output logic [IDWIDTH-1:0] id,
     output logic o_dv,
     output logic o_last,
-    output logic finished_with_cull
+    output logic finished_with_cull,
+
+    // Performance counter events: [0] culled backface, [1] culled by the
+    // bounding box, [2] stalled on the back-end
+    output logic [2:0] o_perf_events
     );
 
     // Register input data
@@ -83,8 +76,11 @@ module rasterizer_frontend #(
     logic signed [DATAWIDTH-1:0] w_edge_function_delta[2];
 
     edge_compute #(
-        .DATAWIDTH(DATAWIDTH)
+        .DATAWIDTH(DATAWIDTH),
+        .PIPELINE_STAGES(EDGE_PIPELINE_STAGES)
     ) edge_compute_inst (
+        .clk(clk),
+
         .v1(r_edge_function_v1),
         .v2(r_edge_function_v2),
         .p(r_edge_function_p),
@@ -97,6 +93,9 @@ module rasterizer_frontend #(
     logic signed [DATAWIDTH-1:0] w_bb_br[2];
     logic w_bb_valid;
 
+    logic signed [DATAWIDTH-1:0] w_bb_screen_br[2];
+    logic w_bb_screen_valid;
+
     logic signed [DATAWIDTH-1:0] r_bb_tl[2];
     logic signed [DATAWIDTH-1:0] r_bb_br[2];
     logic r_bb_valid;
@@ -106,8 +105,11 @@ module rasterizer_frontend #(
         .TILE_MAX_X (SCREEN_WIDTH),
         .TILE_MIN_Y (0),
         .TILE_MAX_Y (SCREEN_HEIGHT),
-        .COORD_WIDTH(DATAWIDTH)
+        .COORD_WIDTH(DATAWIDTH),
+        .PIPELINE_STAGES(BBOX_PIPELINE_STAGES)
     ) bounding_box_inst (
+        .clk(clk),
+
         .x0(r_v0[0]),
         .y0(r_v0[1]),
         .x1(r_v1[0]),
@@ -116,13 +118,26 @@ module rasterizer_frontend #(
         .y2(r_v2[1]),
 
         .min_x(w_bb_tl[0]),
-        .max_x(w_bb_br[0]),
+        .max_x(w_bb_screen_br[0]),
         .min_y(w_bb_tl[1]),
-        .max_y(w_bb_br[1]),
+        .max_y(w_bb_screen_br[1]),
 
-        .valid(w_bb_valid)
+        .valid(w_bb_screen_valid)
     );
 
+    // Clamp to the reduced viewport
+    logic signed [DATAWIDTH-1:0] w_viewport_br[2];
+    always_comb begin
+        w_viewport_br[0] = SCREEN_WIDTH >>> i_res_shift;
+        w_viewport_br[1] = SCREEN_HEIGHT >>> i_res_shift;
+
+        foreach (w_bb_br[i]) begin
+            w_bb_br[i] = (w_bb_screen_br[i] > w_viewport_br[i]) ? w_viewport_br[i] : w_bb_screen_br[i];
+        end
+
+        w_bb_valid = w_bb_screen_valid && (w_bb_tl[0] < w_bb_br[0]) && (w_bb_tl[1] < w_bb_br[1]);
+    end
+
     // DIVIDER UNIT
     logic w_area_division_ready;
     logic [2*DATAWIDTH-1:0] r_area_division_in_A;
@@ -186,21 +201,42 @@ module rasterizer_frontend #(
         end
     end
 
+    // Cycles in the current state, for the results of the pipelined edge
+    // function and bounding box. Their inputs are held until then.
+    localparam unsigned AREA_LATENCY = (EDGE_PIPELINE_STAGES > BBOX_PIPELINE_STAGES) ?
+                                       EDGE_PIPELINE_STAGES : BBOX_PIPELINE_STAGES;
+    logic [1:0] r_wait_cnt;
+    logic [1:0] w_wait_target;
+    logic w_wait_done;
+    always_comb begin
+        w_wait_target = (current_state == COMPUTE_AREA) ? 2'(AREA_LATENCY) : 2'(EDGE_PIPELINE_STAGES);
+        w_wait_done = (r_wait_cnt == w_wait_target);
+    end
+
+    always_ff @(posedge clk) begin
+        if (~rstn || next_state != current_state) begin
+            r_wait_cnt <= '0;
+        end else if (~w_wait_done) begin
+            r_wait_cnt <= r_wait_cnt + 1;
+        end
+    end
+
     always_comb begin
         next_state = current_state;
         ready = 1'b0;
 
         case (current_state)
             IDLE: begin
+                ready = 1'b1;
                 if (i_triangle_dv) begin
                     next_state = COMPUTE_AREA;
-                end else begin
-                    ready = 1'b1;
                 end
             end
 
             COMPUTE_AREA: begin
-                next_state = COMPUTE_EDGE_0;
+                if (w_wait_done) begin
+                    next_state = COMPUTE_EDGE_0;
+                end
             end
 
             COMPUTE_EDGE_0: begin
@@ -208,17 +244,21 @@ module rasterizer_frontend #(
                     if (next) begin
                         next_state = IDLE;
                     end
-                end else if (w_area_division_ready) begin
+                end else if (w_area_division_ready && w_wait_done) begin
                     next_state = COMPUTE_EDGE_1;
                 end
             end
 
             COMPUTE_EDGE_1: begin
-                next_state = COMPUTE_EDGE_2;
+                if (w_wait_done) begin
+                    next_state = COMPUTE_EDGE_2;
+                end
             end
 
             COMPUTE_EDGE_2: begin
-                next_state = REGISTER_AREA_RECIPROCAL;
+                if (w_wait_done) begin
+                    next_state = REGISTER_AREA_RECIPROCAL;
+                end
             end
 
             REGISTER_AREA_RECIPROCAL: begin
@@ -247,6 +287,13 @@ module rasterizer_frontend #(
         endcase
     end
 
+    // Performance counter events
+    always_comb begin
+        o_perf_events[0] = (current_state == COMPUTE_EDGE_0) && w_should_be_culled && r_bb_valid && next;
+        o_perf_events[1] = (current_state == COMPUTE_EDGE_0) && ~r_bb_valid && next;
+        o_perf_events[2] = ((current_state == COMPUTE_EDGE_0 && w_should_be_culled) || current_state == DONE) && ~next;
+    end
+
     always_ff @(posedge clk) begin
         if (~rstn) begin
             foreach (r_v0[i]) r_v0[i] <= '0;
@@ -324,17 +371,19 @@ module rasterizer_frontend #(
                 end
 
                 COMPUTE_AREA: begin
-                    r_area <= w_edge_function_val;
+                    if (w_wait_done) begin
+                        r_area <= w_edge_function_val;
 
-                    // Bounding box
-                    foreach (r_bb_tl[i]) r_bb_tl[i] <= w_bb_tl[i];
-                    foreach (r_bb_br[i]) r_bb_br[i] <= w_bb_br[i];
-                    r_bb_valid <= w_bb_valid;
+                        // Bounding box
+                        foreach (r_bb_tl[i]) r_bb_tl[i] <= w_bb_tl[i];
+                        foreach (r_bb_br[i]) r_bb_br[i] <= w_bb_br[i];
+                        r_bb_valid <= w_bb_valid;
 
-                    // For next compute
-                    r_edge_function_v1 <= '{r_v0[0], r_v0[1]};
-                    r_edge_function_v2 <= '{r_v1[0], r_v1[1]};
-                    r_edge_function_p  <= w_bb_tl;
+                        // For next compute
+                        r_edge_function_v1 <= '{r_v0[0], r_v0[1]};
+                        r_edge_function_v2 <= '{r_v1[0], r_v1[1]};
+                        r_edge_function_p  <= w_bb_tl;
+                    end
                 end
 
                 COMPUTE_EDGE_0: begin
@@ -350,7 +399,7 @@ module rasterizer_frontend #(
                     r_edge_delta0 <= w_edge_function_delta;
 
                     // Area reciprocal compute
-                    if (w_area_division_ready) begin
+                    if (w_area_division_ready && w_wait_done) begin
                         r_area_division_in_A <= r_area;
                         r_area_division_in_A_dv <= 1'b1;
 
@@ -369,9 +418,11 @@ module rasterizer_frontend #(
                     r_edge_delta1 <= w_edge_function_delta;
 
                     // For next compute
-                    r_edge_function_v1 <= '{r_v2[0], r_v2[1]};
-                    r_edge_function_v2 <= '{r_v0[0], r_v0[1]};
-                    r_edge_function_p  <= r_bb_tl;
+                    if (w_wait_done) begin
+                        r_edge_function_v1 <= '{r_v2[0], r_v2[1]};
+                        r_edge_function_v2 <= '{r_v0[0], r_v0[1]};
+                        r_edge_function_p  <= r_bb_tl;
+                    end
                 end
 
                 COMPUTE_EDGE_2: begin
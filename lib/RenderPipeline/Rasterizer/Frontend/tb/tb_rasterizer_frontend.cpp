@@ -72,6 +72,7 @@ int main(int argc, char** argv) {
         dut->eval();
     
         dut->i_triangle_dv = 0;
+        dut->i_res_shift = 0;
         for (int i = 0; i < 3; i++) {
             dut->i_v0[i] = 0;
             dut->i_v1[i] = 0;
@@ -0,0 +1,729 @@
+`timescale 1ns / 1ps
+
+// Sort-middle (binned) rasterizer backend, used in place of
+// rasterizer_backend when a full screen depth buffer does not fit on chip.
+//
+// A frame is rendered in two phases:
+//  1. Binning. The triangle setup from the frontend is stored, and the
+//     triangle is added to the list of every tile its bounding box overlaps.
+//  2. The tiles are rasterized one at a time into a small colour and depth
+//     tile buffer. A finished tile is written out to the framebuffer, colour
+//     only, while the next tile is rasterized into a second tile buffer.
+//
+// Every framebuffer pixel is written once per frame, so the framebuffer does
+// not have to be cleared and depth never leaves the chip.
+//
+// Tile lists are built by pushing to the front, so the triangles of a tile are
+// rasterized in reverse order. With the depth test this only matters for
+// pixels where two triangles have exactly the same depth. Triangles or list
+// entries beyond MAX_TRIANGLES or MAX_BIN_ENTRIES are dropped.
+//
+// For beam racing the tiles are full width scanline bands. Tile n is only
+// written out once i_write_limit > n, such that a band is not overwritten
+// before it has been scanned out, and with FB_WRAP_ROWS the framebuffer
+// address wraps into a ring of band buffers.
+module rasterizer_tile_backend #(
+    parameter unsigned DATAWIDTH = 12,
+    parameter unsigned COLORWIDTH = 4,
+    parameter unsigned SCREEN_WIDTH = 640,
+    parameter unsigned SCREEN_HEIGHT = 480,
+    parameter unsigned ADDRWIDTH = $clog2(SCREEN_WIDTH * SCREEN_HEIGHT),
+    parameter unsigned IDWIDTH = 4,
+
+    parameter unsigned TILE_WIDTH = 32,     // Power of two
+    parameter unsigned TILE_HEIGHT = 32,    // Power of two
+    parameter unsigned MAX_TRIANGLES = 1024,
+    parameter unsigned MAX_BIN_ENTRIES = 4096,
+    parameter unsigned FB_WRAP_ROWS = 0,    // Framebuffer rows before the address wraps, 0: never
+
+    parameter unsigned COLOR_CLEAR_VALUE = 0,
+    parameter unsigned DEPTH_CLEAR_VALUE = {DATAWIDTH{1'b1}}
+    ) (
+    input logic clk,
+    input logic rstn,
+
+    // Triangle setup from the rasterizer frontend
+    input logic signed [DATAWIDTH-1:0] bb_tl[2],
+    input logic signed [DATAWIDTH-1:0] bb_br[2],
+
+    input logic signed [2*DATAWIDTH-1:0] edge_val0,
+    input logic signed [2*DATAWIDTH-1:0] edge_val1,
+    input logic signed [2*DATAWIDTH-1:0] edge_val2,
+
+    input logic signed [DATAWIDTH-1:0] edge_delta0[2],
+    input logic signed [DATAWIDTH-1:0] edge_delta1[2],
+    input logic signed [DATAWIDTH-1:0] edge_delta2[2],
+
+    input logic signed [DATAWIDTH-1:0] z,
+    input logic signed [DATAWIDTH-1:0] z_delta[2],
+    input logic [IDWIDTH-1:0] id,
+    input logic i_dv,
+    input logic i_last,
+    input logic i_flush,        // The last triangle was culled by the frontend
+
+    input logic [DATAWIDTH-1:0] i_write_limit,  // Tiles below this may be written out
+
+    output logic [ADDRWIDTH-1:0] o_fb_addr_write,
+    output logic o_fb_write_en,
+
+    output logic [DATAWIDTH-1:0] depth_data,
+    output logic [COLORWIDTH-1:0] color_data,
+
+    output logic ready,
+    output logic finished,
+
+    // Performance counter events: [0] pixel tested, [1] pixel passed the
+    // depth test
+    output logic [1:0] o_perf_events
+    );
+
+    localparam unsigned NUM_TILES_X = (SCREEN_WIDTH + TILE_WIDTH - 1) / TILE_WIDTH;
+    localparam unsigned NUM_TILES_Y = (SCREEN_HEIGHT + TILE_HEIGHT - 1) / TILE_HEIGHT;
+    localparam unsigned NUM_TILES = NUM_TILES_X * NUM_TILES_Y;
+
+    localparam unsigned TILE_X_BITS = $clog2(TILE_WIDTH);
+    localparam unsigned TILE_Y_BITS = $clog2(TILE_HEIGHT);
+    localparam unsigned TILE_DEPTH = TILE_WIDTH * TILE_HEIGHT;
+    localparam unsigned TILE_ADDR_WIDTH = TILE_X_BITS + TILE_Y_BITS;
+
+    localparam unsigned TILE_INDEX_WIDTH = (NUM_TILES > 1) ? $clog2(NUM_TILES) : 1;
+    localparam unsigned TRIANGLE_INDEX_WIDTH = $clog2(MAX_TRIANGLES);
+    localparam unsigned NODE_INDEX_WIDTH = $clog2(MAX_BIN_ENTRIES);
+
+    // {bb_tl, bb_br, edge_val0-2, edge_delta0-2, z, z_delta, id}
+    localparam unsigned TRIANGLE_WIDTH = 13 * DATAWIDTH + 6 * DATAWIDTH + IDWIDTH;
+
+    // {triangle, next valid, next}
+    localparam unsigned NODE_WIDTH = TRIANGLE_INDEX_WIDTH + 1 + NODE_INDEX_WIDTH;
+
+    // Tile of a screen coordinate, clamped to the tile grid
+    function automatic logic [DATAWIDTH-1:0] tile_of(
+        input logic signed [DATAWIDTH-1:0] coord,
+        input int unsigned bits,
+        input int unsigned num_tiles
+    );
+        logic [DATAWIDTH-1:0] tile;
+
+        if (coord < 0) begin
+            return '0;
+        end
+
+        tile = $unsigned(coord) >> bits;
+        return (tile > DATAWIDTH'(num_tiles - 1)) ? DATAWIDTH'(num_tiles - 1) : tile;
+    endfunction
+
+    // n * delta, for moving an edge function n pixels
+    function automatic logic signed [2*DATAWIDTH-1:0] edge_step(
+        input logic signed [DATAWIDTH-1:0] n,
+        input logic signed [DATAWIDTH-1:0] delta
+    );
+        logic signed [2*DATAWIDTH-1:0] n_ext;
+        logic signed [2*DATAWIDTH-1:0] delta_ext;
+
+        n_ext = {{DATAWIDTH{n[DATAWIDTH-1]}}, n};
+        delta_ext = {{DATAWIDTH{delta[DATAWIDTH-1]}}, delta};
+        return n_ext * delta_ext;
+    endfunction
+
+    function automatic logic signed [2*DATAWIDTH-1:0] sext(
+        input logic signed [DATAWIDTH-1:0] value
+    );
+        return {{DATAWIDTH{value[DATAWIDTH-1]}}, value};
+    endfunction
+
+    // Binning state
+    logic [TRIANGLE_INDEX_WIDTH:0] r_triangle_count;
+    logic [NODE_INDEX_WIDTH:0] r_node_count;
+    logic [TRIANGLE_INDEX_WIDTH-1:0] r_bin_triangle;
+    logic r_bin_last;
+    logic [DATAWIDTH-1:0] r_bin_tx, r_bin_tx0, r_bin_tx1;
+    logic [DATAWIDTH-1:0] r_bin_ty, r_bin_ty1;
+    logic [TILE_INDEX_WIDTH-1:0] r_bin_tile, r_bin_row_tile;
+
+    // ========== TRIANGLE STORE ==========
+    logic r_triangle_write_en;
+    logic [TRIANGLE_INDEX_WIDTH-1:0] r_triangle_addr_write;
+    logic [TRIANGLE_WIDTH-1:0] r_triangle_data_write;
+    logic [TRIANGLE_INDEX_WIDTH-1:0] w_triangle_addr_read;
+    logic [TRIANGLE_WIDTH-1:0] w_triangle_data_read;
+
+    bram_dp #(
+        .WIDTH(TRIANGLE_WIDTH),
+        .DEPTH(MAX_TRIANGLES)
+    ) triangle_store_inst (
+        .clk_write(clk),
+        .clk_read(clk),
+        .write_enable(r_triangle_write_en),
+        .addr_write(r_triangle_addr_write),
+        .addr_read(w_triangle_addr_read),
+        .data_in(r_triangle_data_write),
+        .data_out(w_triangle_data_read)
+    );
+
+    logic signed [DATAWIDTH-1:0] w_t_bb_tl[2];
+    logic signed [DATAWIDTH-1:0] w_t_bb_br[2];
+    logic signed [2*DATAWIDTH-1:0] w_t_edge_val[3];
+    logic signed [DATAWIDTH-1:0] w_t_edge_delta[3][2];
+    logic signed [DATAWIDTH-1:0] w_t_z;
+    logic signed [DATAWIDTH-1:0] w_t_z_delta[2];
+    logic [IDWIDTH-1:0] w_t_id;
+
+    assign {w_t_bb_tl[0], w_t_bb_tl[1], w_t_bb_br[0], w_t_bb_br[1],
+            w_t_edge_val[0], w_t_edge_val[1], w_t_edge_val[2],
+            w_t_edge_delta[0][0], w_t_edge_delta[0][1],
+            w_t_edge_delta[1][0], w_t_edge_delta[1][1],
+            w_t_edge_delta[2][0], w_t_edge_delta[2][1],
+            w_t_z, w_t_z_delta[0], w_t_z_delta[1], w_t_id} = w_triangle_data_read;
+
+    // ========== TILE LISTS ==========
+    // Linked lists, the head of each tile is only valid if the tile is used
+    logic [NUM_TILES-1:0] r_tile_used;
+
+    logic w_head_write_en;
+    logic [TILE_INDEX_WIDTH-1:0] w_head_addr_read;
+    logic [NODE_INDEX_WIDTH-1:0] w_head_data_read;
+
+    bram_dp #(
+        .WIDTH(NODE_INDEX_WIDTH),
+        .DEPTH(NUM_TILES)
+    ) tile_head_inst (
+        .clk_write(clk),
+        .clk_read(clk),
+        .write_enable(w_head_write_en),
+        .addr_write(r_bin_tile),
+        .addr_read(w_head_addr_read),
+        .data_in(r_node_count[NODE_INDEX_WIDTH-1:0]),
+        .data_out(w_head_data_read)
+    );
+
+    logic [NODE_WIDTH-1:0] w_node_data_write;
+    logic [NODE_INDEX_WIDTH-1:0] r_node;
+    logic [NODE_WIDTH-1:0] w_node_data_read;
+
+    bram_dp #(
+        .WIDTH(NODE_WIDTH),
+        .DEPTH(MAX_BIN_ENTRIES)
+    ) tile_node_inst (
+        .clk_write(clk),
+        .clk_read(clk),
+        .write_enable(w_head_write_en),
+        .addr_write(r_node_count[NODE_INDEX_WIDTH-1:0]),
+        .addr_read(r_node),
+        .data_in(w_node_data_write),
+        .data_out(w_node_data_read)
+    );
+
+    logic [TRIANGLE_INDEX_WIDTH-1:0] w_node_triangle;
+    logic w_node_next_valid;
+    logic [NODE_INDEX_WIDTH-1:0] w_node_next;
+    assign {w_node_triangle, w_node_next_valid, w_node_next} = w_node_data_read;
+    assign w_triangle_addr_read = w_node_triangle;
+
+    // ========== TILE BUFFERS ==========
+    // Two sets, one is rasterized to while the other is written out to the
+    // framebuffer. Writing out clears the buffer behind the read.
+    logic r_raster_buf = 1'b0;
+
+    logic w_tile_write_en[2];
+    logic [TILE_ADDR_WIDTH-1:0] w_tile_addr_write[2];
+    logic [COLORWIDTH-1:0] w_tile_color_write[2];
+    logic [DATAWIDTH-1:0] w_tile_depth_write[2];
+    logic [COLORWIDTH-1:0] w_tile_color_read[2];
+    logic [DATAWIDTH-1:0] w_tile_depth_read[2];
+
+    logic [TILE_ADDR_WIDTH-1:0] w_raster_addr;
+    logic [TILE_ADDR_WIDTH-1:0] r_resolve_addr;
+
+    generate
+        for (genvar i = 0; i < 2; i++) begin : g_tile_buffer
+            bram_dp #(
+                .WIDTH(COLORWIDTH),
+                .DEPTH(TILE_DEPTH)
+            ) tile_color_inst (
+                .clk_write(clk),
+                .clk_read(clk),
+                .write_enable(w_tile_write_en[i]),
+                .addr_write(w_tile_addr_write[i]),
+                .addr_read(r_resolve_addr),
+                .data_in(w_tile_color_write[i]),
+                .data_out(w_tile_color_read[i])
+            );
+
+            bram_dp #(
+                .WIDTH(DATAWIDTH),
+                .DEPTH(TILE_DEPTH)
+            ) tile_depth_inst (
+                .clk_write(clk),
+                .clk_read(clk),
+                .write_enable(w_tile_write_en[i]),
+                .addr_write(w_tile_addr_write[i]),
+                .addr_read(w_raster_addr),
+                .data_in(w_tile_depth_write[i]),
+                .data_out(w_tile_depth_read[i])
+            );
+        end
+    endgenerate
+
+    // ========== STATE ==========
+    typedef enum logic [3:0] {
+        INIT_CLEAR,         // Clear both tile buffers after reset
+        BIN,                // Wait for the next triangle
+        BIN_HEAD_READ,
+        BIN_WRITE,          // Push the triangle to the front of a tile list
+        TILE_START,
+        TILE_HEAD_READ,
+        NODE_READ,
+        NODE_WAIT,
+        TRIANGLE_WAIT,
+        TRIANGLE_CLIP,      // Move the triangle setup to the tile's corner
+        RASTERIZE,
+        TILE_DRAIN,
+        TILE_DONE,
+        FRAME_DONE
+    } state_t;
+    state_t current_state = INIT_CLEAR, next_state;
+
+    logic [DATAWIDTH-1:0] w_bin_tx0, w_bin_tx1, w_bin_ty0, w_bin_ty1;
+    logic [TILE_INDEX_WIDTH-1:0] w_bin_tile;
+    logic w_bin_store;
+    logic w_bin_tile_last;
+
+    always_comb begin
+        w_bin_tx0 = tile_of(bb_tl[0], TILE_X_BITS, NUM_TILES_X);
+        w_bin_tx1 = tile_of(bb_br[0], TILE_X_BITS, NUM_TILES_X);
+        w_bin_ty0 = tile_of(bb_tl[1], TILE_Y_BITS, NUM_TILES_Y);
+        w_bin_ty1 = tile_of(bb_br[1], TILE_Y_BITS, NUM_TILES_Y);
+        w_bin_tile = TILE_INDEX_WIDTH'(w_bin_ty0 * NUM_TILES_X + w_bin_tx0);
+
+        w_bin_store = r_triangle_count < (TRIANGLE_INDEX_WIDTH+1)'(MAX_TRIANGLES);
+        w_bin_tile_last = (r_bin_tx == r_bin_tx1) && (r_bin_ty == r_bin_ty1);
+    end
+
+    // New list entry and head, written at the end of BIN_WRITE so that the
+    // lists are complete when the first tile is started
+    assign w_head_write_en = (current_state == BIN_WRITE) &&
+                             (r_node_count < (NODE_INDEX_WIDTH+1)'(MAX_BIN_ENTRIES));
+    assign w_node_data_write = {r_bin_triangle, r_tile_used[r_bin_tile], w_head_data_read};
+
+    // Tiles
+    logic [TILE_INDEX_WIDTH-1:0] r_tile;
+    logic [DATAWIDTH-1:0] r_tile_x, r_tile_y;
+    logic [ADDRWIDTH-1:0] r_tile_fb_addr, r_row_fb_addr;
+    logic signed [DATAWIDTH-1:0] w_tile_ox, w_tile_oy;
+
+    assign w_tile_ox = $signed(r_tile_x << TILE_X_BITS);
+    assign w_tile_oy = $signed(r_tile_y << TILE_Y_BITS);
+
+    // Triangle, clipped to the tile
+    logic r_next_valid;
+    logic [NODE_INDEX_WIDTH-1:0] r_next;
+
+    logic signed [DATAWIDTH-1:0] r_bb_tl[2];
+    logic signed [DATAWIDTH-1:0] r_bb_br[2];
+    logic signed [DATAWIDTH-1:0] r_clip_offset[2];
+    logic signed [2*DATAWIDTH-1:0] r_t_edge_val[3];
+    logic signed [DATAWIDTH-1:0] r_edge_delta[3][2];
+    logic signed [DATAWIDTH-1:0] r_t_z;
+    logic signed [DATAWIDTH-1:0] r_z_delta[2];
+    logic [COLORWIDTH-1:0] r_color;
+
+    logic signed [DATAWIDTH-1:0] w_clip_tl[2];
+    logic signed [DATAWIDTH-1:0] w_clip_br[2];
+
+    always_comb begin
+        w_clip_tl[0] = (w_t_bb_tl[0] > w_tile_ox) ? w_t_bb_tl[0] : w_tile_ox;
+        w_clip_tl[1] = (w_t_bb_tl[1] > w_tile_oy) ? w_t_bb_tl[1] : w_tile_oy;
+        w_clip_br[0] = (w_t_bb_br[0] < w_tile_ox + DATAWIDTH'(TILE_WIDTH - 1)) ?
+                       w_t_bb_br[0] : w_tile_ox + DATAWIDTH'(TILE_WIDTH - 1);
+        w_clip_br[1] = (w_t_bb_br[1] < w_tile_oy + DATAWIDTH'(TILE_HEIGHT - 1)) ?
+                       w_t_bb_br[1] : w_tile_oy + DATAWIDTH'(TILE_HEIGHT - 1);
+    end
+
+    // Pixel walk
+    logic signed [DATAWIDTH-1:0] r_x, r_y;
+    logic signed [2*DATAWIDTH-1:0] r_edge[3];
+    logic signed [2*DATAWIDTH-1:0] r_edge_row_start[3];
+    logic signed [DATAWIDTH-1:0] r_z, r_z_row_start;
+    logic w_inside;
+    logic w_last_pixel;
+
+    assign w_raster_addr = {r_y[TILE_Y_BITS-1:0], r_x[TILE_X_BITS-1:0]};
+    assign w_inside = (r_edge[0] > 0) && (r_edge[1] > 0) && (r_edge[2] > 0);
+    assign w_last_pixel = (r_x >= r_bb_br[0]) && (r_y >= r_bb_br[1]);
+
+    // Depth test, one cycle after the depth read
+    logic r_test_valid = 1'b0;
+    logic [TILE_ADDR_WIDTH-1:0] r_test_addr;
+    logic [DATAWIDTH-1:0] r_test_z;
+    logic w_test_pass;
+
+    assign w_test_pass = r_test_valid && (r_test_z < w_tile_depth_read[r_raster_buf]);
+
+    // Write out
+    logic r_resolve_active = 1'b0;
+    logic w_write_out;
+    logic [ADDRWIDTH-1:0] w_next_row_fb_addr;
+    logic r_resolve_buf;
+    logic [ADDRWIDTH-1:0] r_resolve_fb_addr;
+    logic [DATAWIDTH-1:0] r_resolve_x, r_resolve_y, r_resolve_ox;
+    logic r_out_buf;
+
+    logic [TILE_ADDR_WIDTH-1:0] r_init_addr;
+
+    always_ff @(posedge clk) begin
+        if (~rstn) begin
+            current_state <= INIT_CLEAR;
+        end else begin
+            current_state <= next_state;
+        end
+    end
+
+    always_comb begin
+        next_state = current_state;
+
+        case (current_state)
+            INIT_CLEAR: begin
+                if (r_init_addr == TILE_ADDR_WIDTH'(TILE_DEPTH - 1)) begin
+                    next_state = BIN;
+                end
+            end
+
+            BIN: begin
+                if (i_dv) begin
+                    if (w_bin_store) begin
+                        next_state = BIN_HEAD_READ;
+                    end else if (i_last) begin
+                        next_state = TILE_START;
+                    end
+                end else if (i_flush) begin
+                    next_state = TILE_START;
+                end
+            end
+
+            BIN_HEAD_READ: begin
+                next_state = BIN_WRITE;
+            end
+
+            BIN_WRITE: begin
+                if (~w_bin_tile_last) begin
+                    next_state = BIN_HEAD_READ;
+                end else if (r_bin_last) begin
+                    next_state = TILE_START;
+                end else begin
+                    next_state = BIN;
+                end
+            end
+
+            TILE_START: begin
+                next_state = r_tile_used[r_tile] ? TILE_HEAD_READ : TILE_DONE;
+            end
+
+            TILE_HEAD_READ: begin
+                next_state = NODE_READ;
+            end
+
+            NODE_READ: begin
+                next_state = NODE_WAIT;
+            end
+
+            NODE_WAIT: begin
+                next_state = TRIANGLE_WAIT;
+            end
+
+            TRIANGLE_WAIT: begin
+                next_state = TRIANGLE_CLIP;
+            end
+
+            TRIANGLE_CLIP: begin
+                if (r_bb_tl[0] <= r_bb_br[0] && r_bb_tl[1] <= r_bb_br[1]) begin
+                    next_state = RASTERIZE;
+                end else begin
+                    next_state = r_next_valid ? NODE_READ : TILE_DRAIN;
+                end
+            end
+
+            RASTERIZE: begin
+                if (w_last_pixel) begin
+                    next_state = r_next_valid ? NODE_READ : TILE_DRAIN;
+                end
+            end
+
+            TILE_DRAIN: begin
+                next_state = TILE_DONE;
+            end
+
+            TILE_DONE: begin
+                if (w_write_out) begin
+                    next_state = (r_tile == TILE_INDEX_WIDTH'(NUM_TILES - 1)) ? FRAME_DONE : TILE_START;
+                end
+            end
+
+            FRAME_DONE: begin
+                if (~r_resolve_active) begin
+                    next_state = BIN;
+                end
+            end
+
+            default: begin
+                next_state = INIT_CLEAR;
+            end
+        endcase
+    end
+
+    assign ready = (current_state == BIN);
+    assign w_head_addr_read = (current_state == BIN_HEAD_READ) ? r_bin_tile : r_tile;
+
+    // Performance counter events
+    assign o_perf_events[0] = (current_state == RASTERIZE);
+    assign o_perf_events[1] = w_test_pass;
+
+    always_ff @(posedge clk) begin
+        if (~rstn) begin
+            r_tile_used <= '0;
+            r_triangle_count <= '0;
+            r_node_count <= '0;
+            r_triangle_write_en <= 1'b0;
+
+            r_tile <= '0;
+            r_tile_x <= '0;
+            r_tile_y <= '0;
+            r_tile_fb_addr <= '0;
+            r_row_fb_addr <= '0;
+            r_raster_buf <= 1'b0;
+
+            r_init_addr <= '0;
+            r_test_valid <= 1'b0;
+            finished <= 1'b0;
+        end else begin
+            r_triangle_write_en <= 1'b0;
+            r_test_valid <= 1'b0;
+            finished <= 1'b0;
+
+            case (current_state)
+                INIT_CLEAR: begin
+                    r_init_addr <= r_init_addr + 1;
+                end
+
+                BIN: begin
+                    if (i_dv && w_bin_store) begin
+                        r_triangle_write_en <= 1'b1;
+                        r_triangle_addr_write <= r_triangle_count[TRIANGLE_INDEX_WIDTH-1:0];
+                        r_triangle_data_write <= {bb_tl[0], bb_tl[1], bb_br[0], bb_br[1],
+                                                  edge_val0, edge_val1, edge_val2,
+                                                  edge_delta0[0], edge_delta0[1],
+                                                  edge_delta1[0], edge_delta1[1],
+                                                  edge_delta2[0], edge_delta2[1],
+                                                  z, z_delta[0], z_delta[1], id};
+                        r_triangle_count <= r_triangle_count + 1;
+
+                        r_bin_triangle <= r_triangle_count[TRIANGLE_INDEX_WIDTH-1:0];
+                        r_bin_last <= i_last;
+                        r_bin_tx <= w_bin_tx0;
+                        r_bin_tx0 <= w_bin_tx0;
+                        r_bin_tx1 <= w_bin_tx1;
+                        r_bin_ty <= w_bin_ty0;
+                        r_bin_ty1 <= w_bin_ty1;
+                        r_bin_tile <= w_bin_tile;
+                        r_bin_row_tile <= w_bin_tile;
+                    end
+                end
+
+                BIN_WRITE: begin
+                    if (w_head_write_en) begin
+                        r_tile_used[r_bin_tile] <= 1'b1;
+                        r_node_count <= r_node_count + 1;
+                    end
+
+                    if (r_bin_tx != r_bin_tx1) begin
+                        r_bin_tx <= r_bin_tx + 1;
+                        r_bin_tile <= r_bin_tile + 1;
+                    end else begin
+                        r_bin_tx <= r_bin_tx0;
+                        r_bin_ty <= r_bin_ty + 1;
+                        r_bin_tile <= r_bin_row_tile + TILE_INDEX_WIDTH'(NUM_TILES_X);
+                        r_bin_row_tile <= r_bin_row_tile + TILE_INDEX_WIDTH'(NUM_TILES_X);
+                    end
+                end
+
+                TILE_HEAD_READ: begin
+                    r_node <= w_head_data_read;
+                end
+
+                NODE_WAIT: begin
+                    r_next_valid <= w_node_next_valid;
+                    r_next <= w_node_next;
+                end
+
+                TRIANGLE_WAIT: begin
+                    r_bb_tl <= w_clip_tl;
+                    r_bb_br <= w_clip_br;
+                    r_clip_offset[0] <= w_clip_tl[0] - w_t_bb_tl[0];
+                    r_clip_offset[1] <= w_clip_tl[1] - w_t_bb_tl[1];
+
+                    r_t_edge_val <= w_t_edge_val;
+                    r_edge_delta <= w_t_edge_delta;
+                    r_t_z <= w_t_z;
+                    r_z_delta <= w_t_z_delta;
+                    r_color <= (w_t_id[COLORWIDTH-1:0] == '0) ? COLORWIDTH'(1) : w_t_id[COLORWIDTH-1:0];
+                end
+
+                TRIANGLE_CLIP: begin
+                    r_x <= r_bb_tl[0];
+                    r_y <= r_bb_tl[1];
+
+                    for (int i = 0; i < 3; i++) begin
+                        r_edge[i] <= r_t_edge_val[i] +
+                                     edge_step(r_clip_offset[0], r_edge_delta[i][0]) +
+                                     edge_step(r_clip_offset[1], r_edge_delta[i][1]);
+                        r_edge_row_start[i] <= r_t_edge_val[i] +
+                                               edge_step(r_clip_offset[0], r_edge_delta[i][0]) +
+                                               edge_step(r_clip_offset[1], r_edge_delta[i][1]);
+                    end
+
+                    r_z <= r_t_z + DATAWIDTH'(edge_step(r_clip_offset[0], r_z_delta[0]) +
+                                              edge_step(r_clip_offset[1], r_z_delta[1]));
+                    r_z_row_start <= r_t_z + DATAWIDTH'(edge_step(r_clip_offset[0], r_z_delta[0]) +
+                                                        edge_step(r_clip_offset[1], r_z_delta[1]));
+
+                    if (r_next_valid) begin
+                        r_node <= r_next;
+                    end
+                end
+
+                RASTERIZE: begin
+                    r_test_valid <= w_inside;
+                    r_test_addr <= w_raster_addr;
+                    r_test_z <= $unsigned(r_z);
+
+                    if (r_x < r_bb_br[0]) begin
+                        r_x <= r_x + 1;
+                        r_z <= r_z + r_z_delta[0];
+                        for (int i = 0; i < 3; i++) begin
+                            r_edge[i] <= r_edge[i] + sext(r_edge_delta[i][0]);
+                        end
+                    end else begin
+                        r_x <= r_bb_tl[0];
+                        r_y <= r_y + 1;
+                        r_z <= r_z_row_start + r_z_delta[1];
+                        r_z_row_start <= r_z_row_start + r_z_delta[1];
+                        for (int i = 0; i < 3; i++) begin
+                            r_edge[i] <= r_edge_row_start[i] + sext(r_edge_delta[i][1]);
+                            r_edge_row_start[i] <= r_edge_row_start[i] + sext(r_edge_delta[i][1]);
+                        end
+                    end
+                end
+
+                TILE_DONE: begin
+                    if (w_write_out) begin
+                        r_raster_buf <= ~r_raster_buf;
+                        r_tile <= r_tile + 1;
+
+                        if (r_tile_x == DATAWIDTH'(NUM_TILES_X - 1)) begin
+                            r_tile_x <= '0;
+                            r_tile_y <= r_tile_y + 1;
+                            r_tile_fb_addr <= w_next_row_fb_addr;
+                            r_row_fb_addr <= w_next_row_fb_addr;
+                        end else begin
+                            r_tile_x <= r_tile_x + 1;
+                            r_tile_fb_addr <= r_tile_fb_addr + ADDRWIDTH'(TILE_WIDTH);
+                        end
+                    end
+                end
+
+                FRAME_DONE: begin
+                    if (~r_resolve_active) begin
+                        finished <= 1'b1;
+
+                        r_tile_used <= '0;
+                        r_triangle_count <= '0;
+                        r_node_count <= '0;
+
+                        r_tile <= '0;
+                        r_tile_x <= '0;
+                        r_tile_y <= '0;
+                        r_tile_fb_addr <= '0;
+                        r_row_fb_addr <= '0;
+                    end
+                end
+
+                default: begin
+                end
+            endcase
+        end
+    end
+
+    // ========== WRITE OUT ==========
+    // Reads the finished tile buffer and writes it to the framebuffer, one
+    // pixel per cycle. Pixels outside the screen are skipped.
+    always_ff @(posedge clk) begin
+        if (~rstn) begin
+            r_resolve_active <= 1'b0;
+            o_fb_write_en <= 1'b0;
+        end else begin
+            o_fb_write_en <= 1'b0;
+            r_out_buf <= r_resolve_buf;
+
+            if (r_resolve_active) begin
+                o_fb_write_en <= (r_resolve_x < DATAWIDTH'(SCREEN_WIDTH)) && (r_resolve_y < DATAWIDTH'(SCREEN_HEIGHT));
+                o_fb_addr_write <= r_resolve_fb_addr;
+
+                r_resolve_addr <= r_resolve_addr + 1;
+                if (r_resolve_addr[TILE_X_BITS-1:0] == TILE_X_BITS'(TILE_WIDTH - 1)) begin
+                    r_resolve_x <= r_resolve_ox;
+                    r_resolve_y <= r_resolve_y + 1;
+                    r_resolve_fb_addr <= r_resolve_fb_addr + ADDRWIDTH'(SCREEN_WIDTH - (TILE_WIDTH - 1));
+                end else begin
+                    r_resolve_x <= r_resolve_x + 1;
+                    r_resolve_fb_addr <= r_resolve_fb_addr + 1;
+                end
+
+                if (r_resolve_addr == TILE_ADDR_WIDTH'(TILE_DEPTH - 1)) begin
+                    r_resolve_active <= 1'b0;
+                end
+            end else if (current_state == TILE_DONE && w_write_out) begin
+                r_resolve_active <= 1'b1;
+                r_resolve_buf <= r_raster_buf;
+                r_resolve_addr <= '0;
+                r_resolve_fb_addr <= r_tile_fb_addr;
+                r_resolve_x <= $unsigned(w_tile_ox);
+                r_resolve_y <= $unsigned(w_tile_oy);
+                r_resolve_ox <= $unsigned(w_tile_ox);
+            end
+        end
+    end
+
+    assign w_write_out = ~r_resolve_active && (DATAWIDTH'(r_tile) < i_write_limit);
+
+    always_comb begin
+        w_next_row_fb_addr = r_row_fb_addr + ADDRWIDTH'(TILE_HEIGHT * SCREEN_WIDTH);
+        if (FB_WRAP_ROWS != 0 && w_next_row_fb_addr >= ADDRWIDTH'(FB_WRAP_ROWS * SCREEN_WIDTH)) begin
+            w_next_row_fb_addr = w_next_row_fb_addr - ADDRWIDTH'(FB_WRAP_ROWS * SCREEN_WIDTH);
+        end
+    end
+
+    assign color_data = w_tile_color_read[r_out_buf];
+    assign depth_data = DATAWIDTH'(DEPTH_CLEAR_VALUE);   // Depth stays in the tile buffers
+
+    // Tile buffer write ports: clear after reset, clear behind the write out,
+    // or depth test pass
+    always_comb begin
+        for (int i = 0; i < 2; i++) begin
+            w_tile_color_write[i] = COLORWIDTH'(COLOR_CLEAR_VALUE);
+            w_tile_depth_write[i] = DATAWIDTH'(DEPTH_CLEAR_VALUE);
+
+            if (current_state == INIT_CLEAR) begin
+                w_tile_write_en[i] = 1'b1;
+                w_tile_addr_write[i] = r_init_addr;
+            end else if (r_resolve_active && r_resolve_buf == 1'(i)) begin
+                w_tile_write_en[i] = 1'b1;
+                w_tile_addr_write[i] = r_resolve_addr;
+            end else begin
+                w_tile_write_en[i] = w_test_pass && (r_raster_buf == 1'(i));
+                w_tile_addr_write[i] = r_test_addr;
+                w_tile_color_write[i] = r_color;
+                w_tile_depth_write[i] = r_test_z;
+            end
+        end
+    end
+
+endmodule
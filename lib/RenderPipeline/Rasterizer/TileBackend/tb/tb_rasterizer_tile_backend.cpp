@@ -0,0 +1,238 @@
+#include <stdlib.h>
+#include <stdint.h>
+#include <cstdlib>
+#include <vector>
+#include <algorithm>
+#include <verilated.h>
+#include <verilated_vcd_c.h>
+#include "obj_dir/Vrasterizer_tile_backend.h"
+
+// SCREEN_WIDTH and SCREEN_HEIGHT are passed from the makefile
+#define DATAWIDTH 12
+#define COLORWIDTH 4
+#define DEPTH_CLEAR ((1 << DATAWIDTH) - 1)
+
+#define RESET_CLKS 8
+#define MAX_SIM_TIME (2 * 400000)
+
+vluint64_t sim_time = 0;
+vluint64_t posedge_cnt = 0;
+
+// Triangle setup as it comes out of the rasterizer frontend
+struct Setup {
+    int bb_tl[2];
+    int bb_br[2];
+    int64_t edge_val[3];
+    int edge_delta[3][2];
+    int z;
+    int z_delta[2];
+    int id;
+};
+
+// Edge function, positive on the inside
+int64_t edge(int xa, int ya, int xb, int yb, int x, int y) {
+    return (int64_t)(x - xa) * (yb - ya) - (int64_t)(y - ya) * (xb - xa);
+}
+
+int clamp(int v, int lo, int hi) {
+    return v < lo ? lo : (v > hi ? hi : v);
+}
+
+Setup random_setup(int id) {
+    Setup s;
+    int vx[3], vy[3];
+    int64_t area;
+
+    // Small triangles, some of them past the right and bottom edge
+    do {
+        int ox = rand() % SCREEN_WIDTH;
+        int oy = rand() % SCREEN_HEIGHT;
+        for (int i = 0; i < 3; i++) {
+            vx[i] = ox + rand() % 33 - 8;
+            vy[i] = oy + rand() % 33 - 8;
+        }
+        area = edge(vx[0], vy[0], vx[1], vy[1], vx[2], vy[2]);
+    } while (area == 0);
+
+    if (area < 0) {
+        std::swap(vx[1], vx[2]);
+        std::swap(vy[1], vy[2]);
+    }
+
+    s.bb_tl[0] = clamp(std::min(vx[0], std::min(vx[1], vx[2])), 0, SCREEN_WIDTH);
+    s.bb_tl[1] = clamp(std::min(vy[0], std::min(vy[1], vy[2])), 0, SCREEN_HEIGHT);
+    s.bb_br[0] = clamp(std::max(vx[0], std::max(vx[1], vx[2])), 0, SCREEN_WIDTH);
+    s.bb_br[1] = clamp(std::max(vy[0], std::max(vy[1], vy[2])), 0, SCREEN_HEIGHT);
+
+    for (int i = 0; i < 3; i++) {
+        int a = i, b = (i + 1) % 3;
+        s.edge_val[i] = edge(vx[a], vy[a], vx[b], vy[b], s.bb_tl[0], s.bb_tl[1]);
+        s.edge_delta[i][0] = vy[b] - vy[a];
+        s.edge_delta[i][1] = -(vx[b] - vx[a]);
+    }
+
+    s.z = rand() % (1 << DATAWIDTH);
+    s.z_delta[0] = rand() % 64 - 32;
+    s.z_delta[1] = rand() % 64 - 32;
+    s.id = id;
+    return s;
+}
+
+// Reference: triangles in reverse order, strict depth test
+void render(const std::vector<Setup>& setups, std::vector<int>& color) {
+    std::vector<int> depth(SCREEN_WIDTH * SCREEN_HEIGHT, DEPTH_CLEAR);
+    color.assign(SCREEN_WIDTH * SCREEN_HEIGHT, 0);
+
+    for (int t = (int)setups.size() - 1; t >= 0; t--) {
+        const Setup& s = setups[t];
+        int c = s.id & ((1 << COLORWIDTH) - 1);
+        if (c == 0) c = 1;
+
+        for (int y = s.bb_tl[1]; y <= s.bb_br[1] && y < SCREEN_HEIGHT; y++) {
+            for (int x = s.bb_tl[0]; x <= s.bb_br[0] && x < SCREEN_WIDTH; x++) {
+                int dx = x - s.bb_tl[0], dy = y - s.bb_tl[1];
+                bool inside = true;
+                for (int i = 0; i < 3; i++) {
+                    inside &= s.edge_val[i] + dx * s.edge_delta[i][0] + dy * s.edge_delta[i][1] > 0;
+                }
+                int z = (s.z + dx * s.z_delta[0] + dy * s.z_delta[1]) & DEPTH_CLEAR;
+                int a = y * SCREEN_WIDTH + x;
+                if (inside && z < depth[a]) {
+                    depth[a] = z;
+                    color[a] = c;
+                }
+            }
+        }
+    }
+}
+
+void drive(Vrasterizer_tile_backend* dut, const Setup& s) {
+    const uint32_t mask = (1u << DATAWIDTH) - 1;
+    const uint32_t mask2 = (1u << (2 * DATAWIDTH)) - 1;
+
+    dut->bb_tl[0] = s.bb_tl[0] & mask;
+    dut->bb_tl[1] = s.bb_tl[1] & mask;
+    dut->bb_br[0] = s.bb_br[0] & mask;
+    dut->bb_br[1] = s.bb_br[1] & mask;
+    dut->edge_val0 = s.edge_val[0] & mask2;
+    dut->edge_val1 = s.edge_val[1] & mask2;
+    dut->edge_val2 = s.edge_val[2] & mask2;
+    for (int i = 0; i < 2; i++) {
+        dut->edge_delta0[i] = s.edge_delta[0][i] & mask;
+        dut->edge_delta1[i] = s.edge_delta[1][i] & mask;
+        dut->edge_delta2[i] = s.edge_delta[2][i] & mask;
+        dut->z_delta[i] = s.z_delta[i] & mask;
+    }
+    dut->z = s.z & mask;
+    dut->id = s.id & 0xF;
+}
+
+int main(int argc, char** argv) {
+    srand(time(NULL));
+    Verilated::commandArgs(argc, argv);
+
+    Vrasterizer_tile_backend* dut = new Vrasterizer_tile_backend;
+
+    Verilated::traceEverOn(true);
+    VerilatedVcdC* m_trace = new VerilatedVcdC;
+    dut->trace(m_trace, 5);
+    m_trace->open("waveform.vcd");
+
+    // Frame 0: ends with i_last
+    // Frame 1: no triangles, flushed
+    // Frame 2: the last triangle was culled, flushed after the others
+    const int num_triangles[3] = {24, 0, 12};
+    const int num_frames = 3;
+
+    std::vector<Setup> setups;
+    std::vector<int> expected;
+    std::vector<int> color(SCREEN_WIDTH * SCREEN_HEIGHT);
+    std::vector<int> writes(SCREEN_WIDTH * SCREEN_HEIGHT);
+
+    int frame = 0;
+    int sent = 0;
+    bool frame_started = false;
+    int errors = 0;
+
+    dut->clk = 0;
+    dut->rstn = 0;
+    dut->i_dv = 0;
+    dut->i_last = 0;
+    dut->i_flush = 0;
+    dut->i_write_limit = (1 << DATAWIDTH) - 1;
+
+    while (sim_time < MAX_SIM_TIME && frame < num_frames) {
+        dut->clk ^= 1;
+        dut->eval();
+
+        if (dut->clk == 1) {
+            posedge_cnt++;
+            dut->rstn = posedge_cnt > RESET_CLKS;
+            dut->i_dv = 0;
+            dut->i_last = 0;
+            dut->i_flush = 0;
+
+            if (!frame_started) {
+                setups.clear();
+                for (int i = 0; i < num_triangles[frame]; i++) {
+                    setups.push_back(random_setup(i + 1));
+                }
+                render(setups, expected);
+                std::fill(writes.begin(), writes.end(), 0);
+                sent = 0;
+                frame_started = true;
+            }
+
+            if (dut->o_fb_write_en) {
+                if (dut->o_fb_addr_write >= SCREEN_WIDTH * SCREEN_HEIGHT) {
+                    printf("Error: frame %d, write outside the screen at %d\n", frame, dut->o_fb_addr_write);
+                    errors++;
+                } else {
+                    color[dut->o_fb_addr_write] = dut->color_data;
+                    writes[dut->o_fb_addr_write]++;
+                }
+            }
+
+            if (dut->finished) {
+                int frame_errors = 0;
+                for (int a = 0; a < SCREEN_WIDTH * SCREEN_HEIGHT; a++) {
+                    if (writes[a] != 1 || color[a] != expected[a]) {
+                        if (frame_errors < 10) {
+                            printf("Error: frame %d, pixel (%d, %d): expected %d, got %d (%d writes)\n",
+                                   frame, a % SCREEN_WIDTH, a / SCREEN_WIDTH, expected[a], color[a], writes[a]);
+                        }
+                        frame_errors++;
+                    }
+                }
+                errors += frame_errors;
+                frame++;
+                frame_started = false;
+            } else if (dut->rstn && dut->ready) {
+                if (sent < (int)setups.size()) {
+                    drive(dut, setups[sent]);
+                    dut->i_dv = 1;
+                    dut->i_last = (frame == 0) && (sent == (int)setups.size() - 1);
+                    sent++;
+                } else if (frame != 0 && sent == (int)setups.size()) {
+                    dut->i_flush = 1;
+                    sent++;
+                }
+            }
+        }
+
+        m_trace->dump(sim_time);
+        sim_time++;
+    }
+
+    if (frame != num_frames) {
+        printf("Error: only %d of %d frames finished\n", frame, num_frames);
+        errors++;
+    }
+
+    m_trace->close();
+    printf("%s: %d errors\n", errors ? "FAILED" : "PASSED", errors);
+
+    delete dut;
+
+    exit(errors ? EXIT_FAILURE : EXIT_SUCCESS);
+}
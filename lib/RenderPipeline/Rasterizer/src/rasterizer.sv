@@ -1,5 +1,16 @@
 // Top level module for the rasterizer. Incorporates both the rasterizer
-// front-end and back-end.
+// front-end and back-end. With TILED set the back-end is the binned tile
+// back-end, which keeps depth on chip and writes every framebuffer pixel once
+// per frame, so no depth buffer or framebuffer clear is needed.
+//
+// With BACKEND_CLOCK_CROSSING the (non-tiled) back-end runs on clk_backend,
+// e.g. twice the frequency. The setup records cross over to it through an
+// async FIFO, and the pixels come back through another one. Only the
+// uncovered pixels of the bounding box are tested faster. The covered ones
+// are still capped at one per "clk" cycle, the rate at which the pixel FIFO
+// is read, and the back-end stalls when it fills up. Lifting that cap needs
+// the covered pixels committed as words, through the word write port of
+// display_new.
 
 `timescale 1ns / 1ps
 
@@ -9,11 +20,25 @@ module rasterizer #(
         parameter unsigned SCREEN_WIDTH = 320,
         parameter unsigned SCREEN_HEIGHT = 320,
         parameter unsigned ADDRWIDTH = $clog2(SCREEN_WIDTH * SCREEN_HEIGHT),
-        parameter unsigned IDWIDTH = 4
+        parameter unsigned IDWIDTH = 4,
+
+        parameter bit TILED = 0,
+        parameter unsigned TILE_WIDTH = 32,
+        parameter unsigned TILE_HEIGHT = 32,
+        parameter unsigned MAX_TILED_TRIANGLES = 1024,
+        parameter unsigned FB_WRAP_ROWS = 0,
+
+        parameter bit BACKEND_CLOCK_CROSSING = 0    // Not with TILED
     ) (
         input logic clk,
         input logic rstn,
 
+        // Back-end clock domain, only with BACKEND_CLOCK_CROSSING
+        /* verilator lint_off UNUSED */
+        input logic clk_backend,
+        input logic rstn_backend,   // Synchronous to clk_backend
+        /* verilator lint_on UNUSED */
+
         output logic ready,
 
         // INPUT SIGNALS TO THE RASTERIZER FRONTEND
@@ -23,6 +48,10 @@ module rasterizer #(
         input logic i_triangle_dv,
         input logic i_triangle_last,
 
+        // Dynamic resolution: render into the top left SCREEN >> i_res_shift
+        // of the framebuffer, with the row stride kept at SCREEN_WIDTH
+        input logic [1:0] i_res_shift,
+
         // OUPUT SIGNALS FROM THE RASTERIZER BACKEND
         output logic [ADDRWIDTH-1:0] o_fb_addr_write,
         output logic o_fb_write_en,
@@ -30,7 +59,17 @@ module rasterizer #(
         output logic [DATAWIDTH-1:0] o_fb_depth_data,
         output logic [COLORWIDTH-1:0] o_fb_color_data,
 
-        output logic finished
+        // Tiled only: tiles below this may be written out, for beam racing
+        /* verilator lint_off UNUSED */
+        input logic [DATAWIDTH-1:0] i_tile_write_limit,
+        /* verilator lint_on UNUSED */
+
+        output logic finished,
+
+        // Performance counter events: [2:0] from the front-end, see
+        // rasterizer_frontend, [3] pixel tested, [4] pixel passed the depth
+        // test, only with TILED
+        output logic [4:0] o_perf_events
     );
 
     // ========== RASTERIZER FRONTEND ==========
@@ -52,6 +91,7 @@ module rasterizer #(
     logic w_rasterizer_frontend_o_dv;
     logic w_rasterizer_frontend_o_last;
     logic w_rasterizer_frontend_finished_with_cull;
+    logic [2:0] w_rasterizer_frontend_perf_events;
 
     // ========== RASTERIZER BACKEND ==========
     logic w_rasterizer_backend_ready;
@@ -77,6 +117,8 @@ module rasterizer #(
         .i_triangle_dv(i_triangle_dv),
         .i_triangle_last(i_triangle_last),
 
+        .i_res_shift(i_res_shift),
+
         .bb_tl(w_bb_tl),
         .bb_br(w_bb_br),
 
@@ -94,49 +136,290 @@ module rasterizer #(
         .id(w_rasterizer_triangle_id),
         .o_dv(w_rasterizer_frontend_o_dv),
         .o_last(w_rasterizer_frontend_o_last),
-        .finished_with_cull(w_rasterizer_frontend_finished_with_cull)
-    );
-
-    // ========== RASTERIZER BACKEND ==========
-    rasterizer_backend #(
-        .DATAWIDTH(DATAWIDTH),
-        .COLORWIDTH(COLORWIDTH),
-        .SCREEN_WIDTH(SCREEN_WIDTH),
-        .SCREEN_HEIGHT(SCREEN_HEIGHT),
-        .ADDRWIDTH(ADDRWIDTH)
-    ) rasterizer_backend_inst (
-        .clk(clk),
-        .rstn(rstn),
-
-        .bb_tl(w_bb_tl),
-        .bb_br(w_bb_br),
-
-        .edge_val0(w_edge_val0),
-        .edge_val1(w_edge_val1),
-        .edge_val2(w_edge_val2),
-
-        .edge_delta0(w_edge_delta0),
-        .edge_delta1(w_edge_delta1),
-        .edge_delta2(w_edge_delta2),
-
-        .z(w_z_coeff),
-        .z_delta(w_z_coeff_delta),
-
-        .id(w_rasterizer_triangle_id),
-        .i_dv(w_rasterizer_frontend_o_dv),
-        .i_last(w_rasterizer_frontend_o_last),
-
-        .o_fb_addr_write(o_fb_addr_write),
-        .o_fb_write_en(o_fb_write_en),
+        .finished_with_cull(w_rasterizer_frontend_finished_with_cull),
 
-        .depth_data(o_fb_depth_data),
-        .color_data(o_fb_color_data),
-
-        .ready(w_rasterizer_backend_ready),
-        .done(w_rasterizer_backend_done),
-        .finished(w_rasterizer_backend_finished)
+        .o_perf_events(w_rasterizer_frontend_perf_events)
     );
 
-    assign finished = w_rasterizer_frontend_finished_with_cull || w_rasterizer_backend_finished;
+    // ========== RASTERIZER BACKEND ==========
+    logic [1:0] w_rasterizer_backend_perf_events;
+
+    assign o_perf_events = {w_rasterizer_backend_perf_events, w_rasterizer_frontend_perf_events};
+
+    generate
+        if (TILED) begin : g_tile_backend
+            rasterizer_tile_backend #(
+                .DATAWIDTH(DATAWIDTH),
+                .COLORWIDTH(COLORWIDTH),
+                .SCREEN_WIDTH(SCREEN_WIDTH),
+                .SCREEN_HEIGHT(SCREEN_HEIGHT),
+                .ADDRWIDTH(ADDRWIDTH),
+                .IDWIDTH(IDWIDTH),
+                .TILE_WIDTH(TILE_WIDTH),
+                .TILE_HEIGHT(TILE_HEIGHT),
+                .MAX_TRIANGLES(MAX_TILED_TRIANGLES),
+                .MAX_BIN_ENTRIES(4 * MAX_TILED_TRIANGLES),
+                .FB_WRAP_ROWS(FB_WRAP_ROWS)
+            ) rasterizer_backend_inst (
+                .clk(clk),
+                .rstn(rstn),
+
+                .bb_tl(w_bb_tl),
+                .bb_br(w_bb_br),
+
+                .edge_val0(w_edge_val0),
+                .edge_val1(w_edge_val1),
+                .edge_val2(w_edge_val2),
+
+                .edge_delta0(w_edge_delta0),
+                .edge_delta1(w_edge_delta1),
+                .edge_delta2(w_edge_delta2),
+
+                .z(w_z_coeff),
+                .z_delta(w_z_coeff_delta),
+
+                .id(w_rasterizer_triangle_id),
+                .i_dv(w_rasterizer_frontend_o_dv),
+                .i_last(w_rasterizer_frontend_o_last),
+                .i_flush(w_rasterizer_frontend_finished_with_cull),
+                .i_write_limit(i_tile_write_limit),
+
+                .o_fb_addr_write(o_fb_addr_write),
+                .o_fb_write_en(o_fb_write_en),
+
+                .depth_data(o_fb_depth_data),
+                .color_data(o_fb_color_data),
+
+                .ready(w_rasterizer_backend_ready),
+                .finished(w_rasterizer_backend_finished),
+
+                .o_perf_events(w_rasterizer_backend_perf_events)
+            );
+
+            // A culled last triangle flushes the tile back-end, which
+            // finishes once the frame has been written out
+            assign w_rasterizer_backend_done = 1'b0;
+            assign finished = w_rasterizer_backend_finished;
+        end else begin : g_backend
+            // Back-end signals, in the back-end clock domain
+            logic w_backend_clk;
+            logic w_backend_rstn;
+
+            logic signed [DATAWIDTH-1:0] w_be_bb_tl[2];
+            logic signed [DATAWIDTH-1:0] w_be_bb_br[2];
+            logic signed [2*DATAWIDTH-1:0] w_be_edge_val0;
+            logic signed [2*DATAWIDTH-1:0] w_be_edge_val1;
+            logic signed [2*DATAWIDTH-1:0] w_be_edge_val2;
+            logic signed [DATAWIDTH-1:0] w_be_edge_delta0[2];
+            logic signed [DATAWIDTH-1:0] w_be_edge_delta1[2];
+            logic signed [DATAWIDTH-1:0] w_be_edge_delta2[2];
+            logic signed [DATAWIDTH-1:0] w_be_z;
+            logic signed [DATAWIDTH-1:0] w_be_z_delta[2];
+            logic [IDWIDTH-1:0] w_be_id;
+            logic w_be_dv;
+            logic w_be_last;
+            logic w_be_stall;
+
+            logic [ADDRWIDTH-1:0] w_be_fb_addr_write;
+            logic w_be_fb_write_en;
+            logic [DATAWIDTH-1:0] w_be_depth_data;
+            logic [COLORWIDTH-1:0] w_be_color_data;
+            logic w_be_ready;
+            /* verilator lint_off UNUSED */
+            logic [1:0] w_be_perf_events;   // Not with BACKEND_CLOCK_CROSSING
+            /* verilator lint_on UNUSED */
+
+            rasterizer_backend #(
+                .DATAWIDTH(DATAWIDTH),
+                .COLORWIDTH(COLORWIDTH),
+                .SCREEN_WIDTH(SCREEN_WIDTH),
+                .SCREEN_HEIGHT(SCREEN_HEIGHT),
+                .ADDRWIDTH(ADDRWIDTH)
+            ) rasterizer_backend_inst (
+                .clk(w_backend_clk),
+                .rstn(w_backend_rstn),
+
+                .bb_tl(w_be_bb_tl),
+                .bb_br(w_be_bb_br),
+
+                .edge_val0(w_be_edge_val0),
+                .edge_val1(w_be_edge_val1),
+                .edge_val2(w_be_edge_val2),
+
+                .edge_delta0(w_be_edge_delta0),
+                .edge_delta1(w_be_edge_delta1),
+                .edge_delta2(w_be_edge_delta2),
+
+                .z(w_be_z),
+                .z_delta(w_be_z_delta),
+
+                .id(w_be_id),
+                .i_dv(w_be_dv),
+                .i_last(w_be_last),
+
+                .i_stall(w_be_stall),
+
+                .o_fb_addr_write(w_be_fb_addr_write),
+                .o_fb_write_en(w_be_fb_write_en),
+
+                .depth_data(w_be_depth_data),
+                .color_data(w_be_color_data),
+
+                .ready(w_be_ready),
+                .done(w_rasterizer_backend_done),
+                .finished(w_rasterizer_backend_finished),
+
+                .o_perf_events(w_be_perf_events)
+            );
+
+            if (BACKEND_CLOCK_CROSSING) begin : g_clock_crossing
+                // A setup record, or a marker for a culled last triangle,
+                // which has no setup but still has to finish the frame
+                // behind the pixels of the triangles before it
+                localparam unsigned SETUP_WIDTH = 19 * DATAWIDTH + IDWIDTH + 2;
+                // A pixel, or a marker for the finished frame
+                localparam unsigned PIXEL_WIDTH = 1 + ADDRWIDTH + DATAWIDTH + COLORWIDTH;
+
+                logic [SETUP_WIDTH-1:0] w_setup_write;
+                logic [SETUP_WIDTH-1:0] w_setup_read;
+                logic w_setup_full;
+                logic w_setup_empty;
+                logic w_setup_read_en;
+                logic w_setup_dv;
+                logic w_setup_cull_last;
+
+                logic [PIXEL_WIDTH-1:0] w_pixel_write;
+                logic [PIXEL_WIDTH-1:0] w_pixel_read;
+                logic w_pixel_write_en;
+                logic w_pixel_full;
+                logic w_pixel_almost_full;
+                logic w_pixel_empty;
+                logic w_pixel_dv;
+                logic w_pixel_finished;
+
+                logic r_finished_pending;   // Back-end clock domain
+
+                assign w_backend_clk = clk_backend;
+                assign w_backend_rstn = rstn_backend;
+
+                // ====== SETUP, "clk" to "clk_backend" ======
+                assign w_setup_write = {w_rasterizer_frontend_finished_with_cull, w_rasterizer_frontend_o_last,
+                                        w_rasterizer_triangle_id,
+                                        w_bb_tl[0], w_bb_tl[1], w_bb_br[0], w_bb_br[1],
+                                        w_edge_val0, w_edge_val1, w_edge_val2,
+                                        w_edge_delta0[0], w_edge_delta0[1],
+                                        w_edge_delta1[0], w_edge_delta1[1],
+                                        w_edge_delta2[0], w_edge_delta2[1],
+                                        w_z_coeff, w_z_coeff_delta[0], w_z_coeff_delta[1]};
+
+                assign {w_setup_cull_last, w_be_last,
+                        w_be_id,
+                        w_be_bb_tl[0], w_be_bb_tl[1], w_be_bb_br[0], w_be_bb_br[1],
+                        w_be_edge_val0, w_be_edge_val1, w_be_edge_val2,
+                        w_be_edge_delta0[0], w_be_edge_delta0[1],
+                        w_be_edge_delta1[0], w_be_edge_delta1[1],
+                        w_be_edge_delta2[0], w_be_edge_delta2[1],
+                        w_be_z, w_be_z_delta[0], w_be_z_delta[1]} = w_setup_read;
+
+                async_fifo #(
+                    .DATAWIDTH(SETUP_WIDTH),
+                    .DEPTH(4)
+                ) setup_fifo_inst (
+                    .write_clk(clk),
+                    .write_rstn(rstn),
+                    .write_en(w_rasterizer_frontend_o_dv || w_rasterizer_frontend_finished_with_cull),
+                    .data_in(w_setup_write),
+                    .full(w_setup_full),
+                    .almost_full(),
+
+                    .read_clk(clk_backend),
+                    .read_rstn(rstn_backend),
+                    .read_en(w_setup_read_en),
+                    .data_out(w_setup_read),
+                    .o_dv(w_setup_dv),
+                    .empty(w_setup_empty)
+                );
+
+                // The setup record is held in the FIFO output until the next
+                // read, which is only when the back-end is idle again
+                assign w_rasterizer_backend_ready = ~w_setup_full;
+                assign w_setup_read_en = w_be_ready && ~w_setup_empty && ~w_setup_dv && ~r_finished_pending;
+                assign w_be_dv = w_setup_dv && ~w_setup_cull_last;
+
+                // ====== PIXELS, "clk_backend" to "clk" ======
+                // The back-end stalls a cycle late, and the finished marker
+                // waits for room
+                assign w_be_stall = w_pixel_almost_full;
+                assign w_pixel_write_en = w_be_fb_write_en || r_finished_pending;
+                assign w_pixel_write = {~w_be_fb_write_en, w_be_fb_addr_write, w_be_depth_data, w_be_color_data};
+
+                always_ff @(posedge clk_backend) begin
+                    if (~rstn_backend) begin
+                        r_finished_pending <= 1'b0;
+                    end else begin
+                        if (r_finished_pending && ~w_be_fb_write_en && ~w_pixel_full) begin
+                            r_finished_pending <= 1'b0;
+                        end
+                        if (w_rasterizer_backend_finished || (w_setup_dv && w_setup_cull_last)) begin
+                            r_finished_pending <= 1'b1;
+                        end
+                    end
+                end
+
+                async_fifo #(
+                    .DATAWIDTH(PIXEL_WIDTH),
+                    .DEPTH(16)
+                ) pixel_fifo_inst (
+                    .write_clk(clk_backend),
+                    .write_rstn(rstn_backend),
+                    .write_en(w_pixel_write_en),
+                    .data_in(w_pixel_write),
+                    .full(w_pixel_full),
+                    .almost_full(w_pixel_almost_full),
+
+                    .read_clk(clk),
+                    .read_rstn(rstn),
+                    .read_en(~w_pixel_empty),
+                    .data_out(w_pixel_read),
+                    .o_dv(w_pixel_dv),
+                    .empty(w_pixel_empty)
+                );
+
+                assign {w_pixel_finished, o_fb_addr_write, o_fb_depth_data, o_fb_color_data} = w_pixel_read;
+                assign o_fb_write_en = w_pixel_dv && ~w_pixel_finished;
+                assign finished = w_pixel_dv && w_pixel_finished;
+
+                // Counted in the back-end clock domain, not by the perf counters
+                assign w_rasterizer_backend_perf_events = 2'b00;
+            end else begin : g_same_clock
+                assign w_backend_clk = clk;
+                assign w_backend_rstn = rstn;
+
+                assign w_be_bb_tl = w_bb_tl;
+                assign w_be_bb_br = w_bb_br;
+                assign w_be_edge_val0 = w_edge_val0;
+                assign w_be_edge_val1 = w_edge_val1;
+                assign w_be_edge_val2 = w_edge_val2;
+                assign w_be_edge_delta0 = w_edge_delta0;
+                assign w_be_edge_delta1 = w_edge_delta1;
+                assign w_be_edge_delta2 = w_edge_delta2;
+                assign w_be_z = w_z_coeff;
+                assign w_be_z_delta = w_z_coeff_delta;
+                assign w_be_id = w_rasterizer_triangle_id;
+                assign w_be_dv = w_rasterizer_frontend_o_dv;
+                assign w_be_last = w_rasterizer_frontend_o_last;
+                assign w_be_stall = 1'b0;
+
+                assign o_fb_addr_write = w_be_fb_addr_write;
+                assign o_fb_write_en = w_be_fb_write_en;
+                assign o_fb_depth_data = w_be_depth_data;
+                assign o_fb_color_data = w_be_color_data;
+
+                assign w_rasterizer_backend_ready = w_be_ready;
+                assign finished = w_rasterizer_frontend_finished_with_cull || w_rasterizer_backend_finished;
+                assign w_rasterizer_backend_perf_events = w_be_perf_events;
+            end
+        end
+    endgenerate
 
 endmodule
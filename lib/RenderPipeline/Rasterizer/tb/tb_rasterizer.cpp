@@ -1,14 +1,93 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <cstdlib>
+#include <algorithm>
+#include <vector>
 #include <verilated.h>
 #include <verilated_vcd_c.h>
 #include "obj_dir/Vrasterizer.h"
 
+// Rasterizes a few frames and records the pixel stream and the finished
+// pulses. The same-clock build writes them to REFERENCE_FILE, and the
+// BACKEND_CLOCK_CROSSING build, with a faster clk_backend, has to produce
+// exactly the same stream. "make crossing" runs both.
+//
+// The frames cover a last triangle that is drawn, one that is culled as a
+// backface, one that is degenerate, and a frame with only a culled triangle.
+// The large triangle has rows that the back-end produces faster than the
+// pixel FIFO is read, so with the clock crossing it stalls on the FIFO.
+
+#ifndef SCREEN_WIDTH
+#define SCREEN_WIDTH 64
+#endif
+#ifndef SCREEN_HEIGHT
+#define SCREEN_HEIGHT 48
+#endif
+#ifndef BACKEND_CLOCK_CROSSING
+#define BACKEND_CLOCK_CROSSING 0
+#endif
+
+#define DATA_MASK 0xfff     // DATAWIDTH = 12
+
+#define REFERENCE_FILE "reference.txt"
+
+// ns, clk_backend is 2.5 times as fast as clk
+#define CLK_HALF_PERIOD 5
+#define BACKEND_HALF_PERIOD 2
+
+// A row of covered pixels longer than this fills the 16 deep pixel FIFO, as
+// the back-end writes 2.5 pixels for every one that is read
+#define PIXEL_FIFO_DEPTH 16
+#define BACKPRESSURE_RUN (PIXEL_FIFO_DEPTH * 5 / 3 + 4)
+
+#define RESET_CLKS 8
+#define FRAME_TIMEOUT_CLKS (8 * SCREEN_WIDTH * SCREEN_HEIGHT)
+#define DRAIN_CLKS 256
+#define MAX_TRIANGLES 4
+#define NUM_FRAMES 4
+#define MAX_SIM_TIME ((NUM_FRAMES * FRAME_TIMEOUT_CLKS + DRAIN_CLKS) * 2 * CLK_HALF_PERIOD)
+
+struct Triangle {
+    int v[3][3];    // x, y, z
+};
+
+// Counter clockwise is drawn, clockwise is culled as a backface
+#define BIG {{{1, 1, 100}, {1, 46, 300}, {62, 1, 200}}}
+#define BIG_BACKFACE {{{1, 1, 100}, {62, 1, 200}, {1, 46, 300}}}
+#define SMALL {{{10, 10, 400}, {12, 20, 400}, {20, 12, 400}}}
+#define SMALL_BACKFACE {{{10, 10, 400}, {20, 12, 400}, {12, 20, 400}}}
+#define DEGENERATE {{{5, 5, 0}, {5, 5, 0}, {5, 5, 0}}}
+
+struct Frame {
+    int num_triangles;
+    Triangle triangles[MAX_TRIANGLES];
+};
+
+const Frame frames[NUM_FRAMES] = {
+    {3, {BIG, SMALL_BACKFACE, SMALL}},
+    {3, {SMALL, BIG, DEGENERATE}},
+    {1, {BIG_BACKFACE}},
+    {3, {BIG, SMALL, BIG_BACKFACE}},
+};
+
+// A pixel, or a finished pulse
+struct Event {
+    int finished;
+    int addr;
+    int depth;
+    int color;
+};
 
-#define MAX_SIM_TIME 32*16
 vluint64_t sim_time = 0;
-vluint64_t posedge_cnt = 0;
 
+void set_vertex(VlUnpacked<SData, 3>& port, const int v[3]) {
+    for (int i = 0; i < 3; i++) {
+        port[i] = v[i] & DATA_MASK;
+    }
+}
 
 int main(int argc, char** argv) {
+    srand(time(NULL));
     Verilated::commandArgs(argc, argv);
 
     Vrasterizer* dut = new Vrasterizer;
@@ -18,47 +97,181 @@ int main(int argc, char** argv) {
     dut->trace(m_trace, 5);
     m_trace->open("waveform.vcd");
 
-    int x0 = 3;
-    int y0 = 4;
-    int z0 = 4;
-    int x1 = 21;
-    int z1 = 4;
-    int y1 = 8;
-    int x2 = 17;
-    int y2 = 14;
-    int z2 = 4;
-
-    while (sim_time < MAX_SIM_TIME) {
-        dut->clk ^= 1; 
+    dut->clk = 0;
+    dut->clk_backend = 0;
+    dut->rstn = 0;
+    dut->rstn_backend = 0;
+    dut->i_triangle_dv = 0;
+    dut->i_triangle_last = 0;
+    dut->i_res_shift = 0;
+    dut->i_tile_write_limit = DATA_MASK;
+
+    std::vector<Event> events;
+    int errors = 0;
+    int frame = 0;
+    int triangle = 0;
+    int frame_clks = 0;
+    int drain_clks = 0;
+    int posedges = 0;
+    int backend_posedges = 0;
+    bool ready_last = false;
+
+    // Longest run of consecutive addresses, one row of covered pixels
+    int run = 0;
+    int longest_run = 0;
+
+    vluint64_t next_clk_toggle = 0;
+    vluint64_t next_backend_toggle = BACKEND_CLOCK_CROSSING ? 0 : MAX_SIM_TIME;
+
+    while (sim_time < MAX_SIM_TIME && drain_clks < DRAIN_CLKS) {
+        // Advance to the next clock edge
+        sim_time = std::min(next_clk_toggle, next_backend_toggle);
+        bool clk_edge = next_clk_toggle == sim_time;
+        bool backend_edge = next_backend_toggle == sim_time;
+        if (clk_edge) {
+            dut->clk ^= 1;
+            next_clk_toggle += CLK_HALF_PERIOD;
+        }
+        if (backend_edge) {
+            dut->clk_backend ^= 1;
+            next_backend_toggle += BACKEND_HALF_PERIOD;
+        }
         dut->eval();
 
-        dut->x0 = x0;
-        dut->y0 = y0;
-        dut->z0 = z0;
-        dut->x1 = x1;
-        dut->y1 = y1;
-        dut->z1 = z1;
-        dut->x2 = x2;
-        dut->y2 = y2;
-        dut->z2 = z2;
-
-        if (dut->clk == 1) {
-            posedge_cnt++;
-            if (posedge_cnt < 4) {
-                dut->rst = 1;
+        if (backend_edge && dut->clk_backend) {
+            backend_posedges++;
+            dut->rstn_backend = backend_posedges > RESET_CLKS;
+        }
+
+        // The outputs seen after the rising edge are those of this cycle
+        if (clk_edge && dut->clk) {
+            posedges++;
+            dut->rstn = posedges > RESET_CLKS;
+            if (!BACKEND_CLOCK_CROSSING) {
+                dut->rstn_backend = dut->rstn;
             }
-            else {
-                dut->rst = 0;
+
+            if (dut->rstn) {
+                if (dut->o_fb_write_en) {
+                    int addr = dut->o_fb_addr_write;
+                    if (!events.empty() && !events.back().finished && events.back().addr + 1 == addr) {
+                        run++;
+                    } else {
+                        run = 1;
+                    }
+                    longest_run = std::max(longest_run, run);
+                    events.push_back({0, addr, dut->o_fb_depth_data, dut->o_fb_color_data});
+                }
+
+                if (dut->finished) {
+                    events.push_back({1, 0, 0, 0});
+                    if (frame == NUM_FRAMES) {
+                        printf("Error: finished after the last frame\n");
+                        errors++;
+                    } else if (triangle < frames[frame].num_triangles) {
+                        printf("Error: frame %d finished after %d of %d triangles\n",
+                               frame, triangle, frames[frame].num_triangles);
+                        errors++;
+                    }
+                }
+
+                // Triangle taken at this edge
+                if (dut->i_triangle_dv && ready_last) {
+                    triangle++;
+                }
+                dut->i_triangle_dv = 0;
+                dut->i_triangle_last = 0;
+
+                if (dut->finished && frame < NUM_FRAMES) {
+                    frame++;
+                    triangle = 0;
+                    frame_clks = 0;
+                }
+
+                if (frame < NUM_FRAMES) {
+                    // Gaps between some triangles
+                    if (triangle < frames[frame].num_triangles && rand() % 4 != 0) {
+                        const Triangle& t = frames[frame].triangles[triangle];
+                        set_vertex(dut->i_v0, t.v[0]);
+                        set_vertex(dut->i_v1, t.v[1]);
+                        set_vertex(dut->i_v2, t.v[2]);
+                        dut->i_triangle_last = triangle == frames[frame].num_triangles - 1;
+                        dut->i_triangle_dv = 1;
+                    }
+
+                    if (++frame_clks == FRAME_TIMEOUT_CLKS) {
+                        printf("Error: frame %d did not finish\n", frame);
+                        errors++;
+                        break;
+                    }
+                } else {
+                    drain_clks++;
+                }
+                dut->eval();
+
+                ready_last = dut->ready;
             }
         }
 
         m_trace->dump(sim_time);
-        sim_time++;
     }
 
-    m_trace->close();
+    if (frame != NUM_FRAMES) {
+        printf("Error: only %d of %d frames finished\n", frame, NUM_FRAMES);
+        errors++;
+    }
 
-    exit(EXIT_SUCCESS);
-}
+    if (longest_run < BACKPRESSURE_RUN) {
+        printf("Error: longest row of %d pixels does not fill the pixel FIFO\n", longest_run);
+        errors++;
+    }
 
+    if (!BACKEND_CLOCK_CROSSING) {
+        FILE* f = fopen(REFERENCE_FILE, "w");
+        for (const Event& e : events) {
+            fprintf(f, "%d %d %d %d\n", e.finished, e.addr, e.depth, e.color);
+        }
+        fclose(f);
+    } else {
+        FILE* f = fopen(REFERENCE_FILE, "r");
+        if (!f) {
+            printf("Error: no %s, run the same-clock build first\n", REFERENCE_FILE);
+            errors++;
+        } else {
+            std::vector<Event> reference;
+            Event e;
+            while (fscanf(f, "%d %d %d %d", &e.finished, &e.addr, &e.depth, &e.color) == 4) {
+                reference.push_back(e);
+            }
+            fclose(f);
+
+            if (reference.size() != events.size()) {
+                printf("Error: %zu events, the same-clock run has %zu\n", events.size(), reference.size());
+                errors++;
+            }
+            int mismatches = 0;
+            for (size_t i = 0; i < std::min(reference.size(), events.size()); i++) {
+                const Event& r = reference[i];
+                const Event& g = events[i];
+                if (r.finished != g.finished || r.addr != g.addr || r.depth != g.depth || r.color != g.color) {
+                    if (mismatches < 10) {
+                        printf("Error: event %zu: expected %s %d depth %d color %d, got %s %d depth %d color %d\n",
+                               i, r.finished ? "finished" : "pixel", r.addr, r.depth, r.color,
+                               g.finished ? "finished" : "pixel", g.addr, g.depth, g.color);
+                    }
+                    mismatches++;
+                }
+            }
+            errors += mismatches;
+        }
+    }
+
+    m_trace->close();
+    printf("BACKEND_CLOCK_CROSSING=%d: %zu events, longest row %d\n",
+           BACKEND_CLOCK_CROSSING, events.size(), longest_run);
+    printf("%s: %d errors\n", errors ? "FAILED" : "PASSED", errors);
 
+    delete dut;
+
+    exit(errors ? EXIT_FAILURE : EXIT_SUCCESS);
+}
@@ -36,6 +36,17 @@ module transform_pipeline #(
     input logic signed [INPUT_DATAWIDTH-1:0] i_mvp_matrix[4][4],
     input logic i_mvp_dv,
 
+    // Keep the transformed vertices in the G-buffer between runs, and go
+    // straight to primitive assembly when the MVP matches the last run bit
+    // for bit. Only set for static objects, clear it when the model changes
+    input logic i_vertex_cache_en,
+    output logic o_vertex_cache_hit,
+
+    // Frame deadline: stop reading the model, and end the triangle stream
+    // early with an empty last triangle. Ignored once the last triangle has
+    // been output
+    input logic i_abort,
+
     // Read vertex data from Model Buffer -- Effectively accessed as SAM
     output logic o_model_buff_vertex_read_en,
     input logic signed [INPUT_DATAWIDTH-1:0] i_vertex[3],
@@ -53,7 +64,10 @@ module transform_pipeline #(
     output logic signed [OUTPUT_DATAWIDTH-1:0] o_v1[3],
     output logic signed [OUTPUT_DATAWIDTH-1:0] o_v2[3],
     output logic o_triangle_dv,
-    output logic o_triangle_last
+    output logic o_triangle_last,
+
+    // Performance counter events: [0] vertex transformed, [1] vertex clipped
+    output logic [1:0] o_perf_events
     );
 
     // ====== MODULE INSTANTIATION ======
@@ -108,20 +122,52 @@ module transform_pipeline #(
     logic signed [OUTPUT_DATAWIDTH-1:0] r_pa_i_v2[3];
     logic r_pa_i_vertex_dv = '0;
 
+    logic signed [OUTPUT_DATAWIDTH-1:0] w_pa_v0[3];
+    logic signed [OUTPUT_DATAWIDTH-1:0] w_pa_v1[3];
+    logic signed [OUTPUT_DATAWIDTH-1:0] w_pa_v2[3];
+    logic w_pa_o_dv;
+    logic w_pa_o_last;
+    logic w_pa_index_read_en;
+
+    // Abort. The vertex shader, post-processor and primitive assembler are
+    // held in reset while the stream is ended
+    logic w_abort;
+    logic w_stage_rstn;
+    logic r_abort_triangle_dv = 1'b0;
+    logic r_aborted = 1'b0;
+    logic r_triangle_last_sent = 1'b0;
+
+    // Vertex cache
+    logic signed [INPUT_DATAWIDTH-1:0] r_cached_mvp[4][4];
+    logic r_cache_valid = 1'b0;
+    logic w_mvp_matches_cache;
+    logic w_cache_hit;
+
+    always_comb begin
+        w_mvp_matches_cache = 1'b1;
+        foreach (i_mvp_matrix[i,j]) begin
+            if (i_mvp_matrix[i][j] != r_cached_mvp[i][j]) begin
+                w_mvp_matches_cache = 1'b0;
+            end
+        end
+    end
+
+    assign w_cache_hit = i_vertex_cache_en && r_cache_valid && w_mvp_matches_cache;
+
     // Vertex Shader
     vertex_shader_new #(
         .DATAWIDTH(INPUT_DATAWIDTH),
         .FRACBITS(INPUT_FRACBITS)
     ) vertex_shader_inst (
         .clk(clk),
-        .rstn(rstn),
+        .rstn(w_stage_rstn),
 
         .o_ready(w_vs_ready),
         .o_vertex_ready(w_vs_vertex_ready),
         .i_ready(w_vpp_ready),
 
         .i_mvp(i_mvp_matrix),
-        .i_mvp_valid(i_mvp_dv),
+        .i_mvp_valid(i_mvp_dv && ~w_cache_hit),
 
         .i_vertex(i_vertex),
         .i_vertex_valid(i_vertex_dv),
@@ -144,7 +190,7 @@ module transform_pipeline #(
         .ZNEAR(ZNEAR)
     ) vertex_post_processor_inst (
         .clk(clk),
-        .rstn(rstn),
+        .rstn(w_stage_rstn),
 
         .ready(w_vpp_ready),
 
@@ -190,14 +236,14 @@ module transform_pipeline #(
         .MAX_VERTEX_COUNT(MAX_VERTEX_COUNT)
     ) primitive_assembler_inst (
         .clk(clk),
-        .rstn(rstn),
+        .rstn(w_stage_rstn),
 
         .start(r_pa_start),
         .i_ready(transform_pipeline_next),
         .o_ready(w_pa_o_ready),
         .finished(w_pa_finished),
 
-        .o_index_buff_read_en(o_model_buff_index_read_en),
+        .o_index_buff_read_en(w_pa_index_read_en),
         .i_index_data(i_index_data),
         .i_index_dv(i_index_dv),
         .i_index_last(i_index_last),
@@ -215,11 +261,11 @@ module transform_pipeline #(
         .i_v2_invalid(0),
         .i_vertex_dv(r_pa_i_vertex_dv),
 
-        .o_v0(o_v0),
-        .o_v1(o_v1),
-        .o_v2(o_v2),
-        .o_dv(o_triangle_dv),
-        .o_last(o_triangle_last)
+        .o_v0(w_pa_v0),
+        .o_v1(w_pa_v1),
+        .o_v2(w_pa_v2),
+        .o_dv(w_pa_o_dv),
+        .o_last(w_pa_o_last)
     );
 
     // ====== STATE ======
@@ -228,6 +274,7 @@ module transform_pipeline #(
         VERTEX_SHADER_GET_MATRIX,
         VERTEX_SHADER,
         PRIMITIVE_ASSEMBLER,
+        ABORT,
         DONE
     } state_t;
     state_t current_state = IDLE, next_state;
@@ -258,18 +305,30 @@ module transform_pipeline #(
 
             VERTEX_SHADER_GET_MATRIX: begin
                 if (i_mvp_dv) begin
-                    next_state = VERTEX_SHADER;
+                    next_state = w_cache_hit ? PRIMITIVE_ASSEMBLER : VERTEX_SHADER;
                 end
             end
 
             VERTEX_SHADER: begin
-                if (w_vpp_done & r_vpp_last_vertex_finished) begin
+                if (w_abort) begin
+                    next_state = ABORT;
+                end else if (w_vpp_done & r_vpp_last_vertex_finished) begin
                     next_state = PRIMITIVE_ASSEMBLER;
                 end
             end
 
             PRIMITIVE_ASSEMBLER: begin
-                if (w_pa_finished) begin
+                if (w_abort) begin
+                    next_state = ABORT;
+                end else if (w_pa_finished) begin
+                    next_state = DONE;
+                end
+            end
+
+            // The empty last triangle is output once transform_pipeline_next
+            // allows it, like the primitive assembler does
+            ABORT: begin
+                if (r_abort_triangle_dv) begin
                     next_state = DONE;
                 end
             end
@@ -313,6 +372,11 @@ module transform_pipeline #(
             foreach(r_pa_i_v1[i]) r_pa_i_v1[i] <= '0;
             foreach(r_pa_i_v2[i]) r_pa_i_v2[i] <= '0;
 
+            // Vertex cache
+            foreach (r_cached_mvp[i,j]) r_cached_mvp[i][j] <= '0;
+            r_cache_valid <= 1'b0;
+            o_vertex_cache_hit <= 1'b0;
+
         end else begin
             case (current_state)
                 IDLE: begin
@@ -342,6 +406,16 @@ module transform_pipeline #(
                     foreach(r_pa_i_v2[i]) r_pa_i_v2[i] <= '0;
                 end
 
+                // The G-buffer is invalid from here until the vertex stages
+                // have written all vertices again
+                VERTEX_SHADER_GET_MATRIX: begin
+                    if (i_mvp_dv) begin
+                        r_cached_mvp <= i_mvp_matrix;
+                        r_cache_valid <= w_cache_hit;
+                        o_vertex_cache_hit <= w_cache_hit;
+                    end
+                end
+
                 VERTEX_SHADER: begin
                     if (w_vs_o_vertex_dv) begin
                         foreach (r_vpp_i_vertex[i]) r_vpp_i_vertex[i] <= w_vs_o_vertex[i];
@@ -399,13 +473,75 @@ module transform_pipeline #(
                     end
                 end
 
+                // The G-buffer is incomplete
+                ABORT: begin
+                    foreach (r_vpp_i_vertex[i]) r_vpp_i_vertex[i] <= '0;
+                    r_vpp_i_vertex_dv <= '0;
+                    r_gbuff_write_en <= '0;
+                    r_gbuff_read_en <= '0;
+                    r_pa_start <= '0;
+                    r_pa_i_vertex_dv <= '0;
+                    r_cache_valid <= 1'b0;
+                end
+
+                DONE: begin
+                    r_cache_valid <= i_vertex_cache_en && ~r_aborted;
+                end
+
                 default: begin
                 end
             endcase
         end
     end
 
+    // ====== ABORT ======
+    assign w_abort = i_abort && ~r_triangle_last_sent && ~(w_pa_o_dv && w_pa_o_last);
+    assign w_stage_rstn = rstn && (current_state != ABORT);
+
+    always_ff @(posedge clk) begin
+        if (~rstn) begin
+            r_abort_triangle_dv <= 1'b0;
+            r_aborted <= 1'b0;
+            r_triangle_last_sent <= 1'b0;
+        end else begin
+            r_abort_triangle_dv <= (current_state == ABORT) && transform_pipeline_next && ~r_abort_triangle_dv;
+
+            if (current_state == IDLE) begin
+                r_aborted <= 1'b0;
+                r_triangle_last_sent <= 1'b0;
+            end else begin
+                if (current_state == ABORT) begin
+                    r_aborted <= 1'b1;
+                end
+                if (w_pa_o_dv && w_pa_o_last) begin
+                    r_triangle_last_sent <= 1'b1;
+                end
+            end
+        end
+    end
+
+    always_comb begin
+        if (current_state == ABORT) begin
+            o_v0 = '{'0, '0, '0};
+            o_v1 = '{'0, '0, '0};
+            o_v2 = '{'0, '0, '0};
+            o_triangle_dv = r_abort_triangle_dv;
+            o_triangle_last = 1'b1;
+        end else begin
+            o_v0 = w_pa_v0;
+            o_v1 = w_pa_v1;
+            o_v2 = w_pa_v2;
+            o_triangle_dv = w_pa_o_dv;
+            o_triangle_last = w_pa_o_last;
+        end
+    end
+
     // assign r_vs_enable = w_vpp_ready;
-    assign o_model_buff_vertex_read_en = w_vs_vertex_ready;
+    assign o_model_buff_vertex_read_en = w_vs_vertex_ready && (current_state != ABORT);
+    assign o_model_buff_index_read_en = w_pa_index_read_en && (current_state != ABORT);
     assign o_mvp_matrix_read_en = w_vs_ready & (current_state == VERTEX_SHADER_GET_MATRIX);
+
+    // Performance counter events
+    assign o_perf_events[0] = w_vpp_done;
+    assign o_perf_events[1] = w_vpp_done && w_vpp_o_vertex_invalid;
 endmodule
@@ -3,6 +3,7 @@
 #include <sstream>
 #include <vector>
 #include <string>
+#include <cstring>
 
 #include <verilated.h>
 #include <verilated_vcd_c.h>
@@ -135,6 +136,19 @@ glm::mat4 generate_mvp(glm::vec3 pos, glm::vec3 rot) {
     return mvp;
 }
 
+// Runs with the same MVP: the first one fills the vertex cache, the second
+// one hits it, the third one has the cache disabled and is aborted after a
+// few vertices, and the fourth one, also without the cache, has to produce
+// the triangles of the first one again
+#define RUN_FIRST 0
+#define RUN_CACHED 1
+#define RUN_ABORTED 2
+#define RUN_RECOVERED 3
+#define NUM_RUNS 4
+#define ABORT_AFTER_VERTICES 8
+#define ABORT_LATENCY 2         // Clocks from i_abort until the reads stop
+#define ABORT_TIMEOUT_CLKS 1000
+
 #define RESET_CLKS 8
 #define MAX_SIM_TIME 1152921504606846976
 vluint64_t sim_time = 0;
@@ -260,6 +274,8 @@ int main(int argc, char** argv) {
             }
         }
         dut->i_mvp_dv = 0;
+        dut->i_vertex_cache_en = 1;
+        dut->i_abort = 0;
 
         dut->i_vertex_last = 0;
         dut->i_vertex[0] = 0;
@@ -279,7 +295,16 @@ int main(int argc, char** argv) {
 
     // Run simulation while (sim_time < MAX_SIM_TIME) {
     long long vertex_index = 0;
-    std::vector<Triangle_t> output_triangles = {};
+    std::vector<Triangle_t> run_triangles[NUM_RUNS];
+    std::vector<Triangle_t>& output_triangles = run_triangles[RUN_FIRST];
+    std::vector<Triangle_t>& cached_triangles = run_triangles[RUN_CACHED];
+    int vertices_read_cached = 0;
+    bool cache_hit = false;
+
+    int vertices_read_run = 0;
+    int abort_clks = 0;
+    int reads_after_abort = 0;
+    int aborted_last_triangles = 0;
 
     bool shouldReset = false;
     int num_rendered = 0;
@@ -307,6 +332,25 @@ int main(int argc, char** argv) {
             if (shouldReset)
                 printf("Resetting\n");
 
+            if (num_rendered == RUN_CACHED && dut->o_model_buff_vertex_read_en)
+                vertices_read_cached++;
+
+            // Abort the third run, and check that the model reads stop
+            if (dut->o_model_buff_vertex_read_en)
+                vertices_read_run++;
+            dut->i_vertex_cache_en = num_rendered < RUN_ABORTED;
+            dut->i_abort = num_rendered == RUN_ABORTED && vertices_read_run >= ABORT_AFTER_VERTICES;
+            if (dut->i_abort) {
+                abort_clks++;
+                if (abort_clks > ABORT_LATENCY &&
+                    (dut->o_model_buff_vertex_read_en || dut->o_model_buff_index_read_en))
+                    reads_after_abort++;
+                if (abort_clks == ABORT_TIMEOUT_CLKS) {
+                    printf("Error: aborted run did not finish\n");
+                    break;
+                }
+            }
+
             // Assign vertex and index data
             assign_vertex_data(dut, vertex_buffer, shouldReset);                    
             assign_index_data(dut, index_buffer, shouldReset);
@@ -334,7 +378,11 @@ int main(int argc, char** argv) {
                 // Store triangle data
                 Triangle_t tri = {glm::ivec2(v0[0], v0[1]), v0_z, glm::ivec2(v1[0], v1[1]), v1_z, glm::ivec2(v2[0], v2[1]), v2_z};
                 printf("Triangle %d: (%d, %d, %f), (%d, %d, %f), (%d, %d, %f)\n", num_triangles_rec, v0[0], v0[1], v0_z, v1[0], v1[1], v1_z, v2[0], v2[1], v2_z);
-                output_triangles.push_back(tri);
+                // The second run has the same MVP, and should come from the vertex cache
+                if (num_rendered < NUM_RUNS)
+                    run_triangles[num_rendered].push_back(tri);
+                if (num_rendered == RUN_ABORTED && dut->o_triangle_last)
+                    aborted_last_triangles++;
             }
 
             static bool enable_rasterizer_emulation = true;
@@ -357,8 +405,11 @@ int main(int argc, char** argv) {
                 // printf("Finished! %f ms (%ld)\n", (float)(CLK_PERIOD * posedge_cnt)/1000000, posedge_cnt);
                 printf("Transform pipeline done\n");
                 shouldReset = true;
+                if (num_rendered == RUN_CACHED)
+                    cache_hit = dut->o_vertex_cache_hit;
                 num_rendered++;
-                if (num_rendered >= 1)
+                vertices_read_run = 0;
+                if (num_rendered >= NUM_RUNS)
                     break;
             }
         }
@@ -377,9 +428,62 @@ int main(int argc, char** argv) {
         write_triangle_data("model.tri", output_triangles);
     }
    
+    // Check the vertex cache
+    int errors = 0;
+    if (!cache_hit) {
+        printf("Error: second run with the same MVP did not hit the vertex cache\n");
+        errors++;
+    }
+    if (vertices_read_cached != 0) {
+        printf("Error: %d vertices read on a vertex cache hit\n", vertices_read_cached);
+        errors++;
+    }
+    if (cached_triangles.size() != output_triangles.size()) {
+        printf("Error: %ld triangles from the vertex cache, expected %ld\n", cached_triangles.size(), output_triangles.size());
+        errors++;
+    } else {
+        for (size_t i = 0; i < output_triangles.size(); i++) {
+            if (memcmp(&cached_triangles[i], &output_triangles[i], sizeof(Triangle_t)) != 0) {
+                printf("Error: triangle %ld differs on the vertex cache hit\n", i);
+                errors++;
+            }
+        }
+    }
+
+    // Check the aborted run, and the run after it
+    if (num_rendered != NUM_RUNS) {
+        printf("Error: only %d of %d runs finished\n", num_rendered, NUM_RUNS);
+        errors++;
+    }
+    if (reads_after_abort != 0) {
+        printf("Error: %d model reads after the abort\n", reads_after_abort);
+        errors++;
+    }
+    if (aborted_last_triangles != 1) {
+        printf("Error: aborted run ended with %d last triangles\n", aborted_last_triangles);
+        errors++;
+    }
+    if (run_triangles[RUN_ABORTED].size() >= output_triangles.size()) {
+        printf("Error: aborted run output %ld triangles\n", run_triangles[RUN_ABORTED].size());
+        errors++;
+    }
+    if (run_triangles[RUN_RECOVERED].size() != output_triangles.size()) {
+        printf("Error: %ld triangles after the abort, expected %ld\n",
+               run_triangles[RUN_RECOVERED].size(), output_triangles.size());
+        errors++;
+    } else {
+        for (size_t i = 0; i < output_triangles.size(); i++) {
+            if (memcmp(&run_triangles[RUN_RECOVERED][i], &output_triangles[i], sizeof(Triangle_t)) != 0) {
+                printf("Error: triangle %ld differs after the abort\n", i);
+                errors++;
+            }
+        }
+    }
+    printf("%s: %d errors\n", errors ? "FAILED" : "PASSED", errors);
+
     m_trace->close();
     delete dut;
-    exit(EXIT_SUCCESS);
+    exit(errors ? EXIT_FAILURE : EXIT_SUCCESS);
 }
 
 void print_matrix_glm(glm::mat4 m) {
@@ -14,12 +14,25 @@ module render_pipeline #(
 
     parameter unsigned ADDRWIDTH = $clog2(SCREEN_WIDTH * SCREEN_HEIGHT),
 
+    // Binned tile rasterizer, see rasterizer_tile_backend
+    parameter bit TILED_RASTERIZER = 0,
+    parameter unsigned TILE_WIDTH = 32,
+    parameter unsigned TILE_HEIGHT = 32,
+    parameter unsigned MAX_TILED_TRIANGLES = 1024,
+    parameter unsigned FB_WRAP_ROWS = 0,    // Framebuffer is a ring of this many rows
+
+    // Rasterizer back-end on clk_backend, see rasterizer
+    parameter bit BACKEND_CLOCK_CROSSING = 0,
+
     parameter real ZFAR = 100.0,
     parameter real ZNEAR = 0.1
     ) (
     input logic clk,
     input logic rstn,
 
+    input logic clk_backend,
+    input logic rstn_backend,
+
     input  logic start,
     output logic ready,
     output logic finished,
@@ -29,6 +42,10 @@ module render_pipeline #(
     input  logic signed [INPUT_DATAWIDTH-1:0] i_mvp_matrix[4][4],
     input  logic i_mvp_dv,
 
+    // Reuse the transformed vertices of the last frame if the MVP is unchanged
+    input  logic i_vertex_cache_en,
+    output logic o_vertex_cache_hit,
+
     // Read vertex data from Model Buffer -- Effectively accessed as SAM
     output logic o_model_buff_vertex_read_en,
     input  logic signed [INPUT_DATAWIDTH-1:0] i_vertex[3],
@@ -46,7 +63,28 @@ module render_pipeline #(
     output logic o_fb_write_en,
 
     output logic [OUTPUT_DATAWIDTH-1:0] o_fb_depth_data,
-    output logic [COLORWIDTH-1:0] o_fb_color_data
+    output logic [COLORWIDTH-1:0] o_fb_color_data,
+
+    // Tiled rasterizer: tiles below this may be written out
+    input logic [OUTPUT_DATAWIDTH-1:0] i_tile_write_limit,
+
+    // Dynamic resolution: the frame is rendered at SCREEN >> i_res_shift into
+    // the top left of the framebuffer. Must be held for the whole frame
+    input logic [1:0] i_res_shift,
+
+    // Frame deadline: while set, the transform pipeline stops reading the
+    // model and ends the triangle stream, the triangles already on their way
+    // are dropped, and the frame finishes with what has been rasterized so far
+    input logic i_abort,
+
+    // Performance counter events, one bit per event:
+    //  [0] transform pipeline busy     [1] transform pipeline stalled
+    //  [2] rasterizer busy             [3] rasterizer front-end stalled
+    //  [4] vertex transformed          [5] vertex clipped
+    //  [6] triangle assembled          [7] triangle dropped (i_abort)
+    //  [8] triangle culled, backface   [9] triangle culled, bounding box
+    // [10] pixel tested               [11] pixel passed, only with TILED
+    output logic [11:0] o_perf_events
     );
 
     // TODO: Actually use the signals for something
@@ -63,6 +101,7 @@ module render_pipeline #(
     logic signed [OUTPUT_DATAWIDTH-1:0] tp_v2[3];
     logic tp_o_triangle_dv;
     logic tp_o_triangle_last;
+    logic [1:0] tp_perf_events;
 
     transform_pipeline #(
         .INPUT_DATAWIDTH(INPUT_DATAWIDTH),
@@ -90,6 +129,11 @@ module render_pipeline #(
         .i_mvp_matrix(i_mvp_matrix),
         .i_mvp_dv(i_mvp_dv),
 
+        .i_vertex_cache_en(i_vertex_cache_en),
+        .o_vertex_cache_hit(o_vertex_cache_hit),
+
+        .i_abort(i_abort),
+
         .o_model_buff_vertex_read_en(o_model_buff_vertex_read_en),
         .i_vertex(i_vertex),
         .i_vertex_dv(i_vertex_dv),
@@ -104,29 +148,110 @@ module render_pipeline #(
         .o_v1(tp_v1),
         .o_v2(tp_v2),
         .o_triangle_dv(tp_o_triangle_dv),
-        .o_triangle_last(tp_o_triangle_last)
+        .o_triangle_last(tp_o_triangle_last),
+
+        .o_perf_events(tp_perf_events)
     );
 
-    // TODO: Replace with finished Rasterizer
+    // Triangle stream from the primitive assembler to the rasterizer. The
+    // skid buffer lets the primitive assembler start on the next triangle
+    // while the rasterizer frontend is still busy.
+    //
+    // The primitive assembler checks transform_pipeline_next before it
+    // assembles a triangle, and does not wait for it when the triangle is
+    // output. So it is only told to go on when the buffer has room, and not
+    // while a triangle is going in, which is only counted the cycle after.
+    localparam unsigned TRIANGLE_WIDTH = 9 * OUTPUT_DATAWIDTH + 1;
+
+    logic [TRIANGLE_WIDTH-1:0] w_triangle_in;
+    logic [TRIANGLE_WIDTH-1:0] w_triangle_out;
+    logic w_triangle_in_ready;
+    logic w_triangle_dv;
     logic w_rasterizer_ready;
+
+    logic signed [OUTPUT_DATAWIDTH-1:0] w_triangle_v0[3];
+    logic signed [OUTPUT_DATAWIDTH-1:0] w_triangle_v1[3];
+    logic signed [OUTPUT_DATAWIDTH-1:0] w_triangle_v2[3];
+    logic w_triangle_last;
+
+    assign w_triangle_in = {tp_v0[0], tp_v0[1], tp_v0[2],
+                            tp_v1[0], tp_v1[1], tp_v1[2],
+                            tp_v2[0], tp_v2[1], tp_v2[2],
+                            tp_o_triangle_last};
+    assign {w_triangle_v0[0], w_triangle_v0[1], w_triangle_v0[2],
+            w_triangle_v1[0], w_triangle_v1[1], w_triangle_v1[2],
+            w_triangle_v2[0], w_triangle_v2[1], w_triangle_v2[2],
+            w_triangle_last} = w_triangle_out;
+
+    skid_buffer #(
+        .DATA_WIDTH(TRIANGLE_WIDTH)
+    ) triangle_skid_buffer_inst (
+        .clk(clk),
+        .rstn(rstn),
+
+        .i_data(w_triangle_in),
+        .i_valid(tp_o_triangle_dv),
+        .o_ready(w_triangle_in_ready),
+
+        .o_data(w_triangle_out),
+        .o_valid(w_triangle_dv),
+        .i_ready(w_rasterizer_ready)
+    );
+
+    // Scale the screen space vertices to the reduced viewport. The vertices
+    // are whole pixels, so this is the same as a viewport transform at the
+    // lower resolution.
+    //
+    // Dropped triangles are replaced by an empty one, which the rasterizer
+    // frontend culls straight away. The stream still ends with the last
+    // triangle, so the rasterizer finishes the frame as normal and nothing
+    // has to be reset.
+    logic signed [OUTPUT_DATAWIDTH-1:0] w_rasterizer_v0[3];
+    logic signed [OUTPUT_DATAWIDTH-1:0] w_rasterizer_v1[3];
+    logic signed [OUTPUT_DATAWIDTH-1:0] w_rasterizer_v2[3];
+    always_comb begin
+        if (i_abort) begin
+            w_rasterizer_v0 = '{'0, '0, '0};
+            w_rasterizer_v1 = '{'0, '0, '0};
+            w_rasterizer_v2 = '{'0, '0, '0};
+        end else begin
+            w_rasterizer_v0 = '{w_triangle_v0[0] >>> i_res_shift, w_triangle_v0[1] >>> i_res_shift, w_triangle_v0[2]};
+            w_rasterizer_v1 = '{w_triangle_v1[0] >>> i_res_shift, w_triangle_v1[1] >>> i_res_shift, w_triangle_v1[2]};
+            w_rasterizer_v2 = '{w_triangle_v2[0] >>> i_res_shift, w_triangle_v2[1] >>> i_res_shift, w_triangle_v2[2]};
+        end
+    end
+
+    // TODO: Replace with finished Rasterizer
     logic w_rasterizer_finished;
+    logic [4:0] w_rasterizer_perf_events;
     rasterizer #(
         .DATAWIDTH(OUTPUT_DATAWIDTH),
         .COLORWIDTH(COLORWIDTH),
         .SCREEN_WIDTH(SCREEN_WIDTH),
         .SCREEN_HEIGHT(SCREEN_HEIGHT),
-        .ADDRWIDTH(ADDRWIDTH)
+        .ADDRWIDTH(ADDRWIDTH),
+        .TILED(TILED_RASTERIZER),
+        .TILE_WIDTH(TILE_WIDTH),
+        .TILE_HEIGHT(TILE_HEIGHT),
+        .MAX_TILED_TRIANGLES(MAX_TILED_TRIANGLES),
+        .FB_WRAP_ROWS(FB_WRAP_ROWS),
+        .BACKEND_CLOCK_CROSSING(BACKEND_CLOCK_CROSSING)
     ) rasterizer_inst (
         .clk(clk),
         .rstn(rstn),
 
+        .clk_backend(clk_backend),
+        .rstn_backend(rstn_backend),
+
         .ready(w_rasterizer_ready),
 
-        .i_v0(tp_v0),
-        .i_v1(tp_v1),
-        .i_v2(tp_v2),
-        .i_triangle_dv(tp_o_triangle_dv),
-        .i_triangle_last(tp_o_triangle_last),
+        .i_v0(w_rasterizer_v0),
+        .i_v1(w_rasterizer_v1),
+        .i_v2(w_rasterizer_v2),
+        .i_triangle_dv(w_triangle_dv),
+        .i_triangle_last(w_triangle_last),
+
+        .i_res_shift(i_res_shift),
 
         .o_fb_addr_write(o_fb_addr_write),
         .o_fb_write_en(o_fb_write_en),
@@ -134,9 +259,26 @@ module render_pipeline #(
         .o_fb_depth_data(o_fb_depth_data),
         .o_fb_color_data(o_fb_color_data),
 
-        .finished(w_rasterizer_finished)
+        .i_tile_write_limit(i_tile_write_limit),
+
+        .finished(w_rasterizer_finished),
+
+        .o_perf_events(w_rasterizer_perf_events)
     );
 
+    // Performance counter events
+    always_comb begin
+        o_perf_events[0] = ~transform_pipeline_ready;
+        o_perf_events[1] = ~transform_pipeline_ready && ~transform_pipeline_next;
+        o_perf_events[2] = ~w_rasterizer_ready;
+        o_perf_events[3] = w_rasterizer_perf_events[2];
+        o_perf_events[5:4] = tp_perf_events;
+        o_perf_events[6] = tp_o_triangle_dv;
+        o_perf_events[7] = w_triangle_dv && w_rasterizer_ready && i_abort;
+        o_perf_events[9:8] = w_rasterizer_perf_events[1:0];
+        o_perf_events[11:10] = w_rasterizer_perf_events[4:3];
+    end
+
     // Latch finish
     always_ff @(posedge clk) begin
         if (~rstn) begin
@@ -153,7 +295,7 @@ module render_pipeline #(
 
     // Assign internal signals
     assign transform_pipeline_start = start;
-    assign transform_pipeline_next = w_rasterizer_ready;
+    assign transform_pipeline_next = w_triangle_in_ready && ~tp_o_triangle_dv;
 
     // Assign external signals
     assign ready = transform_pipeline_ready;
@@ -153,9 +153,11 @@ int main(int argc, char* argv[]) {
     dut->clk = 0;
     for (int i = 0; i < 8; i++) {
         dut->clk ^= 1;
+        dut->clk_backend = dut->clk;
         dut->eval();
 
         dut->rstn = 0;
+        dut->rstn_backend = 0;
         dut->start = 0;
         dut->i_mvp_dv = 0;
         dut->i_vertex_dv = 0;
@@ -174,6 +176,7 @@ int main(int argc, char* argv[]) {
         }
     }
     dut->rstn = 1;
+    dut->rstn_backend = 1;
 
     // Main loop
     float t = 0.0f;
@@ -181,6 +184,7 @@ int main(int argc, char* argv[]) {
     while (true) {
         // Main sim
         dut->clk ^= 1;
+        dut->clk_backend = dut->clk;
         dut->eval();
 
         if (view.update()) {
@@ -12,6 +12,14 @@ module spi_slave (
     output reg o_RX_DV,
     output reg [7:0] o_RX_Byte,
 
+    // The TX byte is captured at the start of every byte, and shifted out on
+    // MISO. The first byte after CSn goes low is always 0x00. o_TX_Ready
+    // pulses when the TX byte has been captured, and i_TX_Byte can then be
+    // loaded with the byte to send after the one currently being sent.
+    input i_TX_DV,
+    input [7:0] i_TX_Byte,
+    output reg o_TX_Ready,
+
     // SPI Signals
     input SCK,
     output reg MISO,
@@ -26,6 +34,11 @@ module spi_slave (
     logic [7:0] r_RX_Byte;
     logic r_RX_Done, r_RX_Done_1, r_RX_Done_2; // Shift register for CDC from SPI to system
 
+    logic [7:0] r_TX_Byte;
+    logic [7:0] r_TX_Shift;
+    logic [2:0] r_TX_Bit_Count;
+    logic r_TX_Done, r_TX_Done_1, r_TX_Done_2; // Shift register for CDC from SPI to system
+
     always_ff @(posedge SCK or posedge CSn) begin
         if (CSn) begin
             r_RX_Bit_Count <= '0;
@@ -43,6 +56,28 @@ module spi_slave (
         end
     end
 
+    // MISO changes on the falling edge of SCK (mode 0), MSB first
+    always_ff @(negedge SCK or posedge CSn) begin
+        if (CSn) begin
+            r_TX_Bit_Count <= '0;
+            r_TX_Shift <= '0;
+            r_TX_Done <= 1'b0;
+        end else begin
+            r_TX_Bit_Count <= r_TX_Bit_Count + 1;
+
+            if (r_TX_Bit_Count == 3'b111) begin
+                r_TX_Done <= 1'b1;
+                r_TX_Shift <= r_TX_Byte;
+            end else if (r_TX_Bit_Count == 3'b010) begin
+                r_TX_Done <= 1'b0;
+            end
+        end
+    end
+
+    always_comb begin
+        MISO = r_TX_Shift[~r_TX_Bit_Count];
+    end
+
     // Cross from SPI Clock domain to system clock domain
     always_ff @(posedge clk) begin
         if (~rstn) begin
@@ -50,6 +85,11 @@ module spi_slave (
            r_RX_Done_2 <= 1'b0;
            o_RX_Byte <= '0;
            o_RX_DV <= 1'b0;
+
+           r_TX_Done_1 <= 1'b0;
+           r_TX_Done_2 <= 1'b0;
+           r_TX_Byte <= '0;
+           o_TX_Ready <= 1'b0;
         end else begin
             // Shift RX_Done signal
             r_RX_Done_1 <= r_RX_Done;
@@ -62,6 +102,17 @@ module spi_slave (
             end else begin
                 o_RX_DV <= 1'b0;
             end
+
+            // Shift TX_Done signal
+            r_TX_Done_1 <= r_TX_Done;
+            r_TX_Done_2 <= r_TX_Done_1;
+            o_TX_Ready <= (r_TX_Done_2 == 1'b0 & r_TX_Done_1 == 1'b1);
+
+            // Only changes right after a capture, so it is stable when the
+            // next byte is captured in the SCK domain
+            if (i_TX_DV) begin
+                r_TX_Byte <= i_TX_Byte;
+            end
         end
     end
 endmodule
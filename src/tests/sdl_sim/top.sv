@@ -101,6 +101,9 @@ module top #(
         .clk(clk_100m),
         .rstn(~sim_rst),
 
+        .clk_backend(clk_100m),
+        .rstn_backend(~sim_rst),
+
         .ready(w_rasterizer_ready),
 
         .i_v0(v0),
@@ -109,13 +112,18 @@ module top #(
         .i_triangle_dv(r_triangle_dv),
         .i_triangle_last(1), // current_triangle == 2'b10
 
+        .i_res_shift(2'b00),
+
         .o_fb_addr_write(i_pixel_write_addr),
         .o_fb_write_en(fb_write_enable),
         .o_fb_depth_data(w_depth_data),
         // .o_fb_color_data(w_color_data),
         .o_fb_color_data(),
 
-        .finished(done)
+        .i_tile_write_limit('1),
+
+        .finished(done),
+        .o_perf_events()
     );
 
     typedef enum logic [2:0] {
@@ -253,6 +261,7 @@ module top #(
         .clk(clk_100m),
         .clk_pixel(clk_pix),
         .rstn(~sim_rst),
+        .rst_pix(sim_rst),
 
         .frame_render_done(done),
         .frame_clear(clear),
@@ -263,6 +272,21 @@ module top #(
         .i_pixel_write_valid(fb_write_enable),
         .i_fb_data(w_color_data),
         .i_db_data(w_depth_data),
+        .i_pixel_write_static(1'b0),
+
+        .i_word_write_addr('0),
+        .i_word_write_mask('0),
+        .i_word_fb_data('0),
+        .i_word_write_valid(1'b0),
+
+        .background_capture(1'b0),
+        .background_invalidate(1'b0),
+        .background_valid(),
+
+        .band_write_limit(),
+
+        .res_shift(2'b00),
+        .pixel_depth_pass(),
 
         .o_red(red),
         .o_green(green),
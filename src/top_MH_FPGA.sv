@@ -17,6 +17,19 @@ module top_MH_FPGA #(
     input logic btn,
     output logic [2:0] led,
 
+    // SPI from the MCU, see mcu_fpga_com
+    input  logic SCK,
+    input  logic MOSI,
+    output logic MISO,
+    input  logic CSn,
+
+`ifdef MODEL_SOURCE_PSRAM
+    // Quad SPI PSRAM, see MODEL_SOURCE_PSRAM below
+    output      logic psram_ce_n,
+    output      logic psram_sclk,
+    inout       wire  [3:0] psram_sio,
+`endif
+
     output      logic vga_hsync,    // horizontal sync
     output      logic vga_vsync,    // vertical sync
     output      logic [3:0] vga_r,  // (8-bit temp for sim) 4-bit VGA red
@@ -36,29 +49,102 @@ module top_MH_FPGA #(
     parameter unsigned MAX_MODEL_COUNT    = 16;
     parameter unsigned MAX_NUM_OBJECTS_PER_FRAME = 1024;
 
+    // With the MODEL_SOURCE_PSRAM define the models are read from an external
+    // PSRAM, see psram_model_reader, and the top has the PSRAM ports. The
+    // PSRAM holds all models, laid out like the ROM files and with the same
+    // header. The models below ROM_MODEL_COUNT are still read from the
+    // on-chip ROMs. This is a fixed split by model id, not a cache, and
+    // nothing loads the PSRAM yet.
+    parameter unsigned ROM_MODEL_COUNT = 4;
+
     parameter unsigned SCREEN_WIDTH  = 320;
     parameter unsigned SCREEN_HEIGHT = 240;
 
     parameter unsigned ADDRWIDTH = $clog2(SCREEN_WIDTH * SCREEN_HEIGHT);
 
+    // Binned rendering with on-chip tile buffers, removes the depth buffer
+    parameter bit TILED_RASTERIZER = 0;
+
+    // Rasterizer back-end on the 200 MHz clock, not with TILED_RASTERIZER.
+    // Doubles the test rate of the uncovered bounding box pixels, the covered
+    // pixels are still written at one per 100 MHz cycle
+    parameter bit RASTERIZER_CLOCK_CROSSING = 0;
+
+    // Beam racing, needs TILED_RASTERIZER. The tiles are full width bands that
+    // are rendered just ahead of the scanout into a ring of two band buffers,
+    // which replaces the framebuffers. The frame is started at the start of
+    // vertical blanking, so it is displayed less than a frame later.
+    parameter bit BEAM_RACING = 0;
+    parameter unsigned BAND_HEIGHT = 16;
+
+    // Dynamic resolution, not with BEAM_RACING. When a frame took more than
+    // DRS_FRAME_BUDGET cycles from setup to finished, the next frame is
+    // rendered at half the resolution and scanned out at twice the scale,
+    // down to SCREEN >> DRS_MAX_SHIFT. A step is a quarter of the pixels, so
+    // the resolution is only raised again below DRS_RAISE_BUDGET.
+    parameter bit DYNAMIC_RESOLUTION = 0;
+    parameter unsigned DRS_MAX_SHIFT = 1;                   // 160x120
+    parameter unsigned DRS_FRAME_BUDGET = 1_600_000;        // 60 Hz at 100 MHz, with some margin
+    parameter unsigned DRS_RAISE_BUDGET = DRS_FRAME_BUDGET / 8;
+
+    // Frame deadline in cycles from FRAME_SETUP, 0: none. When it expires the
+    // model reader and transform pipeline stop, the triangles already on
+    // their way are dropped at the rasterizer input, and the partial frame is
+    // presented. Triangles are dropped in submission order, so objects should
+    // be sent most important first.
+    parameter unsigned FRAME_DEADLINE = 0;
+
+    // Conditional rendering. An object without visible pixels in the last
+    // OCCLUSION_SKIP_FRAMES frames is skipped, and the model reader never
+    // streams it. It is re-tested every OCCLUSION_RETEST_FRAMES + 1 frames.
+    parameter bit CONDITIONAL_RENDERING = 0;
+    parameter unsigned OCCLUSION_SKIP_FRAMES = 4;
+    parameter unsigned OCCLUSION_RETEST_FRAMES = 15;
+
     parameter real ZFAR = 100.0;
     parameter real ZNEAR = 0.1;
 
     parameter string PALETTE_FILE = "palette.mem";
     parameter string FB_IMAGE_FILE = "image.mem";
 
-    parameter unsigned TRIG_LUT_ADDRWIDTH = 12;
+    parameter unsigned ANGLE_WIDTH = 16;   // A full turn is 1 << ANGLE_WIDTH
+
+    // Objects posed by the MCU (CMD_FRAME_POSE) instead of the spinning demo
+    // object. The objects of a packet are sorted front to back by object_sort
+    // and their poses fed to pose_mvp nearest first. One object is still
+    // drawn per frame, so the objects of a packet are drawn over consecutive
+    // frames, and a frame waits for the MCU when there is none left. Packets
+    // that arrive before the last one is read out of the sorter are dropped,
+    // as are the objects beyond SORT_MAX_OBJECTS. The view-projection stays
+    // fixed.
+    parameter bit MCU_OBJECTS = 0;
+    parameter unsigned SORT_MAX_OBJECTS = 256;
 
     logic rstn      /* verilator public_flat_rw */;
 
+    // Parameter combinations that are not supported
+    generate
+        if (BEAM_RACING && !TILED_RASTERIZER) begin : g_check_beam_racing
+            $error("BEAM_RACING needs TILED_RASTERIZER");
+        end
+        if (RASTERIZER_CLOCK_CROSSING && TILED_RASTERIZER) begin : g_check_clock_crossing
+            $error("RASTERIZER_CLOCK_CROSSING can not be used with TILED_RASTERIZER");
+        end
+        if (DYNAMIC_RESOLUTION && BEAM_RACING) begin : g_check_dynamic_resolution
+            $error("DYNAMIC_RESOLUTION can not be used with BEAM_RACING");
+        end
+    endgenerate
+
     // ============================ SYSTEM CLOCK =============================
     logic clk_100m;
+    logic clk_200m;
     logic sys_clk_rstn;
     logic clk_100m_locked;
     clock_100Mhz sys_clock_inst (
         .clk_20m(clk),
         .rst(0),
         .clk_100m(clk_100m),
+        .clk_200m(clk_200m),
         .clk_100m_5x(),
         .clk_100m_locked(clk_100m_locked)
     );
@@ -84,6 +170,10 @@ module top_MH_FPGA #(
         end
     endgenerate
 
+    // Reset synchronized to clk_200m
+    logic [1:0] r_rstn_200m_sync = '0;
+    always_ff @(posedge clk_200m) r_rstn_200m_sync <= {r_rstn_200m_sync[0], rstn};
+
     // ============================ MODEL READER =============================
     logic w_model_reader_ready;
     logic r_model_reader_reset = 1'b0;
@@ -102,6 +192,114 @@ module top_MH_FPGA #(
     logic r_index_dv;
     logic r_index_last;
 
+`ifdef MODEL_SOURCE_PSRAM
+    // Both readers start on every model, the one that holds it streams it.
+    // The ROMs only need the models below ROM_MODEL_COUNT.
+    logic w_from_rom;
+    assign w_from_rom = 32'(r_model_id) < ROM_MODEL_COUNT;
+
+    logic w_rom_ready;
+    logic signed [INPUT_DATAWIDTH-1:0] w_rom_vertex[3];
+    logic w_rom_vertex_dv;
+    logic w_rom_vertex_last;
+    logic [$clog2(MAX_VERTEX_COUNT)-1:0] w_rom_index_data[3];
+    logic w_rom_index_dv;
+    logic w_rom_index_last;
+
+    logic w_psram_ready;
+    logic signed [INPUT_DATAWIDTH-1:0] w_psram_vertex[3];
+    logic w_psram_vertex_dv;
+    logic w_psram_vertex_last;
+    logic [$clog2(MAX_VERTEX_COUNT)-1:0] w_psram_index_data[3];
+    logic w_psram_index_dv;
+    logic w_psram_index_last;
+
+    logic [3:0] w_psram_sio_out;
+    logic [3:0] w_psram_sio_oe;
+
+    model_reader #(
+        .MODEL_INDEX_WIDTH($clog2(MAX_MODEL_COUNT)),
+        .INDEX_ADDR_WIDTH($clog2(MAX_INDEX_COUNT)),
+        .VERTEX_ADDR_WIDTH($clog2(MAX_VERTEX_COUNT)),
+        .COORDINATE_WIDTH(INPUT_DATAWIDTH),
+        .MODEL_HEADER_FILE("model_headers.mem"),
+        .MODEL_FACES_FILE("model_faces.mem"),
+        .MODEL_VERTEX_FILE("model_vertex.mem")
+    ) rom_model_reader_inst (
+        .clk(clk_100m),
+        .reset(r_model_reader_reset),
+        .ready(w_rom_ready),
+
+        .model_index(r_model_id),
+
+        .index_read_en (w_model_buff_index_read_en && w_from_rom),
+        .vertex_read_en(w_model_buff_vertex_read_en && w_from_rom),
+
+        .index_data(w_rom_index_data),
+        .vertex_data(w_rom_vertex),
+
+        .index_o_dv(w_rom_index_dv),
+        .vertex_o_dv(w_rom_vertex_dv),
+        .index_data_last(w_rom_index_last),
+        .vertex_data_last(w_rom_vertex_last)
+    );
+
+    psram_model_reader #(
+        .MODEL_INDEX_WIDTH($clog2(MAX_MODEL_COUNT)),
+        .INDEX_ADDR_WIDTH($clog2(MAX_INDEX_COUNT)),
+        .VERTEX_ADDR_WIDTH($clog2(MAX_VERTEX_COUNT)),
+        .COORDINATE_WIDTH(INPUT_DATAWIDTH),
+        .MODEL_HEADER_FILE("model_headers.mem")
+    ) psram_model_reader_inst (
+        .clk(clk_100m),
+        .rstn(rstn),
+        .reset(r_model_reader_reset),
+        .ready(w_psram_ready),
+
+        .model_index(r_model_id),
+
+        .index_read_en (w_model_buff_index_read_en && ~w_from_rom),
+        .vertex_read_en(w_model_buff_vertex_read_en && ~w_from_rom),
+
+        .index_data(w_psram_index_data),
+        .vertex_data(w_psram_vertex),
+
+        .index_o_dv(w_psram_index_dv),
+        .vertex_o_dv(w_psram_vertex_dv),
+        .index_data_last(w_psram_index_last),
+        .vertex_data_last(w_psram_vertex_last),
+
+        .o_psram_ce_n(psram_ce_n),
+        .o_psram_sclk(psram_sclk),
+        .o_psram_sio(w_psram_sio_out),
+        .o_psram_sio_oe(w_psram_sio_oe),
+        .i_psram_sio(psram_sio)
+    );
+
+    for (genvar i = 0; i < 4; i++) begin : g_psram_sio
+        assign psram_sio[i] = w_psram_sio_oe[i] ? w_psram_sio_out[i] : 1'bz;
+    end
+
+    always_comb begin
+        if (w_from_rom) begin
+            w_model_reader_ready = w_rom_ready;
+            r_vertex = w_rom_vertex;
+            r_vertex_dv = w_rom_vertex_dv;
+            r_vertex_last = w_rom_vertex_last;
+            r_index_data = w_rom_index_data;
+            r_index_dv = w_rom_index_dv;
+            r_index_last = w_rom_index_last;
+        end else begin
+            w_model_reader_ready = w_psram_ready;
+            r_vertex = w_psram_vertex;
+            r_vertex_dv = w_psram_vertex_dv;
+            r_vertex_last = w_psram_vertex_last;
+            r_index_data = w_psram_index_data;
+            r_index_dv = w_psram_index_dv;
+            r_index_last = w_psram_index_last;
+        end
+    end
+`else
     model_reader #(
         .MODEL_INDEX_WIDTH($clog2(MAX_MODEL_COUNT)),
         .INDEX_ADDR_WIDTH($clog2(MAX_INDEX_COUNT)),
@@ -128,9 +326,10 @@ module top_MH_FPGA #(
         .index_data_last(r_index_last),
         .vertex_data_last(r_vertex_last)
     );
+`endif
 
     // =========================== MVP Matrix Generation ===========================
-    logic [TRIG_LUT_ADDRWIDTH-1:0] r_angle = '0;
+    logic [ANGLE_WIDTH-1:0] r_angle = '0;
 
     logic signed [INPUT_DATAWIDTH-1:0] r_view_projection_mat[4][4] = '{
         '{24'h0039F1, '0, '0, '0},
@@ -138,49 +337,254 @@ module top_MH_FPGA #(
         '{'0, '0, 24'hFFDFF0, 24'h0021AC},
         '{'0, '0, 24'hFFE000, 24'h002800}
     };
-    logic signed [INPUT_DATAWIDTH-1:0] w_rot_y_mat[4][4];
-    logic r_mvp_matrix_compontents_dv = 1'b0;
+    logic signed [INPUT_DATAWIDTH-1:0] r_position[3] = '{'0, '0, '0};
+    logic r_pose_dv = 1'b0;
+    logic r_pose_busy = 1'b0;
+    logic w_pose_ready;
+    logic w_pose_issue;
+
+    // Pose of the next object
+    logic signed [INPUT_DATAWIDTH-1:0] w_pose_position[3];
+    logic [ANGLE_WIDTH-1:0] w_pose_yaw;
+    logic [ANGLE_WIDTH-1:0] w_pose_pitch;
+    logic [ANGLE_WIDTH-1:0] w_pose_roll;
+    logic w_pose_available;
+
+    // Objects from the MCU, see MCU INTERFACE
+    logic [$clog2(MAX_NUM_OBJECTS_PER_FRAME):0] w_mcu_num_objects;
+    logic w_mcu_num_objects_dv;
+    logic [INPUT_DATAWIDTH-1:0] w_mcu_object_position[3];
+    logic [ANGLE_WIDTH-1:0] w_mcu_object_yaw;
+    logic [ANGLE_WIDTH-1:0] w_mcu_object_pitch;
+    logic [ANGLE_WIDTH-1:0] w_mcu_object_roll;
+    logic w_mcu_object_pose_dv;
 
-    logic signed [INPUT_DATAWIDTH-1:0] w_mvp_matrix[4][4];
-    logic w_mvp_matrix_dv;
-    logic w_mat_mul_ready;
+    generate
+        if (MCU_OBJECTS) begin : g_mcu_objects
+            localparam unsigned SORT_INDEX_WIDTH = $clog2(SORT_MAX_OBJECTS);
+            localparam unsigned POSE_ENTRY_WIDTH = 3 * INPUT_DATAWIDTH + 3 * ANGLE_WIDTH;
+
+            // A packet is only taken whole, when the sorter is empty
+            logic r_sort_loading = 1'b0;
+            logic [$clog2(MAX_NUM_OBJECTS_PER_FRAME):0] r_sort_remaining = '0;
+            logic [SORT_INDEX_WIDTH:0] r_sort_count = '0;
+            logic r_sort_last = 1'b0;
+            logic r_sort_flush = 1'b0;
+
+            // Clip space w of the object origin, VP[3] * (position, 1).
+            // Equal to MVP[3][3], the key object_sort expects
+            /* verilator lint_off UNUSED */
+            logic signed [2*INPUT_DATAWIDTH+1:0] w_clip_w;
+            /* verilator lint_on UNUSED */
+            logic signed [INPUT_DATAWIDTH-1:0] r_sort_key;
+            logic [SORT_INDEX_WIDTH-1:0] r_sort_slot;
+            logic r_sort_dv = 1'b0;
+
+            logic w_sort_ready;
+            logic [SORT_INDEX_WIDTH-1:0] w_sort_data;
+            logic w_sort_dv;
+
+            logic w_pose_write_en;
+            logic [POSE_ENTRY_WIDTH-1:0] w_pose_entry;
+
+            always_comb begin
+                w_clip_w = (r_view_projection_mat[3][3] <<< INPUT_FRACBITS);
+                for (int i = 0; i < 3; i++) begin
+                    w_clip_w = w_clip_w + r_view_projection_mat[3][i] * $signed(w_mcu_object_position[i]);
+                end
+
+                w_pose_write_en = r_sort_loading && w_mcu_object_pose_dv &&
+                                  (r_sort_count < (SORT_INDEX_WIDTH+1)'(SORT_MAX_OBJECTS));
+            end
+
+            // Pose table, indexed by the order in the packet
+            bram_dp #(
+                .WIDTH(POSE_ENTRY_WIDTH),
+                .DEPTH(SORT_MAX_OBJECTS)
+            ) pose_table_inst (
+                .clk_write(clk_100m),
+                .clk_read(clk_100m),
+                .write_enable(w_pose_write_en),
+                .addr_write(r_sort_count[SORT_INDEX_WIDTH-1:0]),
+                .addr_read(w_sort_data),
+                .data_in({w_mcu_object_position[0], w_mcu_object_position[1], w_mcu_object_position[2],
+                          w_mcu_object_yaw, w_mcu_object_pitch, w_mcu_object_roll}),
+                .data_out(w_pose_entry)
+            );
+
+            object_sort #(
+                .KEY_WIDTH(INPUT_DATAWIDTH),
+                .KEY_SHIFT(INPUT_FRACBITS + 1),
+                .MAX_OBJECTS(SORT_MAX_OBJECTS),
+                .DATA_WIDTH(SORT_INDEX_WIDTH)
+            ) object_sort_inst (
+                .clk(clk_100m),
+                .rstn(rstn),
+
+                .i_key(r_sort_key),
+                .i_data(r_sort_slot),
+                .i_dv(r_sort_dv),
+                .i_flush(r_sort_flush),
+                .o_ready(w_sort_ready),
+
+                .o_data(w_sort_data),
+                .o_dv(w_sort_dv),
+                .i_next(w_pose_issue),
+                .finished()
+            );
+
+            always_ff @(posedge clk_100m) begin
+                if (~rstn) begin
+                    r_sort_loading <= 1'b0;
+                    r_sort_remaining <= '0;
+                    r_sort_count <= '0;
+                    r_sort_last <= 1'b0;
+                    r_sort_flush <= 1'b0;
+                    r_sort_dv <= 1'b0;
+                end else begin
+                    // The sorter takes the flush only after the last push
+                    r_sort_last <= 1'b0;
+                    r_sort_flush <= r_sort_last;
+                    r_sort_dv <= w_pose_write_en;
+                    r_sort_key <= w_clip_w[INPUT_FRACBITS +: INPUT_DATAWIDTH];
+                    r_sort_slot <= r_sort_count[SORT_INDEX_WIDTH-1:0];
+
+                    // CMD_FRAME and delta packets also send a count, without
+                    // poses, and are replaced by the next count. A pose packet
+                    // that is cut short is sorted as far as it came
+                    if (w_mcu_num_objects_dv && w_sort_ready && ~r_sort_last && ~r_sort_flush) begin
+                        if (~r_sort_loading || r_sort_count == '0) begin
+                            r_sort_loading <= (w_mcu_num_objects != '0);
+                            r_sort_remaining <= w_mcu_num_objects;
+                            r_sort_count <= '0;
+                            r_sort_last <= (w_mcu_num_objects == '0);
+                        end else begin
+                            r_sort_loading <= 1'b0;
+                            r_sort_last <= 1'b1;
+                        end
+                    end
+
+                    if (r_sort_loading && w_mcu_object_pose_dv) begin
+                        r_sort_remaining <= r_sort_remaining - 1;
+                        if (w_pose_write_en) begin
+                            r_sort_count <= r_sort_count + 1;
+                        end
 
-    rot_y #(
+                        if (r_sort_remaining == 1) begin
+                            r_sort_loading <= 1'b0;
+                            r_sort_last <= 1'b1;
+                        end
+                    end
+                end
+            end
+
+            // The table is read when the pose is issued, and r_pose_dv is
+            // high the cycle after
+            always_comb begin
+                {w_pose_position[0], w_pose_position[1], w_pose_position[2],
+                 w_pose_yaw, w_pose_pitch, w_pose_roll} = w_pose_entry;
+                w_pose_available = w_sort_dv;
+            end
+        end else begin : g_demo_object
+            always_comb begin
+                w_pose_position = r_position;
+                w_pose_yaw = r_angle;
+                w_pose_pitch = '0;
+                w_pose_roll = '0;
+                w_pose_available = 1'b1;
+            end
+        end
+    endgenerate
+
+    logic signed [INPUT_DATAWIDTH-1:0] w_model_matrix[4][4];
+    logic w_model_matrix_dv;
+
+    pose_mvp #(
         .DATA_WIDTH(INPUT_DATAWIDTH),
         .FRAC_BITS(INPUT_FRACBITS),
-        .TRIG_LUT_ADDR_WIDTH(TRIG_LUT_ADDRWIDTH)
-    ) rot_y_mat_inst (
+        .ANGLE_WIDTH(ANGLE_WIDTH),
+        .MULTIPLY_VIEW_PROJECTION(0)
+    ) pose_mvp_inst (
         .clk(clk_100m),
-        .angle(r_angle),
-        .rot_y_mat(w_rot_y_mat)
+        .rstn(rstn),
+
+        .i_view_projection(r_view_projection_mat),
+
+        .i_position(w_pose_position),
+        .i_yaw(w_pose_yaw),
+        .i_pitch(w_pose_pitch),
+        .i_roll(w_pose_roll),
+        .i_dv(r_pose_dv),
+        .o_ready(w_pose_ready),
+
+        .o_mvp(w_model_matrix),
+        .o_dv(w_model_matrix_dv)
     );
 
-    mat_mul #(
+    // MVP = VP * model. The MVP matrices for the next frames are computed
+    // while the current frame is rendering, and wait in the result FIFO
+    // until the render pipeline reads them
+    logic r_view_projection_loaded = 1'b0;
+    logic w_mat_chain_mul_ready;
+
+    logic w_mvp_matrix_read_en;
+    logic w_mvp_matrix_skip_read_en;    // The matrix of a skipped object is dropped
+    logic signed [INPUT_DATAWIDTH-1:0] w_mvp_matrix[4][4];
+    logic w_mvp_dv;
+
+    mat_chain_mul #(
         .DATAWIDTH(INPUT_DATAWIDTH),
-        .FRACBITS(INPUT_FRACBITS)
-    ) mat_mul_inst (
+        .FRACBITS(INPUT_FRACBITS),
+        .FIFO_DEPTH(4)
+    ) mat_chain_mul_inst (
         .clk(clk_100m),
         .rstn(rstn),
 
-        .A(r_view_projection_mat),
-        .B(w_rot_y_mat),
-        .i_dv(r_mvp_matrix_compontents_dv),
+        .i_left(r_view_projection_mat),
+        .i_left_dv(~r_view_projection_loaded),
 
-        .C(w_mvp_matrix),
-        .o_dv(w_mvp_matrix_dv),
-        .o_ready(w_mat_mul_ready)
+        .i_right(w_model_matrix),
+        .i_right_dv(w_model_matrix_dv),
+        .i_chain(1'b0),
+        .o_ready(w_mat_chain_mul_ready),
+
+        .i_read_en(w_mvp_matrix_read_en || w_mvp_matrix_skip_read_en),
+        .o_result(w_mvp_matrix),
+        .o_result_dv(w_mvp_dv),
+        .o_empty()
     );
 
+    // One pose in flight, only issued when the matrix engine has room
+    assign w_pose_issue = r_view_projection_loaded && ~r_pose_busy && w_pose_ready &&
+                          w_mat_chain_mul_ready && w_pose_available;
+
+    always_ff @(posedge clk_100m) begin
+        if (~rstn) begin
+            r_angle <= '0;
+            r_pose_dv <= 1'b0;
+            r_pose_busy <= 1'b0;
+            r_view_projection_loaded <= 1'b0;
+        end else begin
+            r_pose_dv <= 1'b0;
+            r_view_projection_loaded <= 1'b1;
+
+            if (w_pose_issue) begin
+                r_pose_dv <= 1'b1;
+                r_pose_busy <= 1'b1;
+            end
+
+            if (w_model_matrix_dv) begin
+                r_pose_busy <= 1'b0;
+                r_angle <= r_angle + 256;
+            end
+        end
+    end
+
     // =========================== RENDER_START PIPELINE ===========================
     logic r_render_pipeline_start = 1'b0;
     logic w_render_pipeline_ready;
     logic w_render_pipeline_finished;
 
-    // MVP Matrix
-    logic w_mvp_matrix_read_en;
-    logic signed [INPUT_DATAWIDTH-1:0] r_mvp_matrix[4][4];
-    logic r_mvp_dv = 1'b0;
-
     // Output raster signals
     logic [ADDRWIDTH-1:0] w_fb_addr_write;
     logic w_fb_write_en;
@@ -188,6 +592,24 @@ module top_MH_FPGA #(
     logic [OUTPUT_DATAWIDTH-1:0] w_fb_depth_data;
     logic [COLORWIDTH-1:0] w_fb_color_data;
 
+    // Beam racing, from the display
+    /* verilator lint_off UNUSED */
+    logic [15:0] w_band_write_limit;
+    /* verilator lint_on UNUSED */
+
+    // Dynamic resolution of the frame being rendered
+    logic [1:0] r_frame_res_shift = '0;
+
+    // Frame deadline expired
+    logic r_render_abort = 1'b0;
+
+    // Conditional rendering, the object of this frame is skipped
+    logic r_object_decided = 1'b0;
+    logic r_object_skip = 1'b0;
+
+    // See render_pipeline for the bits
+    logic [11:0] w_render_pipeline_perf_events;
+
     render_pipeline #(
         .INPUT_DATAWIDTH(INPUT_DATAWIDTH),
         .INPUT_FRACBITS(INPUT_FRACBITS),
@@ -202,19 +624,32 @@ module top_MH_FPGA #(
 
         .ADDRWIDTH(ADDRWIDTH),
 
+        .TILED_RASTERIZER(TILED_RASTERIZER),
+        .TILE_WIDTH(BEAM_RACING ? (1 << $clog2(SCREEN_WIDTH)) : 32),
+        .TILE_HEIGHT(BEAM_RACING ? BAND_HEIGHT : 32),
+        .FB_WRAP_ROWS(BEAM_RACING ? 2 * BAND_HEIGHT : 0),
+        .BACKEND_CLOCK_CROSSING(RASTERIZER_CLOCK_CROSSING),
+
         .ZFAR(ZFAR),
         .ZNEAR(ZNEAR)
     ) render_pipeline_inst (
         .clk(clk_100m),
         .rstn(rstn),
 
+        .clk_backend(clk_200m),
+        .rstn_backend(r_rstn_200m_sync[1]),
+
         .start(r_render_pipeline_start),
         .ready(w_render_pipeline_ready),
         .finished(w_render_pipeline_finished),
 
         .o_mvp_matrix_read_en(w_mvp_matrix_read_en),
-        .i_mvp_matrix(r_mvp_matrix),
-        .i_mvp_dv(r_mvp_dv),
+        .i_mvp_matrix(w_mvp_matrix),
+        .i_mvp_dv(w_mvp_dv),
+
+        // The model never changes, so the vertex cache is always safe to use
+        .i_vertex_cache_en(1'b1),
+        .o_vertex_cache_hit(),
 
         .o_model_buff_vertex_read_en(w_model_buff_vertex_read_en),
         .i_vertex(r_vertex),
@@ -230,14 +665,23 @@ module top_MH_FPGA #(
         .o_fb_write_en(w_fb_write_en),
 
         .o_fb_depth_data(w_fb_depth_data),
-        .o_fb_color_data(w_fb_color_data)
+        .o_fb_color_data(w_fb_color_data),
+
+        .i_tile_write_limit(w_band_write_limit[OUTPUT_DATAWIDTH-1:0]),
+
+        .i_res_shift(r_frame_res_shift),
+        .i_abort(r_render_abort),
+
+        .o_perf_events(w_render_pipeline_perf_events)
     );
 
     // ============================ DISPLAY ============================
     logic r_display_clear = 1'b0;
+    logic r_frame_render_done = 1'b0;   // Also for frames with all objects skipped
 
     logic w_display_new_frame_render_ready;
     logic w_display_frame_swapped;
+    logic w_display_pixel_depth_pass;
 
     display_new #(
         .DISPLAY_WIDTH(SCREEN_WIDTH),
@@ -250,6 +694,12 @@ module top_MH_FPGA #(
 
         .COLOR_CHANNEL_WIDTH(4),
         .FB_CLEAR_VALUE(0),
+        .CLEAR_ON_SCANOUT(1),
+        .NUM_FRAMEBUFFERS(3),
+        .BACKGROUND_LAYER(0),   // No static scene yet, and not enough BRAM left
+        .DEPTH_BUFFER(TILED_RASTERIZER == 0),
+        .BAND_HEIGHT(BEAM_RACING ? BAND_HEIGHT : 0),
+        .NUM_BAND_SLOTS(2),
 
         .PALETTE_FILE(PALETTE_FILE),
         .FB_IMAGE_FILE(FB_IMAGE_FILE)
@@ -259,7 +709,7 @@ module top_MH_FPGA #(
         .rstn(rstn),
         .rst_pix(rst_pix),
 
-        .frame_render_done(w_render_pipeline_finished),
+        .frame_render_done(r_frame_render_done),
         .frame_clear(r_display_clear),
         .new_frame_render_ready(w_display_new_frame_render_ready),
         .frame_swapped(w_display_frame_swapped),
@@ -268,6 +718,22 @@ module top_MH_FPGA #(
         .i_pixel_write_valid(w_fb_write_en),
         .i_fb_data(w_fb_color_data),
         .i_db_data(w_fb_depth_data),
+        .i_pixel_write_static(1'b0),
+
+        // One word per pixel, and the rasterizer writes single pixels
+        .i_word_write_addr('0),
+        .i_word_write_mask('0),
+        .i_word_fb_data('0),
+        .i_word_write_valid(1'b0),
+
+        .background_capture(1'b0),
+        .background_invalidate(1'b0),
+        .background_valid(),
+
+        .band_write_limit(w_band_write_limit),
+
+        .res_shift(r_frame_res_shift),
+        .pixel_depth_pass(w_display_pixel_depth_pass),
 
         .o_red(vga_r),
         .o_green(vga_g),
@@ -276,8 +742,8 @@ module top_MH_FPGA #(
         .vsync(vga_vsync)
     );
 
-    assign led[1] = ~display_inst.r_current_active_render_target;
-    assign led[2] =  display_inst.r_current_active_render_target;
+    assign led[1] = display_inst.r_render_fb == 0;
+    assign led[2] = display_inst.r_render_fb == 1;
 
     logic frame       /* verilator public_flat_rw */;
     logic display_en  /* verilator public_flat_rw */;
@@ -294,16 +760,14 @@ module top_MH_FPGA #(
     // assign vga_b = {2{display_inst.o_blue}};
 
     // ============================ STATE =============================
-    typedef enum logic [3:0] {
+    typedef enum logic [2:0] {
         IDLE,
-        MODEL_BUFFER_RESET,
-        MODEL_BUFFER_WAIT_RESET,
-        DISPLAY_CLEAR,
-        DISPLAY_CLEAR_WAIT,
-        MVP_MATRIX_CALCULATE,
-        MVP_MATRIX_WAIT_DONE,
+        FRAME_SETUP,            // Model reader reset and display clear run in parallel
+        FRAME_SETUP_WAIT,
         RENDER_START,
+        MVP_MATRIX_LOAD,        // Wait for the render pipeline to read the next MVP matrix
         RENDER_WAIT_FINISHED,
+        RENDER_SKIP,            // Object occluded, drop its MVP matrix
         RENDER_FINISHED
     } state_t;
     state_t current_state = IDLE, next_state;
@@ -328,47 +792,33 @@ module top_MH_FPGA #(
         case (current_state)
             IDLE: begin
                 // if (btn) begin
-                //     next_state = MODEL_BUFFER_RESET;
+                //     next_state = FRAME_SETUP;
                 // end
-                next_state = MODEL_BUFFER_RESET;
-            end
-
-            MODEL_BUFFER_RESET: begin
-                next_state = MODEL_BUFFER_WAIT_RESET;
+                next_state = FRAME_SETUP;
             end
 
-            MODEL_BUFFER_WAIT_RESET: begin
-                if (w_model_reader_ready) begin
-                    next_state = DISPLAY_CLEAR;
+            FRAME_SETUP: begin
+                // The band buffers are never cleared
+                if (r_display_clear && (~w_display_new_frame_render_ready || BEAM_RACING)) begin
+                    next_state = FRAME_SETUP_WAIT;
                 end
             end
 
-            DISPLAY_CLEAR: begin
-                if (r_display_clear && ~w_display_new_frame_render_ready) begin
-                    next_state = DISPLAY_CLEAR_WAIT;
-                end
-            end
-
-            DISPLAY_CLEAR_WAIT: begin
-                if (w_display_new_frame_render_ready && w_render_pipeline_ready) begin
-                    next_state = RENDER_START;
+            FRAME_SETUP_WAIT: begin
+                if (~r_model_reader_reset && w_model_reader_ready &&
+                    w_display_new_frame_render_ready && w_render_pipeline_ready && r_object_decided) begin
+                    next_state = r_object_skip ? RENDER_SKIP : RENDER_START;
                 end
             end
 
             RENDER_START: begin
                 if (w_render_pipeline_ready && r_render_pipeline_start) begin
-                    next_state = MVP_MATRIX_CALCULATE;
-                end
-            end
-
-            MVP_MATRIX_CALCULATE: begin
-                if (w_mat_mul_ready) begin
-                    next_state = MVP_MATRIX_WAIT_DONE;
+                    next_state = MVP_MATRIX_LOAD;
                 end
             end
 
-            MVP_MATRIX_WAIT_DONE: begin
-                if (r_mvp_dv && w_mvp_matrix_read_en) begin
+            MVP_MATRIX_LOAD: begin
+                if (w_mvp_dv) begin
                     next_state = RENDER_WAIT_FINISHED;
                 end
             end
@@ -379,14 +829,20 @@ module top_MH_FPGA #(
                 end
             end
 
+            RENDER_SKIP: begin
+                if (w_mvp_dv) begin
+                    next_state = RENDER_FINISHED;
+                end
+            end
+
             RENDER_FINISHED: begin
                 if (w_display_frame_swapped) begin
-                    next_state = MODEL_BUFFER_RESET;
+                    next_state = FRAME_SETUP;
                 end
             end
 
             default: begin
-                next_state = MODEL_BUFFER_RESET;
+                next_state = FRAME_SETUP;
             end
         endcase
     end
@@ -396,26 +852,20 @@ module top_MH_FPGA #(
             r_render_pipeline_start <= 1'b0;
             r_display_clear <= 1'b0;
             r_model_reader_reset <= 1'b0;
-            r_angle <= '0;
-            foreach (r_mvp_matrix[i,j]) r_mvp_matrix[i][j] <= '0;
-            r_mvp_dv <= '0;
+            r_frame_render_done <= 1'b0;
         end else begin
+            // Registered, the display synchronizes it to the pixel clock
+            r_frame_render_done <= (next_state == RENDER_FINISHED);
+
             case (current_state)
-                MODEL_BUFFER_RESET: begin
+                FRAME_SETUP: begin
                     r_render_pipeline_start <= 1'b0;
                     r_model_reader_reset <= 1'b1;
-                    r_display_clear <= 1'b0;
-                end
-
-                MODEL_BUFFER_WAIT_RESET: begin
-                    r_model_reader_reset <= 1'b0;
-                end
-
-                DISPLAY_CLEAR: begin
                     r_display_clear <= 1'b1;
                 end
 
-                DISPLAY_CLEAR_WAIT: begin
+                FRAME_SETUP_WAIT: begin
+                    r_model_reader_reset <= 1'b0;
                     r_display_clear <= 1'b0;
                 end
 
@@ -427,26 +877,6 @@ module top_MH_FPGA #(
                     end
                 end
 
-                MVP_MATRIX_CALCULATE: begin
-                    if (w_mat_mul_ready) begin
-                        r_mvp_matrix_compontents_dv <= 1'b1;
-                    end
-                end
-
-                MVP_MATRIX_WAIT_DONE: begin
-                    r_mvp_matrix_compontents_dv <= 1'b0;
-                    if (w_mvp_matrix_dv) begin
-                        r_mvp_matrix <= w_mvp_matrix;
-                        r_mvp_dv <= 1'b1;
-
-                        r_angle <= r_angle + 16;
-                    end
-
-                    if (w_mvp_matrix_read_en && r_mvp_dv) begin
-                        r_mvp_dv <= 1'b0;
-                    end
-                end
-
                 RENDER_WAIT_FINISHED: begin
                     r_render_pipeline_start <= 1'b0;
                 end
@@ -463,6 +893,270 @@ module top_MH_FPGA #(
         end
     end
 
+    // ============================ DYNAMIC RESOLUTION ============================
+    // Frame time from FRAME_SETUP to RENDER_FINISHED, so without the wait for
+    // the swap
+    logic [31:0] r_frame_cycles = '0;
+    logic [1:0] r_res_shift = '0;   // For the next frame
+
+    always_ff @(posedge clk_100m) begin
+        if (~rstn) begin
+            r_frame_cycles <= '0;
+            r_res_shift <= '0;
+            r_frame_res_shift <= '0;
+        end else begin
+            if (current_state == FRAME_SETUP) begin
+                r_frame_cycles <= '0;
+                r_frame_res_shift <= (DYNAMIC_RESOLUTION && ~BEAM_RACING) ? r_res_shift : '0;
+            end else if (current_state != IDLE && current_state != RENDER_FINISHED) begin
+                r_frame_cycles <= r_frame_cycles + 1;
+            end
+
+            if (current_state == RENDER_WAIT_FINISHED && next_state == RENDER_FINISHED) begin
+                if (r_frame_cycles > 32'(DRS_FRAME_BUDGET) && r_frame_res_shift < 2'(DRS_MAX_SHIFT)) begin
+                    r_res_shift <= r_frame_res_shift + 1;
+                end else if (r_frame_cycles < 32'(DRS_RAISE_BUDGET) && r_frame_res_shift != '0) begin
+                    r_res_shift <= r_frame_res_shift - 1;
+                end else begin
+                    r_res_shift <= r_frame_res_shift;
+                end
+            end
+        end
+    end
+
+    // ============================ FRAME DEADLINE ============================
+    // Held until the next frame, the render pipeline drops triangles while it
+    // is set
+    logic w_deadline_expired;
+    assign w_deadline_expired = (FRAME_DEADLINE != 0) && (r_frame_cycles == 32'(FRAME_DEADLINE)) &&
+                                (current_state != FRAME_SETUP) && (current_state != RENDER_FINISHED);
+
+    always_ff @(posedge clk_100m) begin
+        if (~rstn) begin
+            r_render_abort <= 1'b0;
+        end else if (current_state == FRAME_SETUP) begin
+            r_render_abort <= 1'b0;
+        end else if (w_deadline_expired) begin
+            r_render_abort <= 1'b1;
+        end
+    end
+
+    // ============================ PERFORMANCE COUNTERS ============================
+    // Counted per frame, from one FRAME_SETUP to the next
+    localparam unsigned PERF_NUM_COUNTERS = 19;
+    localparam unsigned PERF_COUNTER_WIDTH = 32;
+
+    localparam unsigned PERF_FRAME_CYCLES = 0;
+    localparam unsigned PERF_SETUP_CYCLES = 1;               // FRAME_SETUP and FRAME_SETUP_WAIT
+    localparam unsigned PERF_CLEAR_CYCLES = 2;               // Render target not ready, being cleared
+    localparam unsigned PERF_MVP_WAIT_CYCLES = 3;
+    localparam unsigned PERF_SWAP_WAIT_CYCLES = 4;           // Finished, waiting for the display to swap
+    localparam unsigned PERF_TRANSFORM_BUSY_CYCLES = 5;
+    localparam unsigned PERF_TRANSFORM_STALL_CYCLES = 6;     // Waiting on the rasterizer
+    localparam unsigned PERF_RASTERIZER_BUSY_CYCLES = 7;
+    localparam unsigned PERF_RASTERIZER_STALL_CYCLES = 8;    // Frontend waiting on the backend
+    localparam unsigned PERF_VERTICES = 9;
+    localparam unsigned PERF_VERTICES_CLIPPED = 10;
+    localparam unsigned PERF_TRIANGLES = 11;
+    localparam unsigned PERF_TRIANGLES_CULLED_BACKFACE = 12;
+    localparam unsigned PERF_TRIANGLES_CULLED_BBOX = 13;
+    localparam unsigned PERF_PIXELS_TESTED = 14;
+    localparam unsigned PERF_PIXELS_WRITTEN = 15;
+    localparam unsigned PERF_DEADLINE_OVERRUNS = 16;        // Frames cut short by the deadline
+    localparam unsigned PERF_TRIANGLES_DROPPED = 17;
+    localparam unsigned PERF_OBJECTS_SKIPPED = 18;          // Conditional rendering
+
+    logic [PERF_NUM_COUNTERS-1:0] w_perf_events;
+    logic w_perf_frame_start;
+
+    always_comb begin
+        w_perf_events = '0;
+
+        w_perf_events[PERF_FRAME_CYCLES] = (current_state != IDLE);
+        w_perf_events[PERF_SETUP_CYCLES] = (current_state == FRAME_SETUP) || (current_state == FRAME_SETUP_WAIT);
+        w_perf_events[PERF_CLEAR_CYCLES] = ~w_display_new_frame_render_ready;
+        w_perf_events[PERF_MVP_WAIT_CYCLES] = (current_state == MVP_MATRIX_LOAD);
+        w_perf_events[PERF_SWAP_WAIT_CYCLES] = (current_state == RENDER_FINISHED);
+
+        w_perf_events[PERF_TRANSFORM_BUSY_CYCLES] = w_render_pipeline_perf_events[0];
+        w_perf_events[PERF_TRANSFORM_STALL_CYCLES] = w_render_pipeline_perf_events[1];
+        w_perf_events[PERF_RASTERIZER_BUSY_CYCLES] = w_render_pipeline_perf_events[2];
+        w_perf_events[PERF_RASTERIZER_STALL_CYCLES] = w_render_pipeline_perf_events[3];
+
+        w_perf_events[PERF_VERTICES] = w_render_pipeline_perf_events[4];
+        w_perf_events[PERF_VERTICES_CLIPPED] = w_render_pipeline_perf_events[5];
+        w_perf_events[PERF_TRIANGLES] = w_render_pipeline_perf_events[6];
+        w_perf_events[PERF_TRIANGLES_CULLED_BACKFACE] = w_render_pipeline_perf_events[8];
+        w_perf_events[PERF_TRIANGLES_CULLED_BBOX] = w_render_pipeline_perf_events[9];
+        w_perf_events[PERF_PIXELS_TESTED] = w_render_pipeline_perf_events[10];
+        w_perf_events[PERF_PIXELS_WRITTEN] = w_fb_write_en;
+        w_perf_events[PERF_DEADLINE_OVERRUNS] = w_deadline_expired;
+        w_perf_events[PERF_TRIANGLES_DROPPED] = w_render_pipeline_perf_events[7];
+        w_perf_events[PERF_OBJECTS_SKIPPED] = (current_state == RENDER_SKIP) && w_mvp_dv;
+    end
+
+    assign w_perf_frame_start = (next_state == FRAME_SETUP) && (current_state != FRAME_SETUP);
+
+    // Read out over SPI by mcu_fpga_com (CMD_READ_PERF_COUNTERS)
+    logic [$clog2(PERF_NUM_COUNTERS)-1:0] w_perf_counter_addr;
+    logic [PERF_COUNTER_WIDTH-1:0] w_perf_counter_data;
+
+    perf_counters #(
+        .NUM_COUNTERS(PERF_NUM_COUNTERS),
+        .COUNTER_WIDTH(PERF_COUNTER_WIDTH)
+    ) perf_counters_inst (
+        .clk(clk_100m),
+        .rstn(rstn),
+
+        .i_frame_start(w_perf_frame_start),
+        .i_events(w_perf_events),
+
+        .i_read_addr(w_perf_counter_addr),
+        .o_read_data(w_perf_counter_data)
+    );
+
+    // ============================ OCCLUSION QUERIES ============================
+    // Pixels of each object that passed the depth test in the last frame,
+    // for conditional rendering on read port a, and read out over SPI by
+    // mcu_fpga_com (CMD_READ_OCCLUSION_COUNTERS) on port b. The render
+    // pipeline draws one object per run, so the pixels are counted against
+    // the object being rendered. The tiled rasterizer does the depth test
+    // itself, otherwise the display does.
+    //
+    // All pixels are counted against object 0 until the top has a
+    // multi-object path that sets r_object_index, so only the first count
+    // read by the MCU is non-zero.
+    localparam unsigned OCCLUSION_COUNTER_WIDTH = 16;
+
+    logic [$clog2(MAX_NUM_OBJECTS_PER_FRAME)-1:0] r_object_index = '0;     // One object per frame for now
+    logic w_occlusion_pixel_pass;
+
+    logic [$clog2(MAX_NUM_OBJECTS_PER_FRAME)-1:0] w_occlusion_counter_addr;
+    logic [OCCLUSION_COUNTER_WIDTH-1:0] w_occlusion_counter_data;
+    logic [$clog2(MAX_NUM_OBJECTS_PER_FRAME)-1:0] w_mcu_occlusion_counter_addr;
+    logic [OCCLUSION_COUNTER_WIDTH-1:0] w_mcu_occlusion_counter_data;
+
+    assign w_occlusion_pixel_pass = TILED_RASTERIZER ? w_render_pipeline_perf_events[11]
+                                                     : w_display_pixel_depth_pass;
+
+    occlusion_counters #(
+        .NUM_OBJECTS(MAX_NUM_OBJECTS_PER_FRAME),
+        .COUNTER_WIDTH(OCCLUSION_COUNTER_WIDTH)
+    ) occlusion_counters_inst (
+        .clk(clk_100m),
+        .rstn(rstn),
+
+        .o_ready(),
+
+        .i_frame_start(w_perf_frame_start),
+        .i_object_index(r_object_index),
+        .i_pixel_pass(w_occlusion_pixel_pass),
+
+        .i_read_addr(w_occlusion_counter_addr),
+        .o_read_data(w_occlusion_counter_data),
+
+        .i_read_addr_b(w_mcu_occlusion_counter_addr),
+        .o_read_data_b(w_mcu_occlusion_counter_data)
+    );
+
+    // ============================ CONDITIONAL RENDERING ============================
+    // The object is queried at the start of FRAME_SETUP, after the occlusion
+    // counters have swapped. A frame cut short by the deadline has incomplete
+    // counts, so its objects are not skipped.
+    logic r_object_query = 1'b0;
+    logic w_object_render;
+    logic w_object_render_dv;
+
+    conditional_render #(
+        .NUM_OBJECTS(MAX_NUM_OBJECTS_PER_FRAME),
+        .COUNTER_WIDTH(OCCLUSION_COUNTER_WIDTH),
+        .SKIP_FRAMES(OCCLUSION_SKIP_FRAMES),
+        .RETEST_FRAMES(OCCLUSION_RETEST_FRAMES)
+    ) conditional_render_inst (
+        .clk(clk_100m),
+        .rstn(rstn),
+
+        .o_occlusion_addr(w_occlusion_counter_addr),
+        .i_occlusion_count(w_occlusion_counter_data),
+        .i_results_valid(~r_render_abort),
+
+        .i_object_index(r_object_index),
+        .i_query(r_object_query),
+
+        .o_render(w_object_render),
+        .o_dv(w_object_render_dv)
+    );
+
+    assign w_mvp_matrix_skip_read_en = (current_state == RENDER_SKIP);
+
+    always_ff @(posedge clk_100m) begin
+        if (~rstn) begin
+            r_object_query <= 1'b0;
+            r_object_decided <= 1'b0;
+            r_object_skip <= 1'b0;
+        end else begin
+            r_object_query <= w_perf_frame_start;
+
+            if (w_perf_frame_start) begin
+                r_object_decided <= 1'b0;
+            end else if (w_object_render_dv) begin
+                r_object_decided <= 1'b1;
+                r_object_skip <= CONDITIONAL_RENDERING && ~w_object_render;
+            end
+        end
+    end
+
+    // ============================ MCU INTERFACE ============================
+    // Posed objects go to the sorter with MCU_OBJECTS, see MVP Matrix
+    // Generation. The matrix and delta packets are not rendered yet
+    mcu_fpga_com #(
+        .I_MATRIX_DATAWIDTH(INPUT_DATAWIDTH),
+        .MAX_NUM_OBJECTS(MAX_NUM_OBJECTS_PER_FRAME),
+        .ANGLE_WIDTH(ANGLE_WIDTH),
+        .PERF_NUM_COUNTERS(PERF_NUM_COUNTERS),
+        .PERF_COUNTER_WIDTH(PERF_COUNTER_WIDTH),
+        .OCCLUSION_COUNTER_WIDTH(OCCLUSION_COUNTER_WIDTH)
+    ) mcu_fpga_com_inst (
+        .clk(clk_100m),
+        .rstn(rstn),
+
+        .i_mode(1'b0),
+        .i_new_frame(w_perf_frame_start),
+        .o_mcu_ready(),
+
+        .o_num_objects(w_mcu_num_objects),
+        .o_num_objects_dv(w_mcu_num_objects_dv),
+
+        .o_object_index(),
+        .o_object_id(),
+        .o_object_flags(),
+        .o_object_matrix(),
+        .o_object_dirty(),
+        .o_object_dv(),
+
+        .o_object_position(w_mcu_object_position),
+        .o_object_yaw(w_mcu_object_yaw),
+        .o_object_pitch(w_mcu_object_pitch),
+        .o_object_roll(w_mcu_object_roll),
+        .o_object_pose_dv(w_mcu_object_pose_dv),
+
+        .o_view_projection(),
+        .o_view_projection_dv(),
+
+        .o_packet_dropped(),
+
+        .o_perf_counter_addr(w_perf_counter_addr),
+        .i_perf_counter_data(w_perf_counter_data),
+
+        .o_occlusion_counter_addr(w_mcu_occlusion_counter_addr),
+        .i_occlusion_counter_data(w_mcu_occlusion_counter_data),
+
+        .SCK(SCK),
+        .MOSI(MOSI),
+        .MISO(MISO),
+        .CSn(CSn)
+    );
+
     // assign led[3] = current_state != IDLE;
 
 endmodule
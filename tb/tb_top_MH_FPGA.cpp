@@ -43,6 +43,11 @@ int main(int argc, char* argv[]) {
     uint64_t start_ticks = SDL_GetPerformanceCounter();
     uint64_t frame_count = 0;
 
+    // No MCU, the SPI bus stays idle
+    dut->CSn = 1;
+    dut->SCK = 0;
+    dut->MOSI = 0;
+
     // Reset
     dut->clk = 0;
     for (int i = 0; i < 8; i++) {